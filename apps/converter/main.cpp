@@ -4,14 +4,18 @@
 #include <bruh/bruh.h>
 #include <csv/csv.h>
 #include <util/buffered_file.h>
+#include <util/decompressing_file.h>
 #include <util/memory_mapped_file.h>
 
+#include <cstdint>
 #include <iostream>
+#include <utility>
 
 ABSL_FLAG(std::string, mode, "", "Conversion mode: csv2bruh or bruh2csv");
 ABSL_FLAG(std::string, schema, "", "Path to .csv schema file");
-ABSL_FLAG(std::string, input, "", "Input file path");
+ABSL_FLAG(std::string, input, "", "Input file path, csv2bruh also reads .gz/.zst/.lz4 input");
 ABSL_FLAG(std::string, output, "", "Output file path");
+ABSL_FLAG(uint32_t, threads, 0, "Worker threads for conversion (0 = all cores)");
 
 using namespace columnar;  // NOLINT
 
@@ -46,10 +50,13 @@ int main(int argc, char** argv) {
                 throw std::runtime_error("Schema required");
             }
             auto schema = csv::SchemaManager::ReadFromFile(schema_path);
-            util::BufferedInputFile in(input);
+            util::DecompressingInputFile in(input);
             util::BufferedOutputFile out(output);
-            csv::CSVBatchReader reader(in, schema, {});
-            bruh::BruhBatchWriter writer(out, schema);
+            auto threads = absl::GetFlag(FLAGS_threads);
+            csv::ParallelCSVBatchReader reader(in, schema, {.threads = threads});
+            bruh::BruhWriterOptions options;
+            options.threads = threads;
+            bruh::BruhBatchWriter writer(out, schema, std::move(options));
             Convert(reader, writer);
         } else if (mode == "bruh2csv") {
             util::MemoryMappedInputFile in(input);
@@ -58,7 +65,7 @@ int main(int argc, char** argv) {
                 csv::SchemaManager::WriteToFile(schema_path, reader.GetSchema());
             }
             util::BufferedOutputFile out(output);
-            csv::CSVBatchWriter writer(out, {});
+            csv::CSVBatchWriter writer(out, {.threads = absl::GetFlag(FLAGS_threads)});
             Convert(reader, writer);
         } else {
             throw std::runtime_error("Unknown mode");
@@ -40,6 +40,16 @@ public:
         return ReadRowGroup(i, ResolveColumnNames(column_names));
     }
 
+    // Reads the given rows of row group i, which must be strictly ascending
+    core::Batch FetchRows(size_t i, const std::vector<size_t>& column_indexes,
+                          const std::vector<uint32_t>& rows);
+
+    // Decodes only the given rows of a column chunk: plain values and bit-packed or dictionary ids
+    // are read at their positions, RLE runs and delta sums only up to the last row. A compressed
+    // chunk is still decompressed as a whole
+    std::unique_ptr<core::Column> FetchRows(size_t row_group, size_t column,
+                                            const std::vector<uint32_t>& rows);
+
     std::vector<size_t> ResolveColumnNames(const std::vector<std::string>& column_names) const;
 
     core::Schema ProjectSchema(const std::vector<size_t>& column_indexes) const;
@@ -69,6 +79,13 @@ private:
 
     static ColumnChunkStatistics ReadColumnStatistics(util::BufReader& r, const core::Field& field);
 
+    void CheckRowGroupIndex(size_t i) const;
+
+    void ReadChunk(size_t row_group, size_t column, std::unique_ptr<core::Column>& out);
+
+    // Reads the chunk in place or from encode_buf_ after decompressing it
+    util::BufReader ChunkReader(size_t row_group, size_t column);
+
     void ReadColumn(util::BufReader& r, std::unique_ptr<core::Column>& col,
                     const core::Field& field, const ColumnChunkMetaData& chunk);
 
@@ -5,8 +5,13 @@
 #include <core/encoding.h>
 #include <util/compression.h>
 #include <util/macro.h>
+#include <util/thread_pool.h>
 
+#include <condition_variable>
 #include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <unordered_map>
 #include <utility>
@@ -18,16 +23,18 @@ struct BruhWriterOptions {
     core::Encoding encoding = core::Encoding::Auto;
     std::unordered_map<size_t, core::Encoding> column_encoding;
     std::unordered_map<size_t, util::Compression> column_compression;
+    // Columns of a row group are encoded and compressed on `threads` workers (0 = all cores),
+    // chunks are still written in column order. At most `max_in_flight_chunks` encoded chunks
+    // wait for the output stream at once (0 = 2 * threads).
+    size_t threads = 1;
+    size_t max_in_flight_chunks = 0;
 };
 
 class BruhBatchWriter final : public core::BatchWriter {
 public:
-    BruhBatchWriter(std::ostream& os, const core::Schema& schema, BruhWriterOptions options = {})
-        : os_(os), schema_(schema), options_(std::move(options)) {
-        metadata_.version = kCurrentVersion;
-        metadata_.schema = schema;
-        WriteMagic();
-    }
+    BruhBatchWriter(std::ostream& os, const core::Schema& schema, BruhWriterOptions options = {});
+
+    ~BruhBatchWriter() override;
 
     void Write(const core::Batch& batch) override;
 
@@ -38,8 +45,21 @@ private:
         os_.write(reinterpret_cast<const char*>(kMagicBytes), sizeof(kMagicBytes));
     }
 
-    void WriteColumn(ColumnChunkMetaData& chunk, const core::Column& col, const core::Field& field,
-                     size_t col_index);
+    struct EncodedChunk {
+        ColumnChunkMetaData chunk;
+        std::vector<uint8_t> packed_buf;
+        std::vector<uint8_t> encode_buf;
+        std::vector<uint8_t> compress_buf;
+        bool ready = false;
+        std::exception_ptr error;
+    };
+
+    void EncodeChunk(EncodedChunk& slot, const core::Column& col, const core::Field& field,
+                     size_t col_index) const;
+    void WriteChunk(EncodedChunk& slot, RowGroupMetaData& group);
+
+    void WriteSerial(const core::Batch& batch, RowGroupMetaData& group);
+    void WriteParallel(const core::Batch& batch, RowGroupMetaData& group);
 
     void WriteFooter();
     void WriteFields();
@@ -49,8 +69,10 @@ private:
     core::Schema schema_;
     BruhWriterOptions options_;
     FileMetaData metadata_;
-    std::vector<uint8_t> packed_buf_;
-    std::vector<uint8_t> encode_buf_;
-    std::vector<uint8_t> compress_buf_;
+    std::vector<EncodedChunk> slots_;
+    std::mutex slots_mutex_;
+    std::condition_variable slots_cv_;
+    // Declared last so the workers are joined before the state they signal is destroyed.
+    std::unique_ptr<util::ThreadPool> pool_;
 };
 }  // namespace columnar::bruh
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <core/column_factory.h>
+#include <core/row_selection.h>
 #include <core/schema.h>
 #include <util/macro.h>
 
@@ -43,17 +44,29 @@ public:
         return has_selection_;
     }
 
+    // The selected row indexes, built on first use when the selection is a range or a bitmap.
+    // Building them writes to the batch, so a Batch is not safe for concurrent use even through
+    // its const methods
     const std::vector<uint32_t>& Selection() const {
+        return selection_.Indices();
+    }
+
+    const RowSelection& GetRowSelection() const {
         return selection_;
     }
 
     void SetSelection(std::vector<uint32_t> selection) {
+        selection_ = RowSelection::FromIndices(std::move(selection), RowsCount());
+        has_selection_ = true;
+    }
+
+    void SetSelection(RowSelection selection) {
         selection_ = std::move(selection);
         has_selection_ = true;
     }
 
     size_t SelectedRowsCount() const {
-        return has_selection_ ? selection_.size() : RowsCount();
+        return has_selection_ ? selection_.Count() : RowsCount();
     }
 
     void Reserve(size_t n) {
@@ -95,7 +108,7 @@ public:
 private:
     Schema schema_;
     std::vector<std::unique_ptr<Column>> columns_;
-    std::vector<uint32_t> selection_;
+    RowSelection selection_;
     bool has_selection_ = false;
 };
 }  // namespace columnar::core
@@ -60,6 +60,23 @@ public:
         Append(util::ParseFromString<T>(s));
     }
 
+    // Appends n non-null zero values to be filled in place by bulk writers
+    T* AppendZeros(size_t n) {
+        size_t pos = data_.size();
+        data_.resize(pos + n);
+        if (nullable_) {
+            is_null_.AppendZeros(n);
+        }
+        return data_.data() + pos;
+    }
+
+    void SetNull(size_t i) {
+        if (!nullable_) {
+            THROW_RUNTIME_ERROR("Cannot set not nullable value to null");
+        }
+        is_null_.Set(i);
+    }
+
     void AppendNull() override {
         if (!nullable_) {
             THROW_RUNTIME_ERROR("Cannot set not nullable value to null");
@@ -157,6 +157,25 @@ void BitUnpackWithOffset(const uint8_t* src, size_t src_size, size_t n, uint8_t
     }
 }
 
+// Unpacks value i of a buffer written by BitPackWithOffset without unpacking the others
+template <std::integral T>
+T BitUnpackAt(const uint8_t* src, size_t src_size, size_t i, uint8_t bit_width, T offset) {
+    if (bit_width > kBitPackingMaxWidth) {
+        THROW_RUNTIME_ERROR("bit_width is too large");
+    }
+    if (bit_width == 0) {
+        return offset;
+    }
+    size_t bit = i * bit_width;
+    if (src_size < BitPackedSize(i + 1, bit_width)) {
+        THROW_RUNTIME_ERROR("Input is too small");
+    }
+    uint64_t word = 0;
+    std::memcpy(&word, src + bit / 8, std::min(sizeof(word), src_size - bit / 8));
+    uint64_t mask = (static_cast<uint64_t>(1) << bit_width) - 1;
+    return static_cast<T>(static_cast<uint64_t>(offset) + ((word >> (bit % 8)) & mask));
+}
+
 inline void PackBitVector(const util::BitVector& bits, uint8_t* out) {
     size_t packed_size = BitPackedSize(bits.Size(), 1);
     if (packed_size > 0) {
@@ -80,4 +80,32 @@ std::vector<T> DecodeDelta(util::BufReader& r, size_t n) {
     }
     return out;
 }
+
+// Decodes only the values at the given ascending positions. Deltas are summed up to the last
+// position, the ones after it are not unpacked
+template <std::integral T>
+std::vector<T> DecodeDeltaAt(util::BufReader& r, size_t n, const std::vector<uint32_t>& rows) {
+    auto first = r.Read<T>();
+    std::vector<T> out(rows.size());
+    if (n == 0) {
+        return out;
+    }
+    auto min_delta = r.Read<T>();
+    auto bit_width = r.Read<uint8_t>();
+    if (bit_width > kBitPackingMaxWidth) {
+        THROW_RUNTIME_ERROR("bit_width is too large");
+    }
+    size_t packed_size = bit_width == 0 ? 0 : BitPackedSize(n - 1, bit_width);
+    const uint8_t* packed = r.Take(packed_size);
+    auto value = static_cast<uint64_t>(first);
+    size_t pos = 0;
+    for (size_t k = 0; k < rows.size(); ++k) {
+        for (; pos < rows[k]; ++pos) {
+            value += static_cast<uint64_t>(BitUnpackAt(packed, packed_size, pos, bit_width,
+                                                       min_delta));
+        }
+        out[k] = static_cast<T>(value);
+    }
+    return out;
+}
 }  // namespace columnar::core::encoding
@@ -23,4 +23,8 @@ struct DecodedStringDictionary {
 };
 
 DecodedStringDictionary DecodeStringDictionary(util::BufReader& r, size_t n);
+
+// Decodes the dictionary and the ids at the given positions only
+DecodedStringDictionary DecodeStringDictionaryAt(util::BufReader& r, size_t n,
+                                                 const std::vector<uint32_t>& rows);
 }  // namespace columnar::core::encoding
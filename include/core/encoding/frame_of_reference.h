@@ -65,4 +65,24 @@ std::vector<T> DecodeFOR(util::BufReader& r, size_t n) {
     BitUnpackWithOffset(r.Take(packed_size), packed_size, n, bit_width, mn, out.data());
     return out;
 }
+
+// Decodes only the values at the given positions of n encoded values
+template <std::integral T>
+std::vector<T> DecodeFORAt(util::BufReader& r, size_t n, const std::vector<uint32_t>& rows) {
+    auto mn = r.Read<T>();
+    auto bit_width = r.Read<uint8_t>();
+    if (bit_width > kBitPackingMaxWidth) {
+        THROW_RUNTIME_ERROR("bit_width is too large");
+    }
+    std::vector<T> out(rows.size(), mn);
+    if (bit_width == 0) {
+        return out;
+    }
+    size_t packed_size = BitPackedSize(n, bit_width);
+    const uint8_t* packed = r.Take(packed_size);
+    for (size_t k = 0; k < rows.size(); ++k) {
+        out[k] = BitUnpackAt(packed, packed_size, rows[k], bit_width, mn);
+    }
+    return out;
+}
 }  // namespace columnar::core::encoding
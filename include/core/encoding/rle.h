@@ -53,6 +53,30 @@ std::vector<T> DecodeRLE(util::BufReader& r, size_t n) {
     return out;
 }
 
+// Decodes only the values at the given ascending positions, reading runs up to the last of them
+template <util::BinaryTrivial T>
+std::vector<T> DecodeRLEAt(util::BufReader& r, size_t n, const std::vector<uint32_t>& rows) {
+    auto cnt = r.Read<uint32_t>();
+    std::vector<T> out(rows.size());
+    size_t run_end = 0;
+    uint32_t run = 0;
+    T val{};
+    for (size_t k = 0; k < rows.size(); ++k) {
+        while (run_end <= rows[k]) {
+            if (run++ == cnt) {
+                THROW_RUNTIME_ERROR("RLE length mismatch");
+            }
+            run_end += r.Read<uint32_t>();
+            val = r.Read<T>();
+            if (run_end > n) {
+                THROW_RUNTIME_ERROR("RLE length invalid");
+            }
+        }
+        out[k] = val;
+    }
+    return out;
+}
+
 void EncodeBoolRLE(util::BufWriter& w, const util::BitVector& bits, size_t n);
 
 util::BitVector DecodeBoolRLE(util::BufReader& r, size_t n);
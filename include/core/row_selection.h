@@ -0,0 +1,160 @@
+#pragma once
+
+#include <util/bit_vector.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace columnar::core {
+// The rows of a batch still in play, in ascending order. A single run of rows is kept as a range,
+// a dense selection as a bitmap and a sparse one as row indexes. The indexes of the other forms
+// are built on the first call to Indices(), which writes to the selection, so even const calls on
+// one selection must not run concurrently
+class RowSelection {
+public:
+    enum class Kind { Range, Bitmap, Indices };
+
+    // A selection is dense when it keeps at least one row in kDenseFraction
+    static constexpr size_t kDenseFraction = 2;
+
+    RowSelection() = default;
+
+    static RowSelection FromRange(size_t begin, size_t end) {
+        RowSelection selection;
+        selection.kind_ = Kind::Range;
+        selection.begin_ = begin;
+        selection.count_ = end - begin;
+        selection.has_indices_ = false;
+        return selection;
+    }
+
+    // indices must be ascending and below rows. A dense list is kept as a bitmap over rows that
+    // also keeps the list
+    static RowSelection FromIndices(std::vector<uint32_t> indices, size_t rows) {
+        if (!indices.empty() && indices.back() - indices.front() + 1 == indices.size()) {
+            return FromRange(indices.front(), static_cast<size_t>(indices.back()) + 1);
+        }
+        RowSelection selection;
+        selection.count_ = indices.size();
+        if (!indices.empty() && selection.count_ * kDenseFraction >= rows) {
+            selection.kind_ = Kind::Bitmap;
+            selection.bits_ = util::BitVector(rows);
+            for (uint32_t row : indices) {
+                selection.bits_.Set(row);
+            }
+        }
+        selection.indices_ = std::move(indices);
+        selection.has_indices_ = true;
+        return selection;
+    }
+
+    // Bit i of bits selects row i, bits past the end of the vector must be zero
+    static RowSelection FromBitmap(util::BitVector bits) {
+        const auto& words = bits.GetData();
+        size_t count = 0;
+        size_t first = 0;
+        size_t last = 0;
+        for (size_t w = 0; w < words.size(); ++w) {
+            if (words[w] == 0) {
+                continue;
+            }
+            if (count == 0) {
+                first = w * 64 + std::countr_zero(words[w]);
+            }
+            last = w * 64 + 63 - std::countl_zero(words[w]);
+            count += std::popcount(words[w]);
+        }
+        if (count == 0) {
+            return FromIndices({}, bits.Size());
+        }
+        if (last - first + 1 == count) {
+            return FromRange(first, last + 1);
+        }
+        RowSelection selection;
+        selection.kind_ = Kind::Bitmap;
+        selection.count_ = count;
+        selection.bits_ = std::move(bits);
+        selection.has_indices_ = false;
+        if (count * kDenseFraction < selection.bits_.Size()) {
+            selection.BuildIndices();
+            selection.kind_ = Kind::Indices;
+            selection.bits_ = util::BitVector();
+        }
+        return selection;
+    }
+
+    Kind GetKind() const {
+        return kind_;
+    }
+
+    size_t Count() const {
+        return count_;
+    }
+
+    const std::vector<uint32_t>& Indices() const {
+        if (!has_indices_) {
+            BuildIndices();
+        }
+        return indices_;
+    }
+
+    // The selection as a bitmap over rows rows
+    util::BitVector ToBitmap(size_t rows) const {
+        if (kind_ == Kind::Bitmap) {
+            return bits_;
+        }
+        util::BitVector bits(rows);
+        if (kind_ == Kind::Range) {
+            bits.SetRange(begin_, count_);
+        } else {
+            for (uint32_t row : indices_) {
+                bits.Set(row);
+            }
+        }
+        return bits;
+    }
+
+    template <typename F>
+    void ForEach(F&& f) const {
+        switch (kind_) {
+            case Kind::Range:
+                for (size_t row = begin_; row < begin_ + count_; ++row) {
+                    f(row);
+                }
+                return;
+            case Kind::Bitmap: {
+                const auto& words = bits_.GetData();
+                for (size_t w = 0; w < words.size(); ++w) {
+                    for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+                        f(w * 64 + static_cast<size_t>(std::countr_zero(word)));
+                    }
+                }
+                return;
+            }
+            case Kind::Indices:
+                for (uint32_t row : indices_) {
+                    f(static_cast<size_t>(row));
+                }
+                return;
+        }
+    }
+
+private:
+    void BuildIndices() const {
+        indices_.clear();
+        indices_.reserve(count_);
+        ForEach([&](size_t row) { indices_.push_back(static_cast<uint32_t>(row)); });
+        has_indices_ = true;
+    }
+
+    Kind kind_ = Kind::Indices;
+    size_t count_ = 0;
+    size_t begin_ = 0;
+    util::BitVector bits_;
+    mutable std::vector<uint32_t> indices_;
+    mutable bool has_indices_ = true;
+};
+}  // namespace columnar::core
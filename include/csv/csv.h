@@ -1,7 +1,10 @@
 #pragma once
 
+#include <csv/csv_batch_builder.h>
 #include <csv/csv_batch_reader.h>
 #include <csv/csv_batch_writer.h>
 #include <csv/csv_options.h>
 #include <csv/csv_row_reader.h>
+#include <csv/parallel_csv_batch_reader.h>
 #include <csv/schema_manager.h>
+#include <csv/structural_scanner.h>
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <core/batch.h>
+#include <core/column.h>
+#include <core/datatype.h>
+#include <core/schema.h>
+#include <csv/csv_row_reader.h>
+#include <util/string_arena.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace columnar::csv {
+// Parses and appends all collected values of one column at once, bypassing the virtual
+// Column::AppendFromString per cell. Appenders are stateless and shared between threads
+class ColumnAppender {
+public:
+    virtual ~ColumnAppender() = default;
+
+    virtual void Append(const std::vector<FieldView>& fields, core::Column& col) const = 0;
+};
+
+const ColumnAppender& GetColumnAppender(core::DataType type);
+
+// Collects rows column by column and fills a batch with one appender call per column
+class CSVBatchBuilder {
+public:
+    explicit CSVBatchBuilder(const core::Schema& schema);
+
+    // Without copy the field views must stay valid until Flush
+    void AddRow(const RowView& row, bool copy);
+
+    size_t RowsCount() const {
+        return rows_;
+    }
+
+    void Flush(core::Batch& batch);
+
+private:
+    std::vector<const ColumnAppender*> appenders_;
+    std::vector<std::vector<FieldView>> columns_;
+    util::StringArena arena_;
+    size_t rows_ = 0;
+};
+}  // namespace columnar::csv
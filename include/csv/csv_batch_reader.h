@@ -2,6 +2,7 @@
 
 #include <core/batch_reader.h>
 #include <core/schema.h>
+#include <csv/csv_batch_builder.h>
 #include <csv/csv_options.h>
 #include <csv/csv_row_reader.h>
 #include <util/macro.h>
@@ -12,7 +13,10 @@ namespace columnar::csv {
 class CSVBatchReader final : public core::BatchReader {
 public:
     CSVBatchReader(std::istream& is, core::Schema schema, CSVOptions options)
-        : row_reader_(is, options), schema_(std::move(schema)), options_(options) {
+        : row_reader_(is, options),
+          schema_(std::move(schema)),
+          options_(options),
+          builder_(schema_) {
     }
 
     std::optional<core::Batch> ReadNext() override;
@@ -25,5 +29,6 @@ private:
     CSVRowReader row_reader_;
     core::Schema schema_;
     CSVOptions options_;
+    CSVBatchBuilder builder_;
 };
 }  // namespace columnar::csv
@@ -4,21 +4,22 @@
 #include <core/datatype.h>
 #include <csv/csv_options.h>
 #include <util/macro.h>
+#include <util/thread_pool.h>
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace columnar::csv {
-struct CSVColumnView {
-    const core::Column* column;
-    core::DataType type;
-    bool nullable;
-};
-
+// Formats batches column by column and interleaves the fields into one output block per row range.
+// With options.threads != 1 the row ranges of a batch are formatted on a thread pool
 class CSVBatchWriter final : public core::BatchWriter {
 public:
-    CSVBatchWriter(std::ostream& os, CSVOptions options) : os_(os), options_(options) {
-    }
+    CSVBatchWriter(std::ostream& os, CSVOptions options);
+
+    ~CSVBatchWriter() override;
 
     void Write(const core::Batch& batch) override;
 
@@ -27,14 +28,29 @@ public:
     }
 
 private:
+    // Fields of one column over a row range, field i ends at ends[i] in data
+    struct FormattedColumn {
+        std::string data;
+        std::vector<size_t> ends;
+    };
+
+    struct RangeBuffer {
+        std::vector<FormattedColumn> columns;
+        std::vector<uint64_t> special_bytes;
+        std::vector<uint8_t> dict_quoting;
+        std::string out;
+    };
+
     void WriteHeader(const core::Schema& schema);
-    void AppendField(std::string_view value);
-    void FlushLine();
+    void FormatRows(const core::Batch& batch, size_t begin, size_t end, RangeBuffer& buf) const;
+    void FormatColumn(const core::Column& col, size_t begin, size_t end, RangeBuffer& buf,
+                      FormattedColumn& out) const;
+    void Emit(std::string_view text);
 
     std::ostream& os_;
     CSVOptions options_;
     bool header_written_ = false;
-    std::string line_buf_;
-    std::vector<CSVColumnView> col_views_;
+    std::vector<RangeBuffer> ranges_;
+    std::unique_ptr<util::ThreadPool> pool_;
 };
 }  // namespace columnar::csv
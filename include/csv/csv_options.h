@@ -9,5 +9,7 @@ struct CSVOptions {
     char quote_char = '"';
     bool has_header = false;
     size_t batch_rows_size = 9359;
+    // Worker threads of ParallelCSVBatchReader and CSVBatchWriter, 0 means all cores
+    size_t threads = 1;
 };
 }  // namespace columnar::csv
@@ -35,6 +35,11 @@ using Field = BasicField<std::string>;
 using Row = std::vector<Field>;
 using RowView = std::vector<FieldView>;
 
+// Splits one logical row (without its line terminator) into fields. Unescaped quoted fields are
+// stored in scratch, which must not be cleared while out is in use
+void ParseRawRow(std::string_view raw_row, const CSVOptions& options, std::string& scratch,
+                 RowView& out);
+
 class CSVRowReader {
 public:
     CSVRowReader(std::istream& is, CSVOptions options = {}) : is_(is), options_(options) {
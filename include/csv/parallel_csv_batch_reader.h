@@ -0,0 +1,56 @@
+#pragma once
+
+#include <core/batch_reader.h>
+#include <core/schema.h>
+#include <csv/csv_options.h>
+#include <util/macro.h>
+#include <util/thread_pool.h>
+
+#include <deque>
+#include <future>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace columnar::csv {
+// Reads the input in large blocks, cuts it at row boundaries into chunks of batch_rows_size rows
+// and parses the chunks on a thread pool. Batches are returned in input order and match the ones
+// produced by CSVBatchReader
+class ParallelCSVBatchReader final : public core::BatchReader {
+public:
+    static constexpr size_t kDefaultBlockSize = 8 * 1024 * 1024;
+
+    ParallelCSVBatchReader(std::istream& is, core::Schema schema, CSVOptions options,
+                           size_t block_size = kDefaultBlockSize);
+
+    ~ParallelCSVBatchReader() override;
+
+    std::optional<core::Batch> ReadNext() override;
+
+    const core::Schema& GetSchema() const override {
+        return schema_;
+    }
+
+private:
+    bool FillBuffer();
+    std::optional<std::string> CutChunk(size_t rows);
+    size_t ScanRows(size_t rows);
+    void Schedule();
+
+    std::istream& is_;
+    core::Schema schema_;
+    CSVOptions options_;
+    size_t block_size_;
+    std::string buf_;
+    size_t chunk_begin_ = 0;
+    size_t scan_pos_ = 0;
+    size_t scanned_rows_ = 0;
+    bool in_quotes_ = false;
+    bool eof_ = false;
+    size_t max_in_flight_ = 0;
+    std::deque<std::future<core::Batch>> in_flight_;
+    // Declared last so queued parse tasks finish before the members they read are destroyed
+    std::unique_ptr<util::ThreadPool> pool_;
+};
+}  // namespace columnar::csv
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace columnar::csv {
+inline constexpr size_t kStructuralBlockSize = 64;
+
+// Bit i of every mask describes byte i of a 64-byte block
+struct StructuralMasks {
+    uint64_t quotes = 0;
+    uint64_t delimiters = 0;
+    uint64_t newlines = 0;
+};
+
+namespace detail {
+#if defined(__AVX2__)
+inline uint64_t MatchMask(__m256i lo, __m256i hi, char c) {
+    __m256i v = _mm256_set1_epi8(c);
+    auto lo_bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v)));
+    auto hi_bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v)));
+    return lo_bits | (static_cast<uint64_t>(hi_bits) << 32);
+}
+#elif defined(__SSE2__)
+inline uint64_t MatchMask(const __m128i (&parts)[4], char c) {
+    __m128i v = _mm_set1_epi8(c);
+    uint64_t result = 0;
+    for (int i = 0; i < 4; ++i) {
+        auto bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(parts[i], v)));
+        result |= static_cast<uint64_t>(bits) << (16 * i);
+    }
+    return result;
+}
+#endif
+}  // namespace detail
+
+// data must point to kStructuralBlockSize readable bytes
+inline StructuralMasks ScanBlock(const char* data, char delimiter, char quote) {
+    StructuralMasks masks;
+#if defined(__AVX2__)
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+    masks.quotes = detail::MatchMask(lo, hi, quote);
+    masks.delimiters = detail::MatchMask(lo, hi, delimiter);
+    masks.newlines = detail::MatchMask(lo, hi, '\n');
+#elif defined(__SSE2__)
+    __m128i parts[4];
+    for (int i = 0; i < 4; ++i) {
+        parts[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i));
+    }
+    masks.quotes = detail::MatchMask(parts, quote);
+    masks.delimiters = detail::MatchMask(parts, delimiter);
+    masks.newlines = detail::MatchMask(parts, '\n');
+#else
+    for (size_t i = 0; i < kStructuralBlockSize; ++i) {
+        uint64_t bit = uint64_t{1} << i;
+        masks.quotes |= data[i] == quote ? bit : 0;
+        masks.delimiters |= data[i] == delimiter ? bit : 0;
+        masks.newlines |= data[i] == '\n' ? bit : 0;
+    }
+#endif
+    return masks;
+}
+
+// Scans the first n < kStructuralBlockSize bytes, bits past n are zero
+inline StructuralMasks ScanPartialBlock(const char* data, size_t n, char delimiter, char quote) {
+    char block[kStructuralBlockSize] = {};
+    std::memcpy(block, data, n);
+    auto masks = ScanBlock(block, delimiter, quote);
+    uint64_t valid = n == 0 ? 0 : ~uint64_t{0} >> (kStructuralBlockSize - n);
+    masks.quotes &= valid;
+    masks.delimiters &= valid;
+    masks.newlines &= valid;
+    return masks;
+}
+
+// Bit i is the parity of the set bits 0..i
+inline uint64_t PrefixXor(uint64_t bits) {
+#if defined(__PCLMUL__)
+    __m128i product =
+        _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(bits)), _mm_set1_epi8(-1), 0);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+#else
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+#endif
+}
+
+// Marks the bytes inside quoted regions (opening quotes included, closing ones excluded) and
+// carries the state to the next block. Escaped "" pairs toggle twice and cancel out
+inline uint64_t QuotedRegionMask(uint64_t quotes, bool& in_quotes) {
+    uint64_t inside = PrefixXor(quotes) ^ (in_quotes ? ~uint64_t{0} : 0);
+    in_quotes = (inside >> 63) != 0;
+    return inside;
+}
+}  // namespace columnar::csv
@@ -4,14 +4,17 @@
 #include <core/datatype.h>
 #include <exec/aggregation.h>
 #include <util/bit_vector.h>
+#include <util/byte_buffer.h>
 #include <util/string_arena.h>
 
 #include <absl/container/flat_hash_set.h>
 
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -48,15 +51,25 @@ struct MinMax {
     std::vector<int64_t> int_values;
     std::vector<double> double_values;
     std::vector<std::string> string_values;
+    // Heap bytes of string_values beyond the std::string objects
+    size_t string_bytes = 0;
 
     void Reserve(size_t n);
     void PushDefault();
 };
 
+// The distinct values of all groups share one set keyed by (group, value) instead of a set per
+// group, the number of values of every group is kept in counts
 struct Distinct {
     bool is_string = false;
-    std::vector<absl::flat_hash_set<int64_t>> ints;
-    std::vector<absl::flat_hash_set<std::string_view>> strings;
+    std::vector<uint64_t> counts;
+    absl::flat_hash_set<std::pair<uint32_t, int64_t>> ints;
+    absl::flat_hash_set<std::pair<uint32_t, std::string_view>> strings;
+    // The values sorted by group, group g owns [offsets[g], offsets[g + 1]). Rebuilt on demand
+    // when serializing groups
+    std::vector<uint64_t> offsets;
+    std::vector<int64_t> grouped_ints;
+    std::vector<std::string_view> grouped_strings;
 
     void Reserve(size_t n);
     void PushDefault();
@@ -68,6 +81,8 @@ using Any = std::variant<Count, Sum, Avg, MinMax, Distinct>;
 
 class AggStateBuffer {
 public:
+    static constexpr uint32_t kNoGroup = std::numeric_limits<uint32_t>::max();
+
     AggStateBuffer(const std::vector<AggregationUnit>& aggregations, util::StringArena& arena);
 
     AggStateBuffer(const AggStateBuffer&) = delete;
@@ -83,21 +98,25 @@ public:
 
     void Reserve(size_t n);
 
-    void OnRow(uint32_t group_id, const std::vector<const core::Column*>& agg_cols, size_t row) {
-        if (single_count_ != nullptr) {
-            ++single_count_->values[group_id];
-            return;
-        }
-        UpdateRow(group_id, agg_cols, row);
-    }
+    // group_ids[k] is the group of the k-th selected row, rows with kNoGroup are skipped
+    void Update(const std::vector<uint32_t>& group_ids,
+                const std::vector<const core::Column*>& agg_cols,
+                const std::vector<uint32_t>* selection);
 
     void AppendResult(size_t agg_index, uint32_t group_id, core::Column& out) const;
 
+    // Estimated heap bytes held by the states of all groups
+    size_t MemoryUsage() const;
+
+    // Writes the partial states of a group in the form MergeGroup reads back
+    void SerializeGroup(uint32_t group_id, util::BufWriter& w);
+
+    // Folds partial states written by SerializeGroup into a group
+    void MergeGroup(uint32_t group_id, util::BufReader& r);
+
 private:
     static agg_array::Any MakeArray(const AggregationUnit& unit);
 
-    void UpdateRow(uint32_t group_id, const std::vector<const core::Column*>& agg_cols, size_t row);
-
     const std::vector<AggregationUnit>& aggregations_;
     util::StringArena& arena_;
     std::vector<agg_array::Any> arrays_;
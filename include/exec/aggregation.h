@@ -3,11 +3,15 @@
 #include <core/column.h>
 #include <core/schema.h>
 #include <exec/expression/types.h>
+#include <util/string_arena.h>
 
+#include <absl/container/flat_hash_set.h>
+
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
-#include <unordered_set>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -52,6 +56,15 @@ inline AggregationUnit Max(std::shared_ptr<Expression> expression, std::string n
     return {AggregationType::Max, std::move(expression), std::move(name)};
 }
 
+// Once the groups of a hash aggregation hold more than memory_budget bytes (0 is unlimited), their
+// partial states are spilled to spill_partitions files in spill_directory and merged per partition
+// when the input ends
+struct HashAggregationOptions {
+    size_t memory_budget = 0;
+    std::string spill_directory;
+    size_t spill_partitions = 16;
+};
+
 struct CountState {
     uint64_t value = 0;
 };
@@ -74,9 +87,11 @@ struct MinMaxState {
     std::string string_value;
 };
 
+// Distinct strings point into arena
 struct DistinctState {
-    std::unordered_set<int64_t> ints;
-    std::unordered_set<std::string> strings;
+    absl::flat_hash_set<int64_t> ints;
+    absl::flat_hash_set<std::string_view> strings;
+    util::StringArena arena;
 };
 
 using AggregationState = std::variant<CountState, SumState, AvgState, MinMaxState, DistinctState>;
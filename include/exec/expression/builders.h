@@ -57,4 +57,9 @@ inline std::shared_ptr<PrefixCaptureExpr> MakePrefixCapture(std::shared_ptr<Expr
     return std::make_shared<PrefixCaptureExpr>(std::move(arg), std::move(prefixes), delimiter,
                                                require_non_empty, single_line_tail);
 }
+
+inline std::shared_ptr<RuntimeFilterExpr> MakeRuntimeFilter(
+    std::shared_ptr<Expression> key, std::shared_ptr<const RuntimeFilter> filter) {
+    return std::make_shared<RuntimeFilterExpr>(std::move(key), std::move(filter));
+}
 }  // namespace columnar::exec
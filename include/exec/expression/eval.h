@@ -3,6 +3,7 @@
 #include <core/batch.h>
 #include <core/column.h>
 #include <core/datatype.h>
+#include <core/row_selection.h>
 #include <exec/expression/types.h>
 
 #include <cstdint>
@@ -47,5 +48,5 @@ void CollectColumns(const Expression& expr, std::vector<std::string>& columns);
 
 EvalResult Evaluate(const core::Batch& batch, const Expression& expr);
 
-std::vector<uint32_t> EvaluatePredicateSelection(const core::Batch& batch, const Expression& expr);
+core::RowSelection EvaluatePredicateSelection(const core::Batch& batch, const Expression& expr);
 }  // namespace columnar::exec
@@ -11,6 +11,8 @@
 #include <vector>
 
 namespace columnar::exec {
+class RuntimeFilter;
+
 enum class ExpressionType {
     ConstInt64,
     ConstString,
@@ -21,6 +23,7 @@ enum class ExpressionType {
     Case,
     RegexReplace,
     PrefixCapture,
+    RuntimeFilter,
 };
 
 struct Expression {
@@ -171,4 +174,14 @@ struct PrefixCaptureExpr final : public Expression {
     bool require_non_empty = true;
     bool single_line_tail = true;
 };
+
+// True for the rows whose key may be in filter, a NULL key never is
+struct RuntimeFilterExpr final : public Expression {
+    RuntimeFilterExpr(std::shared_ptr<Expression> k, std::shared_ptr<const RuntimeFilter> f)
+        : Expression(ExpressionType::RuntimeFilter), key(std::move(k)), filter(std::move(f)) {
+    }
+
+    std::shared_ptr<Expression> key;
+    std::shared_ptr<const RuntimeFilter> filter;
+};
 }  // namespace columnar::exec
@@ -1,21 +1,8 @@
 #pragma once
 
-#include <exec/expression/eval.h>
 #include <exec/expression/types.h>
 
-#include <vector>
-
 namespace columnar::exec {
-template <typename Unit>
-bool RequiresDenseBatch(const std::vector<Unit>& units) {
-    for (auto& u : units) {
-        if (u.expression != nullptr && !IsTrivialExpression(*u.expression)) {
-            return true;
-        }
-    }
-    return false;
-}
-
 inline bool IsComparisonFunction(BinaryFunction f) {
     return f == BinaryFunction::Equal || f == BinaryFunction::NotEqual ||
            f == BinaryFunction::Less || f == BinaryFunction::LessOrEqual ||
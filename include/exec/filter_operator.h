@@ -18,6 +18,10 @@ public:
         downstream_.Finalize();
     }
 
+    bool Done() const override {
+        return downstream_.Done();
+    }
+
 private:
     IOperator& downstream_;
     std::shared_ptr<Expression> condition_;
@@ -21,20 +21,33 @@ public:
 
     virtual ~GroupKeyTable() = default;
 
-    virtual void Consume(const std::vector<const core::Column*>& key_cols,
-                         const std::vector<const core::Column*>& agg_cols,
-                         const std::vector<uint32_t>* selection, size_t rows,
-                         AggStateBuffer& state) = 0;
+    // Appends the group of every selected row to group_ids, creating missing groups in state.
+    // Rows with a NULL key get AggStateBuffer::kNoGroup
+    virtual void FindGroups(const std::vector<const core::Column*>& key_cols,
+                            const std::vector<uint32_t>* selection, size_t rows,
+                            AggStateBuffer& state, std::vector<uint32_t>& group_ids) = 0;
 
     virtual void AppendKeys(uint32_t group_id, core::Batch& out) const = 0;
 
     virtual void ReserveBuckets(size_t n) = 0;
 
+    // Estimated heap bytes held by the table, not counting strings interned into the arena
+    virtual size_t MemoryUsage() const = 0;
+
     virtual std::optional<size_t> MaxNewGroupsForBatch(
         const std::vector<const core::Column*>& key_cols, size_t selected_rows) const {
         UNUSED(key_cols);
         UNUSED(selected_rows);
         return std::nullopt;
     }
+
+    // After Freeze, FindGroups only looks keys up: rows whose key has no group get
+    // AggStateBuffer::kNoGroup and no group is created
+    virtual void Freeze() {
+        frozen_ = true;
+    }
+
+protected:
+    bool frozen_ = false;
 };
 }  // namespace columnar::exec
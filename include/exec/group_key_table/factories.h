@@ -1,17 +1,21 @@
 #pragma once
 
 #include <exec/group_key_table.h>
+#include <exec/group_key_table/key_layout.h>
 #include <util/string_arena.h>
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
 namespace columnar::exec {
 std::unique_ptr<GroupKeyTable> MakeInt64KeyTable();
 std::unique_ptr<GroupKeyTable> MakeStringKeyTable(util::StringArena& arena);
-std::unique_ptr<GroupKeyTable> MakeInt64PairKeyTable();
 std::unique_ptr<GroupKeyTable> MakeInt64StringKeyTable(util::StringArena& arena);
 std::unique_ptr<GroupKeyTable> MakeInt64Int64StringKeyTable(util::StringArena& arena);
-std::unique_ptr<GroupKeyTable> MakeCompositeKeyTable(const std::vector<ProjectionUnit>& keys,
+std::unique_ptr<GroupKeyTable> MakePackedKeyTable(group_key::KeyLayout layout);
+std::unique_ptr<GroupKeyTable> MakeCompositeKeyTable(group_key::KeyLayout layout,
                                                      util::StringArena& arena);
+std::unique_ptr<GroupKeyTable> MakeDenseIntegerKeyTable(size_t key_count,
+                                                        std::unique_ptr<GroupKeyTable> fallback);
 }  // namespace columnar::exec
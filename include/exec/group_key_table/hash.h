@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <string_view>
 
 namespace columnar::exec::group_key {
 inline void HashCombine(size_t& seed, size_t value) noexcept {
@@ -23,4 +24,25 @@ inline size_t HashIntIntString(int64_t first, int64_t second, size_t third_hash)
     HashCombine(seed, third_hash);
     return seed;
 }
+
+// A string key with its hash computed once per probe and kept in the table, so lookups and
+// prefetches do not rehash the string and most mismatches are rejected without reading it
+struct HashedString {
+    std::string_view value;
+    size_t hash = 0;
+
+    bool operator==(const HashedString& other) const noexcept {
+        return hash == other.hash && value == other.value;
+    }
+};
+
+inline HashedString MakeHashedString(std::string_view value) noexcept {
+    return HashedString{value, std::hash<std::string_view>{}(value)};
+}
+
+struct HashedStringHash {
+    size_t operator()(const HashedString& key) const noexcept {
+        return key.hash;
+    }
+};
 }  // namespace columnar::exec::group_key
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <exec/operator.h>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace columnar::exec::group_key {
+// Integer-only keys up to this width are packed into machine words instead of a byte blob
+inline constexpr size_t kMaxPackedKeyBytes = 32;
+
+struct KeyPart {
+    bool is_string = false;
+    // Bytes of an integer part and its offset in a fixed-width key
+    size_t width = 0;
+    size_t offset = 0;
+};
+
+// Serialized form of a multi-column group key. Integer parts take the width of their type, string
+// parts are written as a uint32 length followed by the bytes. Keys without string parts therefore
+// have the same fixed width for every row
+struct KeyLayout {
+    std::vector<KeyPart> parts;
+    size_t fixed_width = 0;
+    bool has_strings = false;
+};
+
+KeyLayout MakeKeyLayout(const std::vector<ProjectionUnit>& keys);
+
+// Key bytes packed into kWords machine words, compared and hashed word-wise
+template <size_t kWords>
+struct PackedKey {
+    std::array<uint64_t, kWords> words{};
+
+    uint8_t* Bytes() noexcept {
+        return reinterpret_cast<uint8_t*>(words.data());
+    }
+
+    const uint8_t* Bytes() const noexcept {
+        return reinterpret_cast<const uint8_t*>(words.data());
+    }
+
+    bool operator==(const PackedKey&) const = default;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const PackedKey& key) {
+        return H::combine_contiguous(std::move(h), key.words.data(), kWords);
+    }
+};
+
+// Writes the low width bytes of value in little-endian order
+inline void StoreInteger(int64_t value, size_t width, uint8_t* out) {
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(out, &value, width);
+    } else {
+        for (size_t i = 0; i < width; ++i) {
+            out[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i));
+        }
+    }
+}
+
+// Reads a value written by StoreInteger and sign-extends it back to int64
+inline int64_t LoadInteger(const uint8_t* in, size_t width) {
+    uint64_t bits = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(&bits, in, width);
+    } else {
+        for (size_t i = 0; i < width; ++i) {
+            bits |= static_cast<uint64_t>(in[i]) << (8 * i);
+        }
+    }
+    size_t shift = 64 - 8 * width;
+    return static_cast<int64_t>(bits << shift) >> shift;
+}
+}  // namespace columnar::exec::group_key
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+namespace columnar::exec::group_key {
+// Heap bytes of a vector-like container, counting its reserved capacity
+template <typename Vector>
+size_t VectorBytes(const Vector& values) noexcept {
+    return values.capacity() * sizeof(typename Vector::value_type);
+}
+
+// Heap bytes of an absl flat hash table: a slot and a control byte per bucket
+template <typename Table>
+size_t FlatTableBytes(const Table& table) noexcept {
+    return table.capacity() * (sizeof(typename Table::value_type) + 1);
+}
+}  // namespace columnar::exec::group_key
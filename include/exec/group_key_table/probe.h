@@ -0,0 +1,69 @@
+#pragma once
+
+#include <exec/agg_state_buffer.h>
+#include <exec/selection.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace columnar::exec::group_key {
+// How many probes ahead of the current one the bucket of a key is prefetched
+inline constexpr size_t kPrefetchDistance = 8;
+
+// Probe keys of the selected rows that have no NULL key part. The group of keys[i] is written to
+// group_ids[slots[i]]
+template <typename Key>
+struct ProbeBatch {
+    std::vector<Key> keys;
+    std::vector<uint32_t> slots;
+};
+
+// Appends one kNoGroup entry per selected row to group_ids and collects make_key(row) for every
+// row where is_null(row) does not hold
+template <typename Key, typename IsNull, typename MakeKey>
+void GatherProbes(const std::vector<uint32_t>* selection, size_t rows,
+                  std::vector<uint32_t>& group_ids, ProbeBatch<Key>& batch, IsNull&& is_null,
+                  MakeKey&& make_key) {
+    size_t slot = group_ids.size();
+    size_t selected = selection != nullptr ? selection->size() : rows;
+    group_ids.resize(slot + selected, AggStateBuffer::kNoGroup);
+    batch.keys.clear();
+    batch.slots.clear();
+    batch.keys.reserve(selected);
+    batch.slots.reserve(selected);
+    ForSelectedRows(selection, rows, [&](size_t row) {
+        if (!is_null(row)) {
+            batch.keys.push_back(make_key(row));
+            batch.slots.push_back(static_cast<uint32_t>(slot));
+        }
+        ++slot;
+    });
+}
+
+// Resolves every gathered key with find_or_insert(key) and prefetches the table bucket of the key
+// kPrefetchDistance probes ahead, so the cache misses of consecutive probes overlap. Tables are
+// prefetched through Prefetch() when they have one and through absl's prefetch() otherwise
+template <typename Table, typename Key, typename FindOrInsert>
+void ResolveProbes(const Table& table, const ProbeBatch<Key>& batch,
+                   std::vector<uint32_t>& group_ids, FindOrInsert&& find_or_insert) {
+    auto prefetch = [&](const Key& key) {
+        if constexpr (requires { table.Prefetch(key); }) {
+            table.Prefetch(key);
+        } else {
+            table.prefetch(key);
+        }
+    };
+    size_t n = batch.keys.size();
+    for (size_t i = 0; i < std::min(n, kPrefetchDistance); ++i) {
+        prefetch(batch.keys[i]);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (i + kPrefetchDistance < n) {
+            prefetch(batch.keys[i + kPrefetchDistance]);
+        }
+        group_ids[batch.slots[i]] = find_or_insert(batch.keys[i]);
+    }
+}
+}  // namespace columnar::exec::group_key
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <exec/group_key_table/hash.h>
+#include <exec/group_key_table/key_layout.h>
+#include <exec/group_key_table/memory.h>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+namespace columnar::exec::group_key {
+// Maps strings to values through sub-tables by key length, in the style of ClickHouse's
+// StringHashMap. Keys of up to 8, 16 and 24 bytes are stored inline as zero-padded words, so
+// probing them hashes a few words and never reads the string storage. Longer keys, and keys
+// ending in a zero byte (whose padding would be ambiguous), go to a general table that keeps the
+// string hash
+template <typename V>
+class StringHashMap {
+public:
+    enum class LengthClass : uint8_t { Empty, Words1, Words2, Words3, General };
+
+    // A key prepared for lookup: its length class and either its inline words or its hash
+    struct Probe {
+        std::string_view value;
+        LengthClass length_class = LengthClass::Empty;
+        PackedKey<3> words;
+        size_t hash = 0;
+    };
+
+    static Probe MakeProbe(std::string_view key) noexcept {
+        Probe probe;
+        probe.value = key;
+        if (key.empty()) {
+            return probe;
+        }
+        if (key.size() > 3 * sizeof(uint64_t) || key.back() == '\0') {
+            probe.length_class = LengthClass::General;
+            probe.hash = MakeHashedString(key).hash;
+            return probe;
+        }
+        std::memcpy(probe.words.Bytes(), key.data(), key.size());
+        size_t words = (key.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        probe.length_class = static_cast<LengthClass>(words);
+        return probe;
+    }
+
+    void Prefetch(const Probe& probe) const {
+        switch (probe.length_class) {
+            case LengthClass::Empty:
+                return;
+            case LengthClass::Words1:
+                words1_.prefetch(Words<1>(probe));
+                return;
+            case LengthClass::Words2:
+                words2_.prefetch(Words<2>(probe));
+                return;
+            case LengthClass::Words3:
+                words3_.prefetch(probe.words);
+                return;
+            case LengthClass::General:
+                general_.prefetch(HashedString{probe.value, probe.hash});
+                return;
+        }
+    }
+
+    const V* Find(const Probe& probe) const {
+        switch (probe.length_class) {
+            case LengthClass::Empty:
+                return empty_ ? &*empty_ : nullptr;
+            case LengthClass::Words1:
+                return FindIn(words1_, Words<1>(probe));
+            case LengthClass::Words2:
+                return FindIn(words2_, Words<2>(probe));
+            case LengthClass::Words3:
+                return FindIn(words3_, probe.words);
+            case LengthClass::General:
+                return FindIn(general_, HashedString{probe.value, probe.hash});
+        }
+        return nullptr;
+    }
+
+    // Inserts a missing key. stored_key equals probe.value and must outlive the map, as the
+    // general table keeps a view of it
+    void Insert(const Probe& probe, std::string_view stored_key, V value) {
+        switch (probe.length_class) {
+            case LengthClass::Empty:
+                empty_ = value;
+                return;
+            case LengthClass::Words1:
+                words1_.emplace(Words<1>(probe), value);
+                return;
+            case LengthClass::Words2:
+                words2_.emplace(Words<2>(probe), value);
+                return;
+            case LengthClass::Words3:
+                words3_.emplace(probe.words, value);
+                return;
+            case LengthClass::General:
+                general_.emplace(HashedString{stored_key, probe.hash}, value);
+                return;
+        }
+    }
+
+    size_t Size() const noexcept {
+        return (empty_ ? 1 : 0) + words1_.size() + words2_.size() + words3_.size() +
+               general_.size();
+    }
+
+    size_t MemoryUsage() const noexcept {
+        return FlatTableBytes(words1_) + FlatTableBytes(words2_) + FlatTableBytes(words3_) +
+               FlatTableBytes(general_);
+    }
+
+    // Splits n keys between the sub-tables in the proportions seen so far, evenly before the first
+    // insert
+    void Reserve(size_t n) {
+        size_t size = Size();
+        if (size == 0) {
+            size_t share = (n + 3) / 4;
+            words1_.reserve(share);
+            words2_.reserve(share);
+            words3_.reserve(share);
+            general_.reserve(share);
+            return;
+        }
+        if (n <= size) {
+            return;
+        }
+        auto share = [&](size_t part) { return (n * part + size - 1) / size; };
+        words1_.reserve(share(words1_.size()));
+        words2_.reserve(share(words2_.size()));
+        words3_.reserve(share(words3_.size()));
+        general_.reserve(share(general_.size()));
+    }
+
+private:
+    template <size_t kWords>
+    static PackedKey<kWords> Words(const Probe& probe) noexcept {
+        PackedKey<kWords> key;
+        for (size_t i = 0; i < kWords; ++i) {
+            key.words[i] = probe.words.words[i];
+        }
+        return key;
+    }
+
+    template <typename Map, typename Key>
+    static const V* FindIn(const Map& map, const Key& key) {
+        auto it = map.find(key);
+        return it == map.end() ? nullptr : &it->second;
+    }
+
+    std::optional<V> empty_;
+    absl::flat_hash_map<PackedKey<1>, V> words1_;
+    absl::flat_hash_map<PackedKey<2>, V> words2_;
+    absl::flat_hash_map<PackedKey<3>, V> words3_;
+    absl::flat_hash_map<HashedString, V, HashedStringHash> general_;
+};
+}  // namespace columnar::exec::group_key
@@ -4,17 +4,24 @@
 #include <exec/agg_state_buffer.h>
 #include <exec/group_key_table.h>
 #include <exec/operator.h>
+#include <exec/spill_file.h>
 #include <util/string_arena.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 namespace columnar::exec {
+// The key columns followed by the aggregation results
+core::Schema MakeHashAggregateSchema(const std::vector<ProjectionUnit>& keys,
+                                     const std::vector<AggregationUnit>& aggregations);
+
 class HashAggregationSink final : public IOperator {
 public:
     HashAggregationSink(IOperator& downstream, std::vector<ProjectionUnit> keys,
-                        std::vector<AggregationUnit> aggregations);
+                        std::vector<AggregationUnit> aggregations,
+                        HashAggregationOptions options = {});
 
     HashAggregationSink(const HashAggregationSink&) = delete;
     HashAggregationSink& operator=(const HashAggregationSink&) = delete;
@@ -28,15 +35,32 @@ public:
 private:
     void ReserveForBatch(size_t selected_rows, size_t max_new_groups);
 
+    size_t MemoryUsage() const;
+
+    // Writes the keys and partial states of every group to the spill partitions and starts a new
+    // generation of groups
+    void SpillGeneration();
+
+    // Merges the partial states of a spill partition and writes the final rows of its groups to
+    // run, ordered by the position where each group was first seen
+    void MergePartition(SpillFile& partition, SpillFile& run) const;
+
+    // Emits the rows of all runs in the order their groups were first seen
+    void EmitRuns(std::vector<std::unique_ptr<SpillFile>>& runs);
+
     IOperator& downstream_;
     std::vector<ProjectionUnit> keys_;
     std::vector<AggregationUnit> aggregations_;
+    HashAggregationOptions options_;
     core::Schema output_schema_;
-    bool needs_dense_;
+    core::Schema key_schema_;
     size_t input_rows_seen_ = 0;
     size_t reserved_groups_ = 0;
     util::StringArena string_arena_;
-    AggStateBuffer state_;
+    std::unique_ptr<AggStateBuffer> state_;
     std::unique_ptr<GroupKeyTable> key_table_;
+    std::vector<uint32_t> group_ids_;
+    uint32_t generation_ = 0;
+    std::vector<std::unique_ptr<SpillFile>> partitions_;
 };
 }  // namespace columnar::exec
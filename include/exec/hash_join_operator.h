@@ -0,0 +1,78 @@
+#pragma once
+
+#include <core/batch.h>
+#include <core/schema.h>
+#include <exec/agg_state_buffer.h>
+#include <exec/group_key_table.h>
+#include <exec/operator.h>
+#include <exec/runtime_filter.h>
+#include <util/string_arena.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace columnar::exec {
+// Builds a GroupKeyTable over the keys of the build batches, every key is one group and the build
+// rows of a group are chained in input order. The table is then frozen and every probe batch is
+// looked up in it at once. The build batches must outlive the sink, build_schema is their
+// schema and gives the build columns of the output
+class HashJoinSink final : public IOperator {
+public:
+    HashJoinSink(IOperator& downstream, const std::vector<core::Batch>& build,
+                 const core::Schema& build_schema,
+                 const std::vector<std::shared_ptr<Expression>>& probe_keys,
+                 const std::vector<std::shared_ptr<Expression>>& build_keys, JoinType join_type);
+
+    HashJoinSink(const HashJoinSink&) = delete;
+    HashJoinSink& operator=(const HashJoinSink&) = delete;
+    HashJoinSink(HashJoinSink&&) = delete;
+    HashJoinSink& operator=(HashJoinSink&&) = delete;
+
+    void Consume(core::Batch batch) override;
+
+    void Finalize() override {
+        downstream_.Finalize();
+    }
+
+    bool Done() const override {
+        return downstream_.Done();
+    }
+
+    // The distinct build keys, for the probe scan to drop rows without a match early. Null when
+    // the join keeps such rows or has more than one key
+    std::shared_ptr<const RuntimeFilter> KeyFilter() const;
+
+private:
+    struct BuildRow {
+        uint32_t batch;
+        uint32_t row;
+    };
+
+    // Writes the group of every selected row of batch to group_ids_
+    void FindGroups(const core::Batch& batch, const std::vector<ProjectionUnit>& keys);
+
+    void Build();
+
+    // Outputs the selected probe rows that have (semi) or do not have (anti) a match
+    void EmitFiltered(core::Batch batch, bool matched);
+
+    void EmitJoined(const core::Batch& batch);
+
+    IOperator& downstream_;
+    const std::vector<core::Batch>& build_;
+    std::vector<ProjectionUnit> probe_keys_;
+    std::vector<ProjectionUnit> build_keys_;
+    JoinType join_type_;
+    core::Schema build_schema_;
+    util::StringArena string_arena_;
+    std::vector<AggregationUnit> no_aggregations_;
+    std::unique_ptr<AggStateBuffer> state_;
+    std::unique_ptr<GroupKeyTable> key_table_;
+    std::vector<BuildRow> build_rows_;
+    // The first build row of every group, the next row of the same group is next_row_[row]
+    std::vector<uint32_t> first_row_;
+    std::vector<uint32_t> next_row_;
+    std::vector<uint32_t> group_ids_;
+};
+}  // namespace columnar::exec
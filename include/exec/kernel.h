@@ -3,6 +3,9 @@
 #include <core/batch.h>
 #include <core/column.h>
 #include <core/columns/bool_column.h>
+#include <util/string_arena.h>
+
+#include <absl/container/flat_hash_set.h>
 #include <re2/re2.h>
 
 #include <cstddef>
@@ -10,58 +13,89 @@
 #include <memory>
 #include <string>
 #include <string_view>
-#include <unordered_set>
 #include <vector>
 
 namespace columnar::exec::kernel {
 std::unique_ptr<core::Column> ConstInt64(int64_t value, size_t rows);
 std::unique_ptr<core::Column> ConstString(std::string_view value, size_t rows);
 
-std::unique_ptr<core::Column> Equal(const core::Column& lhs, const core::Column& rhs);
-std::unique_ptr<core::Column> NotEqual(const core::Column& lhs, const core::Column& rhs);
-std::unique_ptr<core::Column> Less(const core::Column& lhs, const core::Column& rhs);
-std::unique_ptr<core::Column> LessOrEqual(const core::Column& lhs, const core::Column& rhs);
-std::unique_ptr<core::Column> Greater(const core::Column& lhs, const core::Column& rhs);
-std::unique_ptr<core::Column> GreaterOrEqual(const core::Column& lhs, const core::Column& rhs);
-
-std::unique_ptr<core::Column> EqualConstInt(const core::Column& col, int64_t value);
-std::unique_ptr<core::Column> NotEqualConstInt(const core::Column& col, int64_t value);
-std::unique_ptr<core::Column> LessConstInt(const core::Column& col, int64_t value);
-std::unique_ptr<core::Column> LessOrEqualConstInt(const core::Column& col, int64_t value);
-std::unique_ptr<core::Column> GreaterConstInt(const core::Column& col, int64_t value);
-std::unique_ptr<core::Column> GreaterOrEqualConstInt(const core::Column& col, int64_t value);
-
-std::unique_ptr<core::Column> EqualConstString(const core::Column& col, std::string_view value);
-std::unique_ptr<core::Column> NotEqualConstString(const core::Column& col, std::string_view value);
-std::unique_ptr<core::Column> LessConstString(const core::Column& col, std::string_view value);
-std::unique_ptr<core::Column> LessOrEqualConstString(const core::Column& col,
-                                                     std::string_view value);
-std::unique_ptr<core::Column> GreaterConstString(const core::Column& col, std::string_view value);
-std::unique_ptr<core::Column> GreaterOrEqualConstString(const core::Column& col,
-                                                        std::string_view value);
-
-std::unique_ptr<core::Column> And(const core::Column& lhs, const core::Column& rhs);
-std::unique_ptr<core::Column> Or(const core::Column& lhs, const core::Column& rhs);
-
-std::unique_ptr<core::Column> Add(const core::Column& lhs, const core::Column& rhs);
-std::unique_ptr<core::Column> Subtract(const core::Column& lhs, const core::Column& rhs);
-std::unique_ptr<core::Column> Multiply(const core::Column& lhs, const core::Column& rhs);
+// The kernels below compute only the rows in selection when it is given, the result keeps the
+// row count of the input and its rows outside the selection are unspecified
+std::unique_ptr<core::Column> Equal(const core::Column& lhs, const core::Column& rhs,
+                                    const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> NotEqual(const core::Column& lhs, const core::Column& rhs,
+                                       const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> Less(const core::Column& lhs, const core::Column& rhs,
+                                   const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> LessOrEqual(const core::Column& lhs, const core::Column& rhs,
+                                          const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> Greater(const core::Column& lhs, const core::Column& rhs,
+                                      const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> GreaterOrEqual(const core::Column& lhs, const core::Column& rhs,
+                                             const std::vector<uint32_t>* selection = nullptr);
+
+std::unique_ptr<core::Column> EqualConstInt(const core::Column& col, int64_t value,
+                                            const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> NotEqualConstInt(const core::Column& col, int64_t value,
+                                               const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> LessConstInt(const core::Column& col, int64_t value,
+                                           const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> LessOrEqualConstInt(const core::Column& col, int64_t value,
+                                                  const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> GreaterConstInt(const core::Column& col, int64_t value,
+                                              const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> GreaterOrEqualConstInt(
+    const core::Column& col, int64_t value, const std::vector<uint32_t>* selection = nullptr);
+
+std::unique_ptr<core::Column> EqualConstString(const core::Column& col, std::string_view value,
+                                               const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> NotEqualConstString(const core::Column& col, std::string_view value,
+                                                  const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> LessConstString(const core::Column& col, std::string_view value,
+                                              const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> LessOrEqualConstString(
+    const core::Column& col, std::string_view value,
+    const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> GreaterConstString(const core::Column& col, std::string_view value,
+                                                 const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> GreaterOrEqualConstString(
+    const core::Column& col, std::string_view value,
+    const std::vector<uint32_t>* selection = nullptr);
+
+std::unique_ptr<core::Column> And(const core::Column& lhs, const core::Column& rhs,
+                                  const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> Or(const core::Column& lhs, const core::Column& rhs,
+                                 const std::vector<uint32_t>* selection = nullptr);
+
+std::unique_ptr<core::Column> Add(const core::Column& lhs, const core::Column& rhs,
+                                  const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> Subtract(const core::Column& lhs, const core::Column& rhs,
+                                       const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> Multiply(const core::Column& lhs, const core::Column& rhs,
+                                       const std::vector<uint32_t>* selection = nullptr);
 
 std::unique_ptr<core::Column> StrContains(const core::Column& operand, std::string_view substring,
-                                          bool negated);
-std::unique_ptr<core::Column> StrLength(const core::Column& operand);
-std::unique_ptr<core::Column> ExtractMinute(const core::Column& operand);
-std::unique_ptr<core::Column> TruncMinute(const core::Column& operand);
+                                          bool negated,
+                                          const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> StrLength(const core::Column& operand,
+                                        const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> ExtractMinute(const core::Column& operand,
+                                            const std::vector<uint32_t>* selection = nullptr);
+std::unique_ptr<core::Column> TruncMinute(const core::Column& operand,
+                                          const std::vector<uint32_t>* selection = nullptr);
 std::unique_ptr<core::Column> RegexReplace(const core::Column& operand, const RE2& regex,
-                                           const std::string& replacement);
+                                           const std::string& replacement,
+                                           const std::vector<uint32_t>* selection = nullptr);
 std::unique_ptr<core::Column> PrefixCapture(const core::Column& operand,
                                             const std::vector<std::string>& prefixes,
                                             char delimiter, bool require_non_empty = true,
-                                            bool single_line_tail = true);
+                                            bool single_line_tail = true,
+                                            const std::vector<uint32_t>* selection = nullptr);
 
 std::unique_ptr<core::Column> CaseSelect(const core::BoolColumn& mask,
                                          const core::Column& when_true,
-                                         const core::Column& when_false);
+                                         const core::Column& when_false,
+                                         const std::vector<uint32_t>* selection = nullptr);
 
 std::vector<uint32_t> MaskToSelection(const core::BoolColumn& mask);
 
@@ -99,8 +133,9 @@ AvgPartial Avg(const core::Column& col, const std::vector<uint32_t>* selection =
 
 uint64_t CountNonNull(const core::Column& col, const std::vector<uint32_t>* selection = nullptr);
 
-void DistinctInts(const core::Column& col, std::unordered_set<int64_t>& out,
+void DistinctInts(const core::Column& col, absl::flat_hash_set<int64_t>& out,
                   const std::vector<uint32_t>* selection = nullptr);
-void DistinctStrings(const core::Column& col, std::unordered_set<std::string>& out,
-                     const std::vector<uint32_t>* selection = nullptr);
+// New strings are interned into arena before they are added to out
+void DistinctStrings(const core::Column& col, absl::flat_hash_set<std::string_view>& out,
+                     util::StringArena& arena, const std::vector<uint32_t>* selection = nullptr);
 }  // namespace columnar::exec::kernel
@@ -7,6 +7,7 @@
 #include <exec/column_dispatch.h>
 #include <exec/selection.h>
 #include <exec/kernel.h>
+#include <util/bit_vector.h>
 
 #include <cstddef>
 #include <memory>
@@ -22,10 +23,41 @@ auto VisitNumericCol(const core::Column& col, V&& v) {
     return VisitIntegerCol(col, std::forward<V>(v));
 }
 
-inline std::unique_ptr<core::BoolColumn> MakeBoolColumn(size_t rows) {
-    auto out = std::make_unique<core::BoolColumn>(false);
-    out->Reserve(rows);
-    return out;
+// A bool column of rows values, pred(i) at the selected rows and false at the others
+template <typename Pred>
+std::unique_ptr<core::BoolColumn> MakeBoolColumnWhere(size_t rows,
+                                                      const std::vector<uint32_t>* selection,
+                                                      Pred&& pred) {
+    util::BitVector data(rows);
+    ForSelectedRows(selection, rows, [&](size_t i) {
+        if (pred(i)) {
+            data.Set(i);
+        }
+    });
+    return std::make_unique<core::BoolColumn>(std::move(data), util::BitVector(), false, rows);
+}
+
+// Calls f(i) for the selected rows and skip(i) for the others, in row order, so that kernels
+// appending their output keep the row positions of the input
+template <typename F, typename Skip>
+void ForRowsBySelection(const std::vector<uint32_t>* selection, size_t rows, F&& f, Skip&& skip) {
+    if (selection == nullptr) {
+        for (size_t i = 0; i < rows; ++i) {
+            f(i);
+        }
+        return;
+    }
+    size_t next = 0;
+    for (uint32_t row : *selection) {
+        for (; next < row; ++next) {
+            skip(next);
+        }
+        f(static_cast<size_t>(row));
+        next = static_cast<size_t>(row) + 1;
+    }
+    for (; next < rows; ++next) {
+        skip(next);
+    }
 }
 
 template <typename Col, typename F>
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <bruh/bruh_batch_reader.h>
+#include <exec/operator.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace columnar::exec {
+// Replaces the row id column of its input with the given columns of the rows it identifies,
+// read from reader. Rows keep their input order
+class LateMaterializeSink final : public IOperator {
+public:
+    LateMaterializeSink(bruh::BruhBatchReader& reader, IOperator& downstream,
+                        std::vector<size_t> column_indexes)
+        : reader_(reader), downstream_(downstream), column_indexes_(std::move(column_indexes)) {
+    }
+
+    void Consume(core::Batch batch) override;
+
+    void Finalize() override;
+
+private:
+    bruh::BruhBatchReader& reader_;
+    IOperator& downstream_;
+    std::vector<size_t> column_indexes_;
+    std::vector<core::Batch> buffer_;
+};
+}  // namespace columnar::exec
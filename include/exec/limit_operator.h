@@ -0,0 +1,31 @@
+#pragma once
+
+#include <exec/operator.h>
+
+#include <cstddef>
+
+namespace columnar::exec {
+// Passes on the rows after the first offset ones until limit rows have been passed, then reports
+// Done() so that the scan below stops reading row groups
+class LimitSink final : public IOperator {
+public:
+    LimitSink(IOperator& downstream, size_t limit, size_t offset)
+        : downstream_(downstream), remaining_(limit), to_skip_(offset) {
+    }
+
+    void Consume(core::Batch batch) override;
+
+    void Finalize() override {
+        downstream_.Finalize();
+    }
+
+    bool Done() const override {
+        return remaining_ == 0 || downstream_.Done();
+    }
+
+private:
+    IOperator& downstream_;
+    size_t remaining_;
+    size_t to_skip_;
+};
+}  // namespace columnar::exec
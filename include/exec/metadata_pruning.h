@@ -8,6 +8,12 @@ class BruhBatchReader;
 
 namespace columnar::exec {
 class Expression;
+struct ColumnExpr;
+struct TopNThreshold;
 
 bool PredicateMayMatch(bruh::BruhBatchReader& reader, size_t row_group, const Expression& expr);
+
+// Returns false if no row of the row group can reach a TopN whose first sort key is column
+bool TopNMayImprove(bruh::BruhBatchReader& reader, size_t row_group, const ColumnExpr& column,
+                    const TopNThreshold& threshold);
 }  // namespace columnar::exec
@@ -6,9 +6,11 @@
 #include <exec/aggregation.h>
 #include <exec/expression/types.h>
 
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -20,6 +22,11 @@ public:
     virtual void Consume(core::Batch batch) = 0;
 
     virtual void Finalize() = 0;
+
+    // True once the operator needs no more input, so that the producer may stop early
+    virtual bool Done() const {
+        return false;
+    }
 };
 
 class CollectSink final : public IOperator {
@@ -45,6 +52,9 @@ enum class OperatorType {
     Filter,
     Project,
     TopN,
+    Sort,
+    Limit,
+    HashJoin,
 };
 
 struct ProjectionUnit {
@@ -57,6 +67,13 @@ struct SortUnit {
     bool ascending = true;
 };
 
+// Once the buffered input of a sort holds more than memory_budget bytes (0 is unlimited), it is
+// sorted and spilled as a run to spill_directory. Runs are merged when the input ends
+struct SortOptions {
+    size_t memory_budget = 0;
+    std::string spill_directory;
+};
+
 struct Operator {
     explicit Operator(OperatorType type) : type(type) {
     }
@@ -72,8 +89,13 @@ struct TypedOperator : public Operator {
     }
 };
 
+// Name of the Int64 column a scan appends when it is asked for row ids. A row id is
+// (row_group << 32) | row
+inline constexpr std::string_view kRowIdColumn = "__row_id";
+
 struct ScanOperator final : public TypedOperator<OperatorType::Scan> {
     core::Schema schema;
+    bool row_ids = false;
 };
 
 struct CountTableOperator final : public TypedOperator<OperatorType::CountTable> {
@@ -96,13 +118,18 @@ struct GlobalAggregationOperator final : public TypedOperator<OperatorType::Glob
 
 struct HashAggregationOperator final : public TypedOperator<OperatorType::HashAggregation> {
     HashAggregationOperator(std::shared_ptr<Operator> child, std::vector<ProjectionUnit> keys,
-                            std::vector<AggregationUnit> aggregations)
-        : child(std::move(child)), keys(std::move(keys)), aggregations(std::move(aggregations)) {
+                            std::vector<AggregationUnit> aggregations,
+                            HashAggregationOptions options = {})
+        : child(std::move(child)),
+          keys(std::move(keys)),
+          aggregations(std::move(aggregations)),
+          options(std::move(options)) {
     }
 
     std::shared_ptr<Operator> child;
     std::vector<ProjectionUnit> keys;
     std::vector<AggregationUnit> aggregations;
+    HashAggregationOptions options;
 };
 
 struct FilterOperator final : public TypedOperator<OperatorType::Filter> {
@@ -133,6 +160,71 @@ struct TopNOperator final : public TypedOperator<OperatorType::TopN> {
     std::vector<SortUnit> sort_units;
     std::optional<size_t> limit;
     std::optional<size_t> offset;
+    // Columns the planner left out of the scan below. They are read for the output rows only,
+    // by their row ids
+    std::vector<std::string> late_columns;
+};
+
+struct SortOperator final : public TypedOperator<OperatorType::Sort> {
+    SortOperator(std::shared_ptr<Operator> child, std::vector<SortUnit> sort_units,
+                 SortOptions options = {})
+        : child(std::move(child)), sort_units(std::move(sort_units)), options(std::move(options)) {
+    }
+
+    std::shared_ptr<Operator> child;
+    std::vector<SortUnit> sort_units;
+    SortOptions options;
+};
+
+struct LimitOperator final : public TypedOperator<OperatorType::Limit> {
+    LimitOperator(std::shared_ptr<Operator> child, size_t limit, std::optional<size_t> offset)
+        : child(std::move(child)), limit(limit), offset(offset) {
+    }
+
+    std::shared_ptr<Operator> child;
+    size_t limit;
+    std::optional<size_t> offset;
+};
+
+enum class JoinType {
+    Inner,
+    // Probe rows without a match are kept once, with NULL build columns
+    Left,
+    // Probe rows with at least one match, without build columns
+    Semi,
+    // Probe rows without a match, without build columns
+    Anti,
+};
+
+// The build rows of a hash join: the output of plan executed over reader, or batches already in
+// memory with the given schema when reader is null. The build columns of the output are those
+// of the output schema of plan or of schema, even when there are no build rows
+struct JoinBuild {
+    bruh::BruhBatchReader* reader = nullptr;
+    std::shared_ptr<Operator> plan;
+    std::vector<core::Batch> batches;
+    core::Schema schema;
+};
+
+// Joins the rows of probe with the build rows whose keys are equal, NULL keys match nothing. The
+// output has the probe columns followed by the build columns, semi and anti joins output the
+// probe columns only
+struct HashJoinOperator final : public TypedOperator<OperatorType::HashJoin> {
+    HashJoinOperator(std::shared_ptr<Operator> probe, JoinBuild build,
+                     std::vector<std::shared_ptr<Expression>> probe_keys,
+                     std::vector<std::shared_ptr<Expression>> build_keys, JoinType join_type)
+        : probe(std::move(probe)),
+          build(std::move(build)),
+          probe_keys(std::move(probe_keys)),
+          build_keys(std::move(build_keys)),
+          join_type(join_type) {
+    }
+
+    std::shared_ptr<Operator> probe;
+    JoinBuild build;
+    std::vector<std::shared_ptr<Expression>> probe_keys;
+    std::vector<std::shared_ptr<Expression>> build_keys;
+    JoinType join_type;
 };
 
 inline std::shared_ptr<ScanOperator> MakeScan() {
@@ -160,9 +252,9 @@ inline std::shared_ptr<ProjectOperator> MakeProject(std::shared_ptr<Operator> ch
 
 inline std::shared_ptr<HashAggregationOperator> MakeHashAggregation(
     std::shared_ptr<Operator> child, std::vector<ProjectionUnit> keys,
-    std::vector<AggregationUnit> aggregations) {
+    std::vector<AggregationUnit> aggregations, HashAggregationOptions options = {}) {
     return std::make_shared<HashAggregationOperator>(std::move(child), std::move(keys),
-                                                     std::move(aggregations));
+                                                     std::move(aggregations), std::move(options));
 }
 
 inline std::shared_ptr<HashAggregationOperator> MakeHashAggregation(
@@ -173,6 +265,11 @@ inline std::shared_ptr<HashAggregationOperator> MakeHashAggregation(
     return MakeHashAggregation(std::move(child), std::move(keys), std::move(aggregations));
 }
 
+inline std::shared_ptr<LimitOperator> MakeLimit(std::shared_ptr<Operator> child, size_t limit,
+                                                std::optional<size_t> offset = std::nullopt) {
+    return std::make_shared<LimitOperator>(std::move(child), limit, offset);
+}
+
 inline std::shared_ptr<TopNOperator> MakeTopN(std::shared_ptr<Operator> child,
                                               std::vector<SortUnit> sort_units,
                                               std::optional<size_t> limit = std::nullopt,
@@ -180,5 +277,37 @@ inline std::shared_ptr<TopNOperator> MakeTopN(std::shared_ptr<Operator> child,
     return std::make_shared<TopNOperator>(std::move(child), std::move(sort_units), limit, offset);
 }
 
+inline std::shared_ptr<SortOperator> MakeSort(std::shared_ptr<Operator> child,
+                                              std::vector<SortUnit> sort_units,
+                                              SortOptions options = {}) {
+    return std::make_shared<SortOperator>(std::move(child), std::move(sort_units),
+                                          std::move(options));
+}
+
+inline std::shared_ptr<HashJoinOperator> MakeHashJoin(
+    std::shared_ptr<Operator> probe, std::vector<core::Batch> build_batches,
+    core::Schema build_schema, std::vector<std::shared_ptr<Expression>> probe_keys,
+    std::vector<std::shared_ptr<Expression>> build_keys, JoinType join_type = JoinType::Inner) {
+    JoinBuild build;
+    build.batches = std::move(build_batches);
+    build.schema = std::move(build_schema);
+    return std::make_shared<HashJoinOperator>(std::move(probe), std::move(build),
+                                              std::move(probe_keys), std::move(build_keys),
+                                              join_type);
+}
+
+// The build side is plan executed over build_reader, which must outlive the execution
+inline std::shared_ptr<HashJoinOperator> MakeHashJoin(
+    std::shared_ptr<Operator> probe, bruh::BruhBatchReader& build_reader,
+    std::shared_ptr<Operator> build_plan, std::vector<std::shared_ptr<Expression>> probe_keys,
+    std::vector<std::shared_ptr<Expression>> build_keys, JoinType join_type = JoinType::Inner) {
+    JoinBuild build;
+    build.reader = &build_reader;
+    build.plan = std::move(build_plan);
+    return std::make_shared<HashJoinOperator>(std::move(probe), std::move(build),
+                                              std::move(probe_keys), std::move(build_keys),
+                                              join_type);
+}
+
 std::vector<core::Batch> Execute(bruh::BruhBatchReader& reader, std::shared_ptr<Operator> op);
 }  // namespace columnar::exec
@@ -28,6 +28,15 @@ void VisitOperator(const Operator& op, Visitor& visitor) {
         case OperatorType::TopN:
             visitor.Visit(static_cast<const TopNOperator&>(op));
             return;
+        case OperatorType::Sort:
+            visitor.Visit(static_cast<const SortOperator&>(op));
+            return;
+        case OperatorType::Limit:
+            visitor.Visit(static_cast<const LimitOperator&>(op));
+            return;
+        case OperatorType::HashJoin:
+            visitor.Visit(static_cast<const HashJoinOperator&>(op));
+            return;
     }
     THROW_RUNTIME_ERROR("Unsupported operator type " + std::to_string(static_cast<int>(op.type)));
 }
@@ -56,6 +65,15 @@ void VisitOperator(Operator& op, Visitor& visitor) {
         case OperatorType::TopN:
             visitor.Visit(static_cast<TopNOperator&>(op));
             return;
+        case OperatorType::Sort:
+            visitor.Visit(static_cast<SortOperator&>(op));
+            return;
+        case OperatorType::Limit:
+            visitor.Visit(static_cast<LimitOperator&>(op));
+            return;
+        case OperatorType::HashJoin:
+            visitor.Visit(static_cast<HashJoinOperator&>(op));
+            return;
     }
     THROW_RUNTIME_ERROR("Unsupported operator type " + std::to_string(static_cast<int>(op.type)));
 }
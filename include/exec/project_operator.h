@@ -7,6 +7,9 @@
 #include <vector>
 
 namespace columnar::exec {
+core::Schema MakeProjectionSchema(const std::vector<ProjectionUnit>& projections,
+                                  const core::Schema& input_schema);
+
 class ProjectSink final : public IOperator {
 public:
     ProjectSink(IOperator& downstream, std::vector<ProjectionUnit> projections);
@@ -17,9 +20,12 @@ public:
         downstream_.Finalize();
     }
 
+    bool Done() const override {
+        return downstream_.Done();
+    }
+
 private:
     IOperator& downstream_;
     std::vector<ProjectionUnit> projections_;
-    bool needs_dense_;
 };
 }  // namespace columnar::exec
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <core/column.h>
+
+#include <absl/container/flat_hash_set.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace columnar::exec {
+// The distinct keys of a join build side, checked by the probe scan to skip row groups and drop
+// rows that cannot find a match before they reach the join. Up to kMaxExactKeys keys are kept as
+// an exact set, more as a blocked Bloom filter. The key range is kept in both cases
+class RuntimeFilter {
+public:
+    static constexpr size_t kMaxExactKeys = 1024;
+
+    // keys holds every distinct key of the build side once, NULL keys excluded
+    explicit RuntimeFilter(const core::Column& keys);
+
+    bool IsString() const {
+        return is_string_;
+    }
+
+    bool IsEmpty() const {
+        return keys_count_ == 0;
+    }
+
+    bool MayContain(int64_t key) const;
+    bool MayContain(std::string_view key) const;
+
+    // Whether some key in [min, max] may be in the filter
+    bool MayOverlap(int64_t min, int64_t max) const;
+    bool MayOverlap(std::string_view min, std::string_view max) const;
+
+private:
+    void AddToBloom(uint64_t hash);
+    bool BloomMayContain(uint64_t hash) const;
+
+    bool is_string_;
+    size_t keys_count_ = 0;
+    bool exact_;
+    int64_t min_int_ = 0;
+    int64_t max_int_ = 0;
+    std::string min_string_;
+    std::string max_string_;
+    absl::flat_hash_set<int64_t> ints_;
+    absl::flat_hash_set<std::string> strings_;
+    // Every key sets a few bits of one word, both chosen by its hash
+    std::vector<uint64_t> bloom_;
+};
+}  // namespace columnar::exec
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <core/batch.h>
+#include <core/row_selection.h>
+
 #include <cstddef>
 #include <cstdint>
 #include <vector>
@@ -17,4 +20,27 @@ void ForSelectedRows(const std::vector<uint32_t>* selection, size_t rows, F&& f)
         }
     }
 }
+
+// Visits the selected rows of batch in the form its selection is kept in
+template <typename F>
+void ForSelectedRows(const core::Batch& batch, F&& f) {
+    if (batch.HasSelection()) {
+        batch.GetRowSelection().ForEach(f);
+        return;
+    }
+    size_t rows = batch.RowsCount();
+    for (size_t row = 0; row < rows; ++row) {
+        f(row);
+    }
+}
+
+// The selection to evaluate kernels over. Kernels may compute the rows outside it, so over a
+// dense selection they run over every row instead of reading the row indexes
+inline const std::vector<uint32_t>* KernelSelection(const core::Batch& batch) {
+    if (!batch.HasSelection() ||
+        batch.SelectedRowsCount() * core::RowSelection::kDenseFraction >= batch.RowsCount()) {
+        return nullptr;
+    }
+    return &batch.Selection();
+}
 }  // namespace columnar::exec
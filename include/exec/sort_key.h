@@ -0,0 +1,64 @@
+#pragma once
+
+#include <core/column.h>
+#include <exec/operator.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace columnar::exec {
+// Sort keys of rows encoded into byte strings whose memcmp order is the order of the sort units.
+// Every key part starts with a byte that puts NULL first, integers are stored big-endian with the
+// sign bit flipped, doubles by their order-preserving bit pattern with NaN last and strings with
+// 0x00 escaped as 0x00 0xFF and terminated by 0x00 0x00. The bytes of a descending key part are
+// inverted
+class NormalizedKeys {
+public:
+    NormalizedKeys() : offsets_{0} {
+    }
+
+    // Appends the keys of the first rows rows of key_cols, one column per sort unit
+    void Append(const std::vector<SortUnit>& sort_units,
+                const std::vector<const core::Column*>& key_cols, size_t rows);
+
+    // Appends the keys of the rows in selection, or of the first rows rows if it is null
+    void Append(const std::vector<SortUnit>& sort_units,
+                const std::vector<const core::Column*>& key_cols,
+                const std::vector<uint32_t>* selection, size_t rows);
+
+    // Appends a key taken from another NormalizedKeys
+    void AppendKey(std::string_view key);
+
+    size_t Size() const noexcept {
+        return offsets_.size() - 1;
+    }
+
+    std::string_view Key(size_t i) const noexcept {
+        return {reinterpret_cast<const char*>(bytes_.data()) + offsets_[i],
+                offsets_[i + 1] - offsets_[i]};
+    }
+
+    // The first 8 bytes of a key as a big-endian integer, zero padded. Keys with different
+    // prefixes compare as their prefixes do
+    uint64_t Prefix(size_t i) const noexcept;
+
+    // The indexes of the keys in key order, equal keys in index order. Keys are sorted by their
+    // prefixes and compared in full only when the prefixes are equal
+    std::vector<uint32_t> SortedOrder() const;
+
+    void Clear() noexcept {
+        bytes_.clear();
+        offsets_.assign(1, 0);
+    }
+
+private:
+    std::vector<uint8_t> bytes_;
+    std::vector<size_t> offsets_;
+};
+
+// Three-way comparison of key i of a and key j of b, by their prefixes first
+int CompareNormalizedKeys(const NormalizedKeys& a, size_t i, const NormalizedKeys& b,
+                          size_t j) noexcept;
+}  // namespace columnar::exec
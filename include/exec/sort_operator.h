@@ -0,0 +1,52 @@
+#pragma once
+
+#include <core/batch.h>
+#include <core/schema.h>
+#include <exec/operator.h>
+#include <exec/spill_file.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace columnar::exec {
+// Sorts all of its input. Ties keep their input order. Input that exceeds the memory budget is
+// sorted in runs that are spilled to disk and merged with a loser tree. Rows are compared by
+// their normalized sort keys
+class SortSink final : public IOperator {
+public:
+    SortSink(IOperator& downstream, std::vector<SortUnit> sort_units, SortOptions options = {});
+
+    SortSink(const SortSink&) = delete;
+    SortSink& operator=(const SortSink&) = delete;
+    SortSink(SortSink&&) = delete;
+    SortSink& operator=(SortSink&&) = delete;
+
+    void Consume(core::Batch batch) override;
+
+    void Finalize() override;
+
+private:
+    struct RowRef {
+        uint32_t batch_idx;
+        uint32_t row_idx;
+    };
+
+    // Sorts the buffered rows and calls emit(batch, row, normalized key) for each of them in order
+    template <typename Emit>
+    void SortBuffer(Emit&& emit);
+
+    void SpillRun();
+    void MergeRuns();
+
+    IOperator& downstream_;
+    std::vector<SortUnit> sort_units_;
+    SortOptions options_;
+    bool has_schema_ = false;
+    core::Schema schema_;
+    std::vector<core::Batch> buffer_;
+    size_t buffered_bytes_ = 0;
+    std::vector<std::unique_ptr<SpillFile>> runs_;
+};
+}  // namespace columnar::exec
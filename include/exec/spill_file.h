@@ -0,0 +1,55 @@
+#pragma once
+
+#include <core/column.h>
+#include <util/byte_buffer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace columnar::exec {
+inline constexpr size_t kSpillFileBufSize = 1024 * 1024;
+
+// A temporary file of length-prefixed binary records that is written once and then read back in
+// order. The file is removed when the object is destroyed
+class SpillFile {
+public:
+    // An empty directory means the system temporary directory
+    explicit SpillFile(const std::string& directory);
+
+    ~SpillFile();
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+    SpillFile(SpillFile&&) = delete;
+    SpillFile& operator=(SpillFile&&) = delete;
+
+    void Append(const std::vector<uint8_t>& record);
+
+    // Switches from writing to reading, starting from the first record
+    void Rewind();
+
+    // Reads the next record, returns false after the last one
+    bool Next(std::vector<uint8_t>& record);
+
+    size_t RecordsCount() const noexcept {
+        return records_;
+    }
+
+private:
+    std::string path_;
+    std::vector<char> buf_;
+    std::filebuf file_;
+    size_t records_ = 0;
+    size_t records_read_ = 0;
+};
+
+// Writes row of col as a null flag followed by an int64, a double or a length-prefixed string,
+// depending on the column type
+void EncodeValue(const core::Column& col, size_t row, util::BufWriter& w);
+
+// Appends a value written by EncodeValue to out, which must have the type of the encoded column
+void DecodeValue(util::BufReader& r, core::Column& out);
+}  // namespace columnar::exec
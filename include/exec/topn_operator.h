@@ -1,14 +1,32 @@
 #pragma once
 
 #include <core/batch.h>
+#include <core/column.h>
+#include <core/datatype.h>
 #include <exec/operator.h>
+#include <exec/sort_key.h>
 
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
 namespace columnar::exec {
+// The first sort key of the row a full TopN would evict next. Once active, rows whose first key
+// sorts strictly after it cannot reach the result
+struct TopNThreshold {
+    bool active = false;
+    bool ascending = true;
+    bool is_null = false;
+    core::DataType type = core::DataType::Int64;
+    int64_t int_value = 0;
+    double double_value = 0;
+    std::string string_value;
+};
+
 class TopNSink final : public IOperator {
 public:
     TopNSink(IOperator& downstream, std::vector<SortUnit> sort_units, std::optional<size_t> limit,
@@ -18,12 +36,36 @@ public:
 
     void Finalize() override;
 
+    const TopNThreshold& Threshold() const noexcept {
+        return threshold_;
+    }
+
 private:
+    // With a limit only the best offset + limit rows are kept, in rows_ with their normalized
+    // sort keys in keys_ and their first sort key in first_keys_. heap_ holds the indexes of the
+    // kept rows with the worst one on top, rows evicted from it stay in rows_ until the next
+    // compaction
+    void ConsumeBounded(core::Batch batch);
+    void FinalizeBounded();
+    void CompactRows();
+    void UpdateThreshold();
+
+    void FinalizeBuffered();
+
     IOperator& downstream_;
     std::vector<SortUnit> sort_units_;
     std::optional<size_t> limit_;
     std::optional<size_t> offset_;
-    bool needs_dense_;
     std::vector<core::Batch> buffer_;
+
+    size_t capacity_ = 0;
+    bool has_rows_ = false;
+    core::Batch rows_;
+    NormalizedKeys keys_;
+    std::unique_ptr<core::Column> first_keys_;
+    std::vector<uint64_t> sequence_;
+    std::vector<uint32_t> heap_;
+    uint64_t rows_seen_ = 0;
+    TopNThreshold threshold_;
 };
 }  // namespace columnar::exec
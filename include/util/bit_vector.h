@@ -17,8 +17,6 @@ public:
         bits_.resize((size + 63) / 64, 0);
     }
 
-    ~BitVector() = default;
-
     void Set(size_t i) {
         bits_[i / 64] |= static_cast<uint64_t>(1) << (i % 64);
     }
@@ -54,6 +52,15 @@ public:
         ++size_;
     }
 
+    // Grows the vector with n zero bits
+    void AppendZeros(size_t n) {
+        if (size_ % 64 != 0) {
+            bits_.back() &= (static_cast<uint64_t>(1) << (size_ % 64)) - 1;
+        }
+        size_ += n;
+        bits_.resize((size_ + 63) / 64, 0);
+    }
+
     void Clear() {
         bits_.clear();
         size_ = 0;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <string_view>
@@ -17,9 +18,16 @@ struct Time {
     int second;
 };
 
+inline constexpr size_t kDateChars = 10;
+inline constexpr size_t kTimestampChars = 19;
+
 int32_t ParseDate(std::string_view s);
+// Writes exactly kDateChars bytes
+size_t FormatDate(int32_t days, char* out);
 void AppendDate(int32_t days, std::string& out);
 
 int64_t ParseTimestamp(std::string_view s);
+// Writes exactly kTimestampChars bytes
+size_t FormatTimestamp(int64_t seconds, char* out);
 void AppendTimestamp(int64_t seconds, std::string& out);
 }  // namespace columnar::util
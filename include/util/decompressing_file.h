@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+
+namespace columnar::util {
+inline constexpr size_t kDefaultDecompressBlockSize = 4 * 1024 * 1024;
+inline constexpr size_t kDefaultDecompressBlocks = 4;
+
+enum class InputCodec : uint8_t {
+    None = 0,
+    Gzip = 1,
+    Zstd = 2,
+    Lz4 = 3,
+};
+
+// Recognizes gzip, zstd and lz4 frame magic numbers, anything else is plain input
+InputCodec DetectInputCodec(const char* data, size_t n);
+
+bool IsInputCodecSupported(InputCodec codec);
+
+// Reads a file that may be compressed. A background thread reads and decompresses it into a ring
+// of blocks that the stream consumes, so decompression overlaps with parsing. Decompression errors
+// are rethrown from the reading call
+class DecompressingInputFile : public std::istream {
+public:
+    explicit DecompressingInputFile(const std::string& path,
+                                    size_t block_size = kDefaultDecompressBlockSize,
+                                    size_t blocks = kDefaultDecompressBlocks);
+
+    ~DecompressingInputFile() override;
+
+    InputCodec Codec() const;
+
+private:
+    class Buffer;
+
+    std::unique_ptr<Buffer> buffer_;
+};
+}  // namespace columnar::util
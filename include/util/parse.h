@@ -2,6 +2,7 @@
 
 #include <util/macro.h>
 
+#include <bit>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -11,6 +12,7 @@
 #include <cctype>
 #include <cerrno>
 #include <cstdlib>
+#include <cstring>
 
 namespace columnar::util {
 inline bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) {
@@ -26,6 +28,75 @@ inline bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) {
     return true;
 }
 
+inline constexpr bool kSwarParsing = std::endian::native == std::endian::little;
+
+// The 8 bytes at p in memory order, first byte in the lowest bits on little-endian targets
+inline uint64_t LoadEightBytes(const char* p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+// Checks that every byte selected by byte_mask (0xFF per byte) is an ASCII digit
+inline bool AreDigits(uint64_t word, uint64_t byte_mask = ~uint64_t{0}) {
+    constexpr uint64_t kHigh = 0xF0F0F0F0F0F0F0F0ULL;
+    uint64_t high = word & kHigh;
+    uint64_t carry = (word + 0x0606060606060606ULL) & kHigh;
+    return ((high | (carry >> 4)) & byte_mask) == (0x3333333333333333ULL & byte_mask);
+}
+
+// Eight validated ASCII digits, the first one being the most significant
+inline uint32_t ParseEightDigits(uint64_t word) {
+    word -= 0x3030303030303030ULL;
+    word = word * 10 + (word >> 8);
+    word = (((word & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+            (((word >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >>
+           32;
+    return static_cast<uint32_t>(word);
+}
+
+// Same grammar as std::from_chars for base 10 (optional '-', then digits), parsed eight digits at a
+// time. Returns false on malformed input or int64 overflow
+inline bool ParseDecimalInt64(std::string_view s, int64_t& out) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    bool negative = p != end && *p == '-';
+    p += negative ? 1 : 0;
+    size_t digits = static_cast<size_t>(end - p);
+    if (digits == 0) {
+        return false;
+    }
+    if (digits > 19) {
+        auto [ptr, ec] = std::from_chars(s.data(), end, out, 10);
+        return ec == std::errc{} && ptr == end;
+    }
+
+    uint64_t value = 0;
+    if constexpr (kSwarParsing) {
+        for (; end - p >= 8; p += 8) {
+            uint64_t word = LoadEightBytes(p);
+            if (!AreDigits(word)) {
+                return false;
+            }
+            value = value * 100000000 + ParseEightDigits(word);
+        }
+    }
+    for (; p != end; ++p) {
+        auto digit = static_cast<unsigned>(*p - '0');
+        if (digit > 9) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+
+    constexpr auto kMax = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    if (value > kMax + (negative ? 1 : 0)) {
+        return false;
+    }
+    out = negative ? static_cast<int64_t>(0 - value) : static_cast<int64_t>(value);
+    return true;
+}
+
 template <typename T>
 T ParseFromString(std::string_view s) {
     if constexpr (std::is_same_v<T, std::string>) {
@@ -47,8 +118,7 @@ T ParseFromString(std::string_view s) {
         THROW_RUNTIME_ERROR("Invalid bool value: " + std::string(s));
     } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
         int64_t tmp;
-        auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), tmp, 10);
-        if (ec != std::errc{} || ptr != s.data() + s.size()) {
+        if (!ParseDecimalInt64(s, tmp)) {
             THROW_RUNTIME_ERROR("Invalid integer value: " + std::string(s));
         }
         if (tmp < std::numeric_limits<T>::min() || tmp > std::numeric_limits<T>::max()) {
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace columnar::util {
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> task);
+
+    size_t Size() const noexcept {
+        return workers_.size();
+    }
+
+    // 0 means "all hardware threads".
+    static size_t ResolveThreads(size_t threads) noexcept;
+
+private:
+    void WorkerLoop();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    bool stop_ = false;
+};
+}  // namespace columnar::util
@@ -166,6 +166,178 @@ std::unique_ptr<core::Column> DecodeChar(util::BufReader& r, bool nullable, core
     }
 }
 
+// Positions of the fetched rows that are NULL, the bitmap of all n values is skipped
+util::BitVector FetchNulls(util::BufReader& r, bool nullable, size_t n,
+                           const std::vector<uint32_t>& rows) {
+    if (!nullable) {
+        return {};
+    }
+    size_t packed_size = core::encoding::BitPackedSize(n, 1);
+    const uint8_t* packed = r.Take(packed_size);
+    util::BitVector is_null(rows.size());
+    for (size_t k = 0; k < rows.size(); ++k) {
+        if (core::encoding::BitUnpackAt<uint8_t>(packed, packed_size, rows[k], 1, 0) != 0) {
+            is_null.Set(k);
+        }
+    }
+    return is_null;
+}
+
+template <typename T>
+std::vector<T> FetchPlain(util::BufReader& r, size_t n, const std::vector<uint32_t>& rows) {
+    const uint8_t* data = r.Take(n * sizeof(T));
+    std::vector<T> out(rows.size());
+    for (size_t k = 0; k < rows.size(); ++k) {
+        std::memcpy(&out[k], data + static_cast<size_t>(rows[k]) * sizeof(T), sizeof(T));
+    }
+    return out;
+}
+
+template <typename Column, typename T>
+std::unique_ptr<core::Column> FetchNumeric(util::BufReader& r, bool nullable,
+                                           core::Encoding encoding, size_t n,
+                                           const std::vector<uint32_t>& rows) {
+    auto is_null = FetchNulls(r, nullable, n, rows);
+    std::vector<T> data;
+    switch (encoding) {
+        case core::Encoding::Plain:
+            data = FetchPlain<T>(r, n, rows);
+            break;
+        case core::Encoding::RLE:
+            data = core::encoding::DecodeRLEAt<T>(r, n, rows);
+            break;
+        case core::Encoding::FrameOfReference:
+            if constexpr (std::is_integral_v<T>) {
+                data = core::encoding::DecodeFORAt<T>(r, n, rows);
+                break;
+            } else {
+                THROW_RUNTIME_ERROR("FrameOfReference needs an integer column");
+            }
+        case core::Encoding::Delta:
+            if constexpr (std::is_integral_v<T>) {
+                data = core::encoding::DecodeDeltaAt<T>(r, n, rows);
+                break;
+            } else {
+                THROW_RUNTIME_ERROR("Delta needs an integer column");
+            }
+        case core::Encoding::BitPacking:
+            if constexpr (std::is_integral_v<T>) {
+                uint8_t bit_width = r.Read<uint8_t>();
+                size_t packed_size = core::encoding::BitPackedSize(n, bit_width);
+                const uint8_t* packed = r.Take(packed_size);
+                data.resize(rows.size());
+                for (size_t k = 0; k < rows.size(); ++k) {
+                    data[k] = core::encoding::BitUnpackAt(packed, packed_size, rows[k], bit_width,
+                                                          T(0));
+                }
+                break;
+            } else {
+                THROW_RUNTIME_ERROR("BitPacking needs an integer column");
+            }
+        default:
+            THROW_RUNTIME_ERROR("Encoding does not support numeric column");
+    }
+    return std::make_unique<Column>(std::move(data), std::move(is_null), nullable);
+}
+
+std::unique_ptr<core::Column> FetchBool(util::BufReader& r, bool nullable, core::Encoding encoding,
+                                        size_t n, const std::vector<uint32_t>& rows) {
+    auto is_null = FetchNulls(r, nullable, n, rows);
+    util::BitVector data(rows.size());
+    switch (encoding) {
+        case core::Encoding::Plain:
+        case core::Encoding::BitPacking: {
+            size_t packed_size = core::encoding::BitPackedSize(n, 1);
+            const uint8_t* packed = r.Take(packed_size);
+            for (size_t k = 0; k < rows.size(); ++k) {
+                if (core::encoding::BitUnpackAt<uint8_t>(packed, packed_size, rows[k], 1, 0) != 0) {
+                    data.Set(k);
+                }
+            }
+            break;
+        }
+        case core::Encoding::RLE: {
+            auto values = core::encoding::DecodeRLEAt<uint8_t>(r, n, rows);
+            for (size_t k = 0; k < rows.size(); ++k) {
+                if (values[k] != 0) {
+                    data.Set(k);
+                }
+            }
+            break;
+        }
+        default:
+            THROW_RUNTIME_ERROR("Encoding does not support bool column");
+    }
+    return std::make_unique<core::BoolColumn>(std::move(data), std::move(is_null), nullable,
+                                              rows.size());
+}
+
+template <typename Offset>
+std::unique_ptr<core::Column> FetchPlainStrings(util::BufReader& r, bool nullable, size_t n,
+                                                const std::vector<uint32_t>& rows,
+                                                util::BitVector is_null) {
+    const uint8_t* raw_offsets = r.Take((n + 1) * sizeof(Offset));
+    auto offset_at = [&](size_t i) {
+        Offset offset;
+        std::memcpy(&offset, raw_offsets + i * sizeof(Offset), sizeof(Offset));
+        return static_cast<size_t>(offset);
+    };
+    const uint8_t* chars = r.Take(offset_at(n));
+    std::vector<char> data;
+    std::vector<size_t> offsets;
+    offsets.reserve(rows.size() + 1);
+    offsets.push_back(0);
+    for (uint32_t row : rows) {
+        size_t begin = offset_at(row);
+        size_t end = offset_at(row + 1);
+        data.insert(data.end(), chars + begin, chars + end);
+        offsets.push_back(data.size());
+    }
+    return std::make_unique<core::StringColumn>(std::move(data), std::move(offsets),
+                                                std::move(is_null), nullable);
+}
+
+std::unique_ptr<core::Column> FetchString(util::BufReader& r, bool nullable,
+                                          core::Encoding encoding, size_t n,
+                                          const std::vector<uint32_t>& rows) {
+    auto is_null = FetchNulls(r, nullable, n, rows);
+    switch (encoding) {
+        case core::Encoding::Plain: {
+            auto width = r.Read<uint8_t>();
+            if (width == 4) {
+                return FetchPlainStrings<uint32_t>(r, nullable, n, rows, std::move(is_null));
+            }
+            if (width == 8) {
+                return FetchPlainStrings<uint64_t>(r, nullable, n, rows, std::move(is_null));
+            }
+            THROW_RUNTIME_ERROR("Unsupported string offset width");
+        }
+        case core::Encoding::Dictionary: {
+            auto decoded = core::encoding::DecodeStringDictionaryAt(r, n, rows);
+            return std::make_unique<core::DictionaryStringColumn>(
+                std::move(decoded.dict_data), std::move(decoded.dict_offsets),
+                std::move(decoded.ids), std::move(is_null), nullable);
+        }
+        default:
+            THROW_RUNTIME_ERROR("Encoding does not support string column");
+    }
+}
+
+std::unique_ptr<core::Column> FetchChar(util::BufReader& r, bool nullable, core::Encoding encoding,
+                                        size_t n, const std::vector<uint32_t>& rows) {
+    auto is_null = FetchNulls(r, nullable, n, rows);
+    switch (encoding) {
+        case core::Encoding::Plain:
+            return std::make_unique<core::CharColumn>(FetchPlain<char>(r, n, rows),
+                                                      std::move(is_null), nullable);
+        case core::Encoding::RLE:
+            return std::make_unique<core::CharColumn>(core::encoding::DecodeRLEAt<char>(r, n, rows),
+                                                      std::move(is_null), nullable);
+        default:
+            THROW_RUNTIME_ERROR("Encoding does not support char column");
+    }
+}
+
 void CheckMappedRange(uint64_t offset, uint64_t size, size_t mapped_size) {
     if (offset > std::numeric_limits<size_t>::max() || size > std::numeric_limits<size_t>::max()) {
         THROW_RUNTIME_ERROR("Mapped chunk range is too large");
@@ -188,40 +360,100 @@ core::Batch BruhBatchReader::ReadRowGroup(size_t i) {
 }
 
 core::Batch BruhBatchReader::ReadRowGroup(size_t i, const std::vector<size_t>& column_indexes) {
+    CheckRowGroupIndex(i);
+    core::Batch batch(ProjectSchema(column_indexes), metadata_.row_groups[i].rows_count);
+    auto& columns = batch.GetColumns();
+    for (size_t out_col = 0; out_col < column_indexes.size(); ++out_col) {
+        ReadChunk(i, column_indexes[out_col], columns[out_col]);
+    }
+    return batch;
+}
+
+core::Batch BruhBatchReader::FetchRows(size_t i, const std::vector<size_t>& column_indexes,
+                                       const std::vector<uint32_t>& rows) {
+    core::Batch batch(ProjectSchema(column_indexes));
+    auto& columns = batch.GetColumns();
+    for (size_t out_col = 0; out_col < column_indexes.size(); ++out_col) {
+        columns[out_col] = FetchRows(i, column_indexes[out_col], rows);
+    }
+    return batch;
+}
+
+std::unique_ptr<core::Column> BruhBatchReader::FetchRows(size_t row_group, size_t column,
+                                                         const std::vector<uint32_t>& rows) {
+    CheckRowGroupIndex(row_group);
+    auto rows_count = metadata_.row_groups[row_group].rows_count;
+    for (size_t k = 0; k < rows.size(); ++k) {
+        if (rows[k] >= rows_count || (k > 0 && rows[k] <= rows[k - 1])) {
+            THROW_RUNTIME_ERROR("Fetched rows must be ascending and less than " +
+                                std::to_string(rows_count));
+        }
+    }
+    auto r = ChunkReader(row_group, column);
+    auto& field = metadata_.schema.GetFields()[column];
+    auto& chunk = metadata_.row_groups[row_group].columns[column];
+    size_t n = chunk.values_count;
+    switch (field.type) {
+        case core::DataType::Int16:
+            return FetchNumeric<core::Int16Column, int16_t>(r, field.nullable, chunk.encoding, n,
+                                                            rows);
+        case core::DataType::Int32:
+            return FetchNumeric<core::Int32Column, int32_t>(r, field.nullable, chunk.encoding, n,
+                                                            rows);
+        case core::DataType::Int64:
+            return FetchNumeric<core::Int64Column, int64_t>(r, field.nullable, chunk.encoding, n,
+                                                            rows);
+        case core::DataType::Double:
+            return FetchNumeric<core::DoubleColumn, double>(r, field.nullable, chunk.encoding, n,
+                                                            rows);
+        case core::DataType::Date:
+            return FetchNumeric<core::DateColumn, int32_t>(r, field.nullable, chunk.encoding, n,
+                                                           rows);
+        case core::DataType::Timestamp:
+            return FetchNumeric<core::TimestampColumn, int64_t>(r, field.nullable, chunk.encoding,
+                                                                n, rows);
+        case core::DataType::Bool:
+            return FetchBool(r, field.nullable, chunk.encoding, n, rows);
+        case core::DataType::String:
+            return FetchString(r, field.nullable, chunk.encoding, n, rows);
+        case core::DataType::Char:
+            return FetchChar(r, field.nullable, chunk.encoding, n, rows);
+    }
+    THROW_RUNTIME_ERROR("Unsupported type");
+}
+
+void BruhBatchReader::CheckRowGroupIndex(size_t i) const {
     if (i >= metadata_.row_groups.size()) {
         THROW_RUNTIME_ERROR("Row group index " + std::to_string(i) + " out of range [0, " +
                             std::to_string(metadata_.row_groups.size()) + ")");
     }
+}
 
-    auto& group = metadata_.row_groups[i];
-    auto& schema = metadata_.schema;
-    core::Batch batch(ProjectSchema(column_indexes), group.rows_count);
-    auto& columns = batch.GetColumns();
+void BruhBatchReader::ReadChunk(size_t row_group, size_t column,
+                                std::unique_ptr<core::Column>& out) {
+    auto r = ChunkReader(row_group, column);
+    ReadColumn(r, out, metadata_.schema.GetFields()[column],
+               metadata_.row_groups[row_group].columns[column]);
+}
 
-    for (size_t out_col = 0; out_col < column_indexes.size(); ++out_col) {
-        size_t col = column_indexes[out_col];
-        if (col >= schema.FieldsCount()) {
-            THROW_RUNTIME_ERROR("Column index " + std::to_string(col) + " out of range [0, " +
-                                std::to_string(schema.FieldsCount()) + ")");
-        }
-        auto& chunk = group.columns[col];
-        uint64_t mapped_size = chunk.compression == util::Compression::None
-                                   ? chunk.uncompressed_size
-                                   : chunk.compressed_size;
-        CheckMappedRange(chunk.offset, mapped_size, data_.size());
-        const uint8_t* chunk_data = data_.data() + static_cast<size_t>(chunk.offset);
-        if (chunk.compression == util::Compression::None) {
-            util::BufReader r(chunk_data, static_cast<size_t>(chunk.uncompressed_size));
-            ReadColumn(r, columns[out_col], schema.GetFields()[col], chunk);
-        } else {
-            encode_buf_.resize(chunk.uncompressed_size);
-            util::Decompress(chunk.compression, chunk_data, chunk.compressed_size,
-                             encode_buf_.data(), chunk.uncompressed_size);
-            util::BufReader r(encode_buf_.data(), encode_buf_.size());
-            ReadColumn(r, columns[out_col], schema.GetFields()[col], chunk);
-        }
+util::BufReader BruhBatchReader::ChunkReader(size_t row_group, size_t column) {
+    auto& schema = metadata_.schema;
+    if (column >= schema.FieldsCount()) {
+        THROW_RUNTIME_ERROR("Column index " + std::to_string(column) + " out of range [0, " +
+                            std::to_string(schema.FieldsCount()) + ")");
     }
-    return batch;
+    auto& chunk = metadata_.row_groups[row_group].columns[column];
+    uint64_t mapped_size = chunk.compression == util::Compression::None ? chunk.uncompressed_size
+                                                                        : chunk.compressed_size;
+    CheckMappedRange(chunk.offset, mapped_size, data_.size());
+    const uint8_t* chunk_data = data_.data() + static_cast<size_t>(chunk.offset);
+    if (chunk.compression == util::Compression::None) {
+        return util::BufReader(chunk_data, static_cast<size_t>(chunk.uncompressed_size));
+    }
+    encode_buf_.resize(chunk.uncompressed_size);
+    util::Decompress(chunk.compression, chunk_data, chunk.compressed_size, encode_buf_.data(),
+                     chunk.uncompressed_size);
+    return util::BufReader(encode_buf_.data(), encode_buf_.size());
 }
 
 std::vector<size_t> BruhBatchReader::ResolveColumnNames(
@@ -14,11 +14,16 @@
 #include <util/macro.h>
 #include <util/stream_helper.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cmath>
+#include <exception>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace columnar::bruh {
@@ -473,25 +478,119 @@ void WriteColumnStatistics(util::BufWriter& w, const ColumnChunkStatistics& stat
 }
 }  // namespace
 
+BruhBatchWriter::BruhBatchWriter(std::ostream& os, const core::Schema& schema,
+                                 BruhWriterOptions options)
+    : os_(os), schema_(schema), options_(std::move(options)) {
+    metadata_.version = kCurrentVersion;
+    metadata_.schema = schema;
+    size_t threads = util::ThreadPool::ResolveThreads(options_.threads);
+    if (threads > 1 && schema_.FieldsCount() > 1) {
+        pool_ = std::make_unique<util::ThreadPool>(threads);
+        size_t window = options_.max_in_flight_chunks;
+        slots_.resize(window != 0 ? window : 2 * threads);
+    } else {
+        slots_.resize(1);
+    }
+    WriteMagic();
+}
+
+BruhBatchWriter::~BruhBatchWriter() = default;
+
 void BruhBatchWriter::Write(const core::Batch& batch) {
     ValidateSchema(schema_, batch.GetSchema());
 
     RowGroupMetaData group;
     group.rows_count = batch.RowsCount();
     group.byte_size = 0;
+    group.columns.reserve(batch.ColumnsCount());
+    if (pool_ != nullptr) {
+        WriteParallel(batch, group);
+    } else {
+        WriteSerial(batch, group);
+    }
     metadata_.rows_count += batch.RowsCount();
+    metadata_.row_groups.push_back(std::move(group));
+}
+
+void BruhBatchWriter::WriteSerial(const core::Batch& batch, RowGroupMetaData& group) {
+    auto& slot = slots_.front();
     for (size_t col = 0; col < batch.ColumnsCount(); ++col) {
-        ColumnChunkMetaData chunk;
-        chunk.values_count = batch.RowsCount();
-        WriteColumn(chunk, batch.ColumnAt(col), schema_.GetFields()[col], col);
-        group.byte_size += chunk.compressed_size;
-        group.columns.push_back(chunk);
+        slot.chunk = ColumnChunkMetaData{};
+        slot.chunk.values_count = batch.RowsCount();
+        EncodeChunk(slot, batch.ColumnAt(col), schema_.GetFields()[col], col);
+        WriteChunk(slot, group);
     }
-    metadata_.row_groups.push_back(std::move(group));
 }
 
-void BruhBatchWriter::WriteColumn(ColumnChunkMetaData& chunk, const core::Column& col,
-                                  const core::Field& field, size_t col_index) {
+void BruhBatchWriter::WriteParallel(const core::Batch& batch, RowGroupMetaData& group) {
+    size_t columns = batch.ColumnsCount();
+    size_t window = slots_.size();
+    auto submit = [&](size_t col) {
+        auto& slot = slots_[col % window];
+        slot.chunk = ColumnChunkMetaData{};
+        slot.chunk.values_count = batch.RowsCount();
+        slot.ready = false;
+        slot.error = nullptr;
+        pool_->Submit([this, &slot, &batch, col] {
+            std::exception_ptr error;
+            try {
+                EncodeChunk(slot, batch.ColumnAt(col), schema_.GetFields()[col], col);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            {
+                std::lock_guard lock(slots_mutex_);
+                slot.error = error;
+                slot.ready = true;
+            }
+            slots_cv_.notify_all();
+        });
+    };
+
+    size_t submitted = 0;
+    std::exception_ptr error;
+    try {
+        while (submitted < std::min(columns, window)) {
+            submit(submitted);
+            ++submitted;
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // Chunks are written strictly in column order; a slot is reused only after its chunk has hit
+    // the stream, which bounds the number of encoded chunks held in memory by the window size.
+    for (size_t col = 0; col < submitted; ++col) {
+        auto& slot = slots_[col % window];
+        {
+            std::unique_lock lock(slots_mutex_);
+            slots_cv_.wait(lock, [&slot] { return slot.ready; });
+        }
+        if (error == nullptr) {
+            error = slot.error;
+        }
+        if (error != nullptr) {
+            continue;
+        }
+        // The tasks already submitted hold references to the batch and the slots, so a failed
+        // write still waits for all of them before the error leaves this function
+        try {
+            WriteChunk(slot, group);
+            if (submitted < columns) {
+                submit(submitted);
+                ++submitted;
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+}
+
+void BruhBatchWriter::EncodeChunk(EncodedChunk& slot, const core::Column& col,
+                                  const core::Field& field, size_t col_index) const {
+    auto& chunk = slot.chunk;
     core::Encoding encoding = options_.encoding;
     if (auto it = options_.column_encoding.find(col_index); it != options_.column_encoding.end()) {
         encoding = it->second;
@@ -510,28 +609,34 @@ void BruhBatchWriter::WriteColumn(ColumnChunkMetaData& chunk, const core::Column
         compression = it->second;
     }
 
-    encode_buf_.clear();
-    util::BufWriter encode_writer(encode_buf_);
-    EncodeColumn(encode_writer, col, field, encoding, auto_encoding, packed_buf_);
+    slot.encode_buf.clear();
+    util::BufWriter encode_writer(slot.encode_buf);
+    EncodeColumn(encode_writer, col, field, encoding, auto_encoding, slot.packed_buf);
 
-    const uint8_t* out = encode_buf_.data();
-    size_t out_size = encode_buf_.size();
+    size_t out_size = slot.encode_buf.size();
     chunk.compression = util::Compression::None;
     if (compression != util::Compression::None) {
-        compress_buf_.clear();
-        util::Compress(compression, encode_buf_.data(), encode_buf_.size(), compress_buf_);
-        if (compress_buf_.size() < encode_buf_.size()) {
-            out = compress_buf_.data();
-            out_size = compress_buf_.size();
+        slot.compress_buf.clear();
+        util::Compress(compression, slot.encode_buf.data(), slot.encode_buf.size(),
+                       slot.compress_buf);
+        if (slot.compress_buf.size() < slot.encode_buf.size()) {
+            out_size = slot.compress_buf.size();
             chunk.compression = compression;
         }
     }
 
     chunk.encoding = encoding;
-    chunk.uncompressed_size = encode_buf_.size();
-    chunk.offset = static_cast<uint64_t>(os_.tellp());
+    chunk.uncompressed_size = slot.encode_buf.size();
     chunk.compressed_size = out_size;
-    util::WriteRaw(os_, out, out_size);
+}
+
+void BruhBatchWriter::WriteChunk(EncodedChunk& slot, RowGroupMetaData& group) {
+    const auto& out =
+        slot.chunk.compression == util::Compression::None ? slot.encode_buf : slot.compress_buf;
+    slot.chunk.offset = static_cast<uint64_t>(os_.tellp());
+    util::WriteRaw(os_, out.data(), out.size());
+    group.byte_size += slot.chunk.compressed_size;
+    group.columns.push_back(slot.chunk);
 }
 
 void BruhBatchWriter::Flush() {
@@ -1,6 +1,7 @@
 #include <core/encoding/dictionary.h>
 #include <util/macro.h>
 
+#include <cstring>
 #include <limits>
 #include <string_view>
 #include <unordered_map>
@@ -90,7 +91,9 @@ void EncodeStringDictionary(util::BufWriter& w, const std::vector<std::string_vi
     WritePayload(w, dict_values, indexes);
 }
 
-DecodedStringDictionary DecodeStringDictionary(util::BufReader& r, size_t n) {
+namespace {
+// Reads the dictionary values into out and returns their count
+uint32_t ReadDictionary(util::BufReader& r, DecodedStringDictionary& out) {
     auto dict_count = r.Read<uint32_t>();
     if (dict_count > kMaxDictSize) {
         THROW_RUNTIME_ERROR("Too many dictionary values");
@@ -121,13 +124,31 @@ DecodedStringDictionary DecodeStringDictionary(util::BufReader& r, size_t n) {
         }
     }
 
-    auto dict_chars = r.ReadArray<char>(dict_offsets.back());
+    out.dict_data = r.ReadArray<char>(dict_offsets.back());
+    out.dict_offsets = std::move(dict_offsets);
+    return dict_count;
+}
 
+uint8_t ReadIndexWidth(util::BufReader& r) {
     auto index_width = r.Read<uint8_t>();
     if (index_width != 1 && index_width != 2) {
         THROW_RUNTIME_ERROR("Unsupported dictionary index width");
     }
+    return index_width;
+}
+
+void CheckIndex(uint32_t idx, uint32_t dict_count) {
+    if (idx >= dict_count) {
+        THROW_RUNTIME_ERROR("Dictionary index " + std::to_string(idx) + " out of range [0, " +
+                            std::to_string(dict_count) + ")");
+    }
+}
+}  // namespace
 
+DecodedStringDictionary DecodeStringDictionary(util::BufReader& r, size_t n) {
+    DecodedStringDictionary out;
+    auto dict_count = ReadDictionary(r, out);
+    auto index_width = ReadIndexWidth(r);
     std::vector<uint32_t> indexes(n);
     if (index_width == 1) {
         auto raw = r.ReadArray<uint8_t>(n);
@@ -142,16 +163,25 @@ DecodedStringDictionary DecodeStringDictionary(util::BufReader& r, size_t n) {
     }
 
     for (auto idx : indexes) {
-        if (idx >= dict_count) {
-            THROW_RUNTIME_ERROR("Dictionary index " + std::to_string(idx) + " out of range [0, " +
-                                std::to_string(dict_count) + ")");
-        }
+        CheckIndex(idx, dict_count);
     }
+    out.ids = std::move(indexes);
+    return out;
+}
 
+DecodedStringDictionary DecodeStringDictionaryAt(util::BufReader& r, size_t n,
+                                                 const std::vector<uint32_t>& rows) {
     DecodedStringDictionary out;
-    out.dict_data = std::move(dict_chars);
-    out.dict_offsets = std::move(dict_offsets);
-    out.ids = std::move(indexes);
+    auto dict_count = ReadDictionary(r, out);
+    auto index_width = ReadIndexWidth(r);
+    const uint8_t* raw = r.Take(n * index_width);
+    out.ids.resize(rows.size());
+    for (size_t k = 0; k < rows.size(); ++k) {
+        uint16_t idx = 0;
+        std::memcpy(&idx, raw + static_cast<size_t>(rows[k]) * index_width, index_width);
+        CheckIndex(idx, dict_count);
+        out.ids[k] = idx;
+    }
     return out;
 }
 }  // namespace columnar::core::encoding
@@ -0,0 +1,150 @@
+#include <csv/csv_batch_builder.h>
+#include <core/columns/bool_column.h>
+#include <core/columns/char_column.h>
+#include <core/columns/numeric_column.h>
+#include <core/columns/string_column.h>
+#include <util/date_time.h>
+#include <util/macro.h>
+#include <util/parse.h>
+
+#include <cstdint>
+#include <string>
+
+namespace columnar::csv {
+namespace {
+bool IsNullField(const FieldView& field, bool nullable) {
+    return nullable && field.empty() && !field.was_quoted;
+}
+
+template <typename ColumnT, auto Parse>
+class NumericAppender final : public ColumnAppender {
+public:
+    void Append(const std::vector<FieldView>& fields, core::Column& col) const override {
+        auto& typed = static_cast<ColumnT&>(col);
+        bool nullable = typed.IsNullable();
+        size_t base = typed.Size();
+        auto* out = typed.AppendZeros(fields.size());
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (IsNullField(fields[i], nullable)) {
+                typed.SetNull(base + i);
+            } else {
+                out[i] = Parse(fields[i].value);
+            }
+        }
+    }
+};
+
+class BoolAppender final : public ColumnAppender {
+public:
+    void Append(const std::vector<FieldView>& fields, core::Column& col) const override {
+        auto& typed = static_cast<core::BoolColumn&>(col);
+        bool nullable = typed.IsNullable();
+        for (const auto& field : fields) {
+            if (IsNullField(field, nullable)) {
+                typed.AppendNull();
+            } else {
+                typed.Append(util::ParseFromString<bool>(field.value));
+            }
+        }
+    }
+};
+
+class CharAppender final : public ColumnAppender {
+public:
+    void Append(const std::vector<FieldView>& fields, core::Column& col) const override {
+        auto& typed = static_cast<core::CharColumn&>(col);
+        bool nullable = typed.IsNullable();
+        for (const auto& field : fields) {
+            if (IsNullField(field, nullable)) {
+                typed.AppendNull();
+            } else if (field.value.size() != 1) {
+                THROW_RUNTIME_ERROR("Char value must have length 1");
+            } else {
+                typed.Append(field.value[0]);
+            }
+        }
+    }
+};
+
+class StringAppender final : public ColumnAppender {
+public:
+    void Append(const std::vector<FieldView>& fields, core::Column& col) const override {
+        auto& typed = static_cast<core::StringColumn&>(col);
+        bool nullable = typed.IsNullable();
+        for (const auto& field : fields) {
+            if (IsNullField(field, nullable)) {
+                typed.AppendNull();
+            } else {
+                typed.Append(field.value);
+            }
+        }
+    }
+};
+}  // namespace
+
+const ColumnAppender& GetColumnAppender(core::DataType type) {
+    static const NumericAppender<core::Int16Column, util::ParseFromString<int16_t>> kInt16;
+    static const NumericAppender<core::Int32Column, util::ParseFromString<int32_t>> kInt32;
+    static const NumericAppender<core::Int64Column, util::ParseFromString<int64_t>> kInt64;
+    static const NumericAppender<core::DoubleColumn, util::ParseFromString<double>> kDouble;
+    static const NumericAppender<core::Int32Column, util::ParseDate> kDate;
+    static const NumericAppender<core::Int64Column, util::ParseTimestamp> kTimestamp;
+    static const BoolAppender kBool;
+    static const CharAppender kChar;
+    static const StringAppender kString;
+    switch (type) {
+        case core::DataType::Int16:
+            return kInt16;
+        case core::DataType::Int32:
+            return kInt32;
+        case core::DataType::Int64:
+            return kInt64;
+        case core::DataType::Double:
+            return kDouble;
+        case core::DataType::Bool:
+            return kBool;
+        case core::DataType::String:
+            return kString;
+        case core::DataType::Date:
+            return kDate;
+        case core::DataType::Timestamp:
+            return kTimestamp;
+        case core::DataType::Char:
+            return kChar;
+    }
+    THROW_RUNTIME_ERROR("Unsupported DataType " + std::to_string(static_cast<int>(type)));
+}
+
+CSVBatchBuilder::CSVBatchBuilder(const core::Schema& schema) {
+    appenders_.reserve(schema.FieldsCount());
+    for (const auto& field : schema.GetFields()) {
+        appenders_.push_back(&GetColumnAppender(field.type));
+    }
+    columns_.resize(appenders_.size());
+}
+
+void CSVBatchBuilder::AddRow(const RowView& row, bool copy) {
+    if (row.size() != columns_.size()) {
+        THROW_RUNTIME_ERROR("Row has incorrect number of fields: expected " +
+                            std::to_string(columns_.size()) + ", got " +
+                            std::to_string(row.size()));
+    }
+    for (size_t i = 0; i < row.size(); ++i) {
+        FieldView field = row[i];
+        if (copy) {
+            field.value = arena_.Intern(field.value);
+        }
+        columns_[i].push_back(field);
+    }
+    ++rows_;
+}
+
+void CSVBatchBuilder::Flush(core::Batch& batch) {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        appenders_[i]->Append(columns_[i], batch.ColumnAt(i));
+        columns_[i].clear();
+    }
+    arena_.Reset();
+    rows_ = 0;
+}
+}  // namespace columnar::csv
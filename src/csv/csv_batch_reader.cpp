@@ -6,35 +6,19 @@ std::optional<core::Batch> CSVBatchReader::ReadNext() {
         return std::nullopt;
     }
 
-    auto fields_count = schema_.FieldsCount();
-    core::Batch batch(schema_, options_.batch_rows_size);
-    size_t rows = 0;
-    while (rows < options_.batch_rows_size) {
+    while (builder_.RowsCount() < options_.batch_rows_size) {
         auto* row = row_reader_.ReadRowView();
         if (!row) {
             break;
         }
-        if (row->size() != fields_count) {
-            THROW_RUNTIME_ERROR("Row has incorrect number of fields: expected " +
-                                std::to_string(fields_count) + ", got " +
-                                std::to_string(row->size()));
-        }
-
-        for (size_t i = 0; i < fields_count; ++i) {
-            const auto& field = (*row)[i];
-            auto& col = batch.ColumnAt(i);
-            if (field.empty() && !field.was_quoted && col.IsNullable()) {
-                col.AppendNull();
-            } else {
-                col.AppendFromString(field.value);
-            }
-        }
-        ++rows;
+        builder_.AddRow(*row, true);
     }
 
-    if (rows == 0) {
+    if (builder_.RowsCount() == 0) {
         return std::nullopt;
     }
+    core::Batch batch(schema_, builder_.RowsCount());
+    builder_.Flush(batch);
     return batch;
 }
 }  // namespace columnar::csv
@@ -1,93 +1,348 @@
+#include <core/columns/bool_column.h>
 #include <core/columns/char_column.h>
+#include <core/columns/dictionary_string_column.h>
+#include <core/columns/numeric_column.h>
 #include <core/columns/string_column.h>
 #include <csv/csv_batch_writer.h>
+#include <csv/structural_scanner.h>
+#include <util/date_time.h>
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <future>
+#include <limits>
 
 namespace columnar::csv {
+namespace {
+constexpr size_t kMinRowsPerTask = 1024;
+
+bool NeedsQuotes(std::string_view value, const CSVOptions& options) {
+    for (char c : value) {
+        if (c == options.quote_char || c == options.delimiter || c == '\n' || c == '\r') {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AppendQuoted(std::string_view value, const CSVOptions& options, std::string& out) {
+    out += options.quote_char;
+    for (char c : value) {
+        if (c == options.quote_char) {
+            out += options.quote_char;
+        }
+        out += c;
+    }
+    out += options.quote_char;
+}
+
+void AppendField(std::string_view value, const CSVOptions& options, std::string& out) {
+    if (NeedsQuotes(value, options)) {
+        AppendQuoted(value, options, out);
+    } else {
+        out.append(value);
+    }
+}
+
+// Bit i is set when byte i forces the field containing it to be quoted
+void FindSpecialBytes(const char* data, size_t n, const CSVOptions& options,
+                      std::vector<uint64_t>& mask) {
+    mask.assign((n + kStructuralBlockSize - 1) / kStructuralBlockSize, 0);
+    for (size_t block = 0; block < mask.size(); ++block) {
+        const char* p = data + block * kStructuralBlockSize;
+        size_t len = n - block * kStructuralBlockSize;
+        StructuralMasks masks;
+        StructuralMasks carriage_returns;
+        if (len >= kStructuralBlockSize) {
+            masks = ScanBlock(p, options.delimiter, options.quote_char);
+            carriage_returns = ScanBlock(p, '\r', options.quote_char);
+        } else {
+            masks = ScanPartialBlock(p, len, options.delimiter, options.quote_char);
+            carriage_returns = ScanPartialBlock(p, len, '\r', options.quote_char);
+        }
+        mask[block] =
+            masks.quotes | masks.delimiters | masks.newlines | carriage_returns.delimiters;
+    }
+}
+
+bool AnyBitInRange(const std::vector<uint64_t>& mask, size_t begin, size_t end) {
+    while (begin < end) {
+        size_t bit = begin % 64;
+        size_t n = std::min<size_t>(64 - bit, end - begin);
+        uint64_t bits = mask[begin / 64] >> bit;
+        if (n < 64) {
+            bits &= (uint64_t{1} << n) - 1;
+        }
+        if (bits != 0) {
+            return true;
+        }
+        begin += n;
+    }
+    return false;
+}
+
+// Integers, dates and timestamps have a bounded width, so they are written straight into data
+template <size_t kMaxChars, typename ColumnT, typename Format>
+void FormatBounded(const ColumnT& col, size_t begin, size_t end, Format format,
+                   std::string& data, std::vector<size_t>& ends) {
+    const auto& values = col.GetData();
+    const auto& nulls = col.GetNullMask();
+    bool nullable = col.IsNullable();
+    data.resize((end - begin) * kMaxChars);
+    char* first = data.data();
+    char* p = first;
+    for (size_t i = begin; i < end; ++i) {
+        if (!nullable || !nulls.Get(i)) {
+            p = format(values[i], p);
+        }
+        ends.push_back(static_cast<size_t>(p - first));
+    }
+    data.resize(static_cast<size_t>(p - first));
+}
+
+template <typename T, typename ColumnT>
+void FormatIntegers(const core::Column& col, size_t begin, size_t end, std::string& data,
+                    std::vector<size_t>& ends) {
+    constexpr size_t kMaxChars = std::numeric_limits<T>::digits10 + 2;
+    FormatBounded<kMaxChars>(
+        static_cast<const ColumnT&>(col), begin, end,
+        [](T value, char* p) { return std::to_chars(p, p + kMaxChars, value).ptr; }, data, ends);
+}
+
+void FormatDoubles(const core::DoubleColumn& col, size_t begin, size_t end, std::string& data,
+                   std::vector<size_t>& ends) {
+    const auto& values = col.GetData();
+    const auto& nulls = col.GetNullMask();
+    bool nullable = col.IsNullable();
+    char buf[64];
+    for (size_t i = begin; i < end; ++i) {
+        if (!nullable || !nulls.Get(i)) {
+            auto res =
+                std::to_chars(buf, buf + sizeof(buf), values[i], std::chars_format::fixed, 6);
+            if (res.ec == std::errc{}) {
+                data.append(buf, static_cast<size_t>(res.ptr - buf));
+            } else {
+                data += std::to_string(values[i]);
+            }
+        }
+        ends.push_back(data.size());
+    }
+}
+
+void FormatBools(const core::BoolColumn& col, size_t begin, size_t end, std::string& data,
+                 std::vector<size_t>& ends) {
+    for (size_t i = begin; i < end; ++i) {
+        if (!col.IsNull(i)) {
+            data += col.Get(i) ? "true" : "false";
+        }
+        ends.push_back(data.size());
+    }
+}
+
+void FormatChars(const core::CharColumn& col, size_t begin, size_t end, const CSVOptions& options,
+                 std::string& data, std::vector<size_t>& ends) {
+    for (size_t i = begin; i < end; ++i) {
+        if (!col.IsNull(i)) {
+            char value = col.Get(i);
+            AppendField(std::string_view(&value, 1), options, data);
+        }
+        ends.push_back(data.size());
+    }
+}
+}  // namespace
+
+CSVBatchWriter::CSVBatchWriter(std::ostream& os, CSVOptions options)
+    : os_(os), options_(options) {
+    size_t threads = util::ThreadPool::ResolveThreads(options_.threads);
+    if (threads > 1) {
+        pool_ = std::make_unique<util::ThreadPool>(threads);
+    }
+}
+
+CSVBatchWriter::~CSVBatchWriter() = default;
+
 void CSVBatchWriter::Write(const core::Batch& batch) {
     if (options_.has_header && !header_written_) {
         WriteHeader(batch.GetSchema());
         header_written_ = true;
     }
 
-    const auto& cols = batch.GetColumns();
-    col_views_.clear();
-    col_views_.reserve(cols.size());
-    for (const auto& col : cols) {
-        col_views_.push_back({col.get(), col->GetDataType(), col->IsNullable()});
+    size_t rows = batch.RowsCount();
+    size_t tasks = 1;
+    if (pool_) {
+        tasks = std::clamp<size_t>(rows / kMinRowsPerTask, 1, pool_->Size());
+    }
+    if (ranges_.size() < tasks) {
+        ranges_.resize(tasks);
+    }
+    if (tasks == 1) {
+        FormatRows(batch, 0, rows, ranges_[0]);
+        Emit(ranges_[0].out);
+        return;
     }
 
-    for (size_t row = 0; row < batch.RowsCount(); ++row) {
-        line_buf_.clear();
-        for (size_t col = 0; col < col_views_.size(); ++col) {
-            if (col > 0) {
-                line_buf_ += options_.delimiter;
-            }
-            auto& view = col_views_[col];
-            if (view.nullable && view.column->IsNull(row)) {
-                continue;
-            }
-            if (view.type == core::DataType::String) {
-                std::string value;
-                view.column->AppendToString(row, value);
-                if (value.empty() && view.nullable) {
-                    line_buf_ += options_.quote_char;
-                    line_buf_ += options_.quote_char;
-                } else {
-                    AppendField(value);
-                }
-            } else if (view.type == core::DataType::Char) {
-                char value = static_cast<const core::CharColumn*>(view.column)->Get(row);
-                AppendField(std::string_view(&value, 1));
-            } else {
-                view.column->AppendToString(row, line_buf_);
+    std::vector<std::future<void>> done;
+    done.reserve(tasks);
+    for (size_t task = 0; task < tasks; ++task) {
+        size_t begin = rows * task / tasks;
+        size_t end = rows * (task + 1) / tasks;
+        auto promise = std::make_shared<std::promise<void>>();
+        done.push_back(promise->get_future());
+        pool_->Submit([this, &batch, begin, end, task, promise] {
+            try {
+                FormatRows(batch, begin, end, ranges_[task]);
+                promise->set_value();
+            } catch (...) {
+                promise->set_exception(std::current_exception());
             }
-        }
-        FlushLine();
+        });
+    }
+    // Every task reads the batch, so all of them finish before an error is rethrown
+    for (auto& future : done) {
+        future.wait();
+    }
+    for (size_t task = 0; task < tasks; ++task) {
+        done[task].get();
+        Emit(ranges_[task].out);
     }
 }
 
 void CSVBatchWriter::WriteHeader(const core::Schema& schema) {
-    line_buf_.clear();
+    std::string line;
     const auto& fields = schema.GetFields();
     for (size_t i = 0; i < fields.size(); ++i) {
         if (i > 0) {
-            line_buf_ += options_.delimiter;
+            line += options_.delimiter;
         }
-        AppendField(fields[i].name);
+        AppendField(fields[i].name, options_, line);
     }
-    FlushLine();
+    line += '\n';
+    Emit(line);
 }
 
-void CSVBatchWriter::AppendField(std::string_view value) {
-    bool need_quotes = false;
-    size_t quotes = 0;
-    for (char c : value) {
-        if (c == options_.quote_char) {
-            ++quotes;
-            need_quotes = true;
-        } else if (c == options_.delimiter || c == '\n' || c == '\r') {
-            need_quotes = true;
+void CSVBatchWriter::FormatRows(const core::Batch& batch, size_t begin, size_t end,
+                                RangeBuffer& buf) const {
+    const auto& cols = batch.GetColumns();
+    buf.columns.resize(cols.size());
+    size_t total = (end - begin) * (cols.size() + 1);
+    for (size_t c = 0; c < cols.size(); ++c) {
+        auto& formatted = buf.columns[c];
+        formatted.data.clear();
+        formatted.ends.clear();
+        formatted.ends.reserve(end - begin);
+        FormatColumn(*cols[c], begin, end, buf, formatted);
+        total += formatted.data.size();
+    }
+
+    buf.out.resize(total);
+    char* p = buf.out.data();
+    for (size_t row = 0; row < end - begin; ++row) {
+        for (size_t c = 0; c < cols.size(); ++c) {
+            if (c > 0) {
+                *p++ = options_.delimiter;
+            }
+            const auto& formatted = buf.columns[c];
+            size_t start = row == 0 ? 0 : formatted.ends[row - 1];
+            size_t len = formatted.ends[row] - start;
+            std::copy_n(formatted.data.data() + start, len, p);
+            p += len;
         }
+        *p++ = '\n';
+    }
+    buf.out.resize(static_cast<size_t>(p - buf.out.data()));
+}
+
+void CSVBatchWriter::FormatColumn(const core::Column& col, size_t begin, size_t end,
+                                  RangeBuffer& buf, FormattedColumn& out) const {
+    auto& data = out.data;
+    auto& ends = out.ends;
+    switch (col.GetDataType()) {
+        case core::DataType::Int16:
+            FormatIntegers<int16_t, core::Int16Column>(col, begin, end, data, ends);
+            return;
+        case core::DataType::Int32:
+            FormatIntegers<int32_t, core::Int32Column>(col, begin, end, data, ends);
+            return;
+        case core::DataType::Int64:
+            FormatIntegers<int64_t, core::Int64Column>(col, begin, end, data, ends);
+            return;
+        case core::DataType::Double:
+            FormatDoubles(static_cast<const core::DoubleColumn&>(col), begin, end, data, ends);
+            return;
+        case core::DataType::Date:
+            FormatBounded<util::kDateChars>(
+                static_cast<const core::Int32Column&>(col), begin, end,
+                [](int32_t days, char* p) { return p + util::FormatDate(days, p); }, data, ends);
+            return;
+        case core::DataType::Timestamp:
+            FormatBounded<util::kTimestampChars>(
+                static_cast<const core::Int64Column&>(col), begin, end,
+                [](int64_t seconds, char* p) { return p + util::FormatTimestamp(seconds, p); },
+                data, ends);
+            return;
+        case core::DataType::Bool:
+            FormatBools(static_cast<const core::BoolColumn&>(col), begin, end, data, ends);
+            return;
+        case core::DataType::Char:
+            FormatChars(static_cast<const core::CharColumn&>(col), begin, end, options_, data,
+                        ends);
+            return;
+        case core::DataType::String:
+            break;
     }
 
-    if (!need_quotes) {
-        line_buf_.append(value);
+    bool nullable = col.IsNullable();
+    if (col.GetKind() == core::ColumnKind::DictionaryString) {
+        // Quoting is decided once per dictionary entry: 0 unknown, 1 plain, 2 quoted
+        const auto& dict = static_cast<const core::DictionaryStringColumn&>(col);
+        buf.dict_quoting.assign(dict.DictSize(), 0);
+        for (size_t i = begin; i < end; ++i) {
+            if (!dict.IsNull(i)) {
+                uint32_t id = dict.GetId(i);
+                auto value = dict.DictValue(id);
+                if (value.empty() && nullable) {
+                    data += options_.quote_char;
+                    data += options_.quote_char;
+                } else {
+                    if (buf.dict_quoting[id] == 0) {
+                        buf.dict_quoting[id] = NeedsQuotes(value, options_) ? 2 : 1;
+                    }
+                    if (buf.dict_quoting[id] == 2) {
+                        AppendQuoted(value, options_, data);
+                    } else {
+                        data.append(value);
+                    }
+                }
+            }
+            ends.push_back(data.size());
+        }
         return;
     }
 
-    line_buf_.reserve(line_buf_.size() + value.size() + quotes + 2);
-    line_buf_ += options_.quote_char;
-    for (char c : value) {
-        if (c == options_.quote_char) {
-            line_buf_ += options_.quote_char;
+    const auto& strings = static_cast<const core::StringColumn&>(col);
+    const auto& offsets = strings.GetOffsets();
+    size_t base = offsets[begin];
+    FindSpecialBytes(strings.GetData().data() + base, offsets[end] - base, options_,
+                     buf.special_bytes);
+    data.reserve(offsets[end] - base + (end - begin));
+    for (size_t i = begin; i < end; ++i) {
+        if (!strings.IsNull(i)) {
+            auto value = strings.Get(i);
+            if (value.empty() && nullable) {
+                data += options_.quote_char;
+                data += options_.quote_char;
+            } else if (AnyBitInRange(buf.special_bytes, offsets[i] - base, offsets[i + 1] - base)) {
+                AppendQuoted(value, options_, data);
+            } else {
+                data.append(value);
+            }
         }
-        line_buf_ += c;
+        ends.push_back(data.size());
     }
-    line_buf_ += options_.quote_char;
 }
 
-void CSVBatchWriter::FlushLine() {
-    line_buf_ += '\n';
-    os_.write(line_buf_.data(), line_buf_.size());
+void CSVBatchWriter::Emit(std::string_view text) {
+    os_.write(text.data(), static_cast<std::streamsize>(text.size()));
 }
 }  // namespace columnar::csv
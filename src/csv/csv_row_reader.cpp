@@ -99,6 +99,15 @@ void ParseQuotedRow(std::string_view raw_row, const CSVOptions& options, std::st
 }
 }  // namespace
 
+void ParseRawRow(std::string_view raw_row, const CSVOptions& options, std::string& scratch,
+                 RowView& out) {
+    if (raw_row.find(options.quote_char) == std::string_view::npos) {
+        ParseUnquotedRow(raw_row, options.delimiter, out);
+    } else {
+        ParseQuotedRow(raw_row, options, scratch, out);
+    }
+}
+
 bool CSVRowReader::ReadRawRow() {
     if (!std::getline(is_, line_buf_)) {
         return false;
@@ -132,12 +141,7 @@ const RowView* CSVRowReader::ReadRowView() {
     parsed_fields_.clear();
     unescape_buf_.clear();
 
-    std::string_view raw_row = raw_buf_;
-    if (raw_row.find(options_.quote_char) == std::string_view::npos) {
-        ParseUnquotedRow(raw_row, options_.delimiter, parsed_fields_);
-    } else {
-        ParseQuotedRow(raw_row, options_, unescape_buf_, parsed_fields_);
-    }
+    ParseRawRow(raw_buf_, options_, unescape_buf_, parsed_fields_);
     return &parsed_fields_;
 }
 
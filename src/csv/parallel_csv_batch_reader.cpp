@@ -0,0 +1,215 @@
+#include <csv/parallel_csv_batch_reader.h>
+#include <csv/csv_batch_builder.h>
+#include <csv/csv_row_reader.h>
+#include <csv/structural_scanner.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <string_view>
+#include <utility>
+
+namespace columnar::csv {
+namespace {
+// CSVRowReader drops the '\r' ending every physical line of a row
+std::string_view StripCarriageReturns(std::string_view row, std::string& row_buf) {
+    if (!row.empty() && row.back() == '\r') {
+        row.remove_suffix(1);
+    }
+    if (row.find("\r\n") == std::string_view::npos) {
+        return row;
+    }
+    row_buf.clear();
+    for (size_t i = 0; i < row.size(); ++i) {
+        if (row[i] == '\r' && i + 1 < row.size() && row[i + 1] == '\n') {
+            continue;
+        }
+        row_buf += row[i];
+    }
+    return row_buf;
+}
+
+// Field boundaries come from the structural masks: delimiters and newlines outside of quotes.
+// Rows without quotes are split right here, rows with quotes go through ParseRawRow to keep the
+// exact unescaping rules of CSVRowReader
+core::Batch ParseChunk(std::string_view chunk, const core::Schema& schema,
+                       const CSVOptions& options) {
+    CSVBatchBuilder builder(schema);
+    RowView row;
+    std::string scratch;
+    std::string row_buf;
+    size_t row_start = 0;
+    size_t field_start = 0;
+    bool row_quoted = false;
+    bool in_quotes = false;
+
+    auto finish_row = [&](size_t end) {
+        if (row_quoted) {
+            row.clear();
+            scratch.clear();
+            auto raw_row = StripCarriageReturns(chunk.substr(row_start, end - row_start), row_buf);
+            ParseRawRow(raw_row, options, scratch, row);
+        } else {
+            if (end > field_start && chunk[end - 1] == '\r') {
+                --end;
+            }
+            row.push_back({chunk.substr(field_start, end - field_start), false});
+        }
+        // Quoted rows are unescaped into scratch, plain rows point into the chunk
+        builder.AddRow(row, row_quoted);
+        row.clear();
+        row_quoted = false;
+    };
+
+    for (size_t base = 0; base < chunk.size(); base += kStructuralBlockSize) {
+        size_t n = chunk.size() - base;
+        auto masks = n >= kStructuralBlockSize
+                         ? ScanBlock(chunk.data() + base, options.delimiter, options.quote_char)
+                         : ScanPartialBlock(chunk.data() + base, n, options.delimiter,
+                                            options.quote_char);
+        uint64_t outside = ~QuotedRegionMask(masks.quotes, in_quotes);
+        uint64_t quotes = masks.quotes;
+        uint64_t structural = (masks.delimiters | masks.newlines) & outside;
+        while (structural != 0) {
+            int bit = std::countr_zero(structural);
+            uint64_t below = (uint64_t{1} << bit) - 1;
+            size_t pos = base + static_cast<size_t>(bit);
+            row_quoted |= (quotes & below) != 0;
+            quotes &= ~below;
+            if ((masks.newlines >> bit) & 1) {
+                finish_row(pos);
+                row_start = pos + 1;
+            } else if (!row_quoted) {
+                row.push_back({chunk.substr(field_start, pos - field_start), false});
+            }
+            field_start = pos + 1;
+            structural &= structural - 1;
+        }
+        row_quoted |= quotes != 0;
+    }
+    if (in_quotes) {
+        THROW_RUNTIME_ERROR("Got EOF inside the quotes");
+    }
+    if (row_start < chunk.size()) {
+        finish_row(chunk.size());
+    }
+    core::Batch batch(schema, builder.RowsCount());
+    builder.Flush(batch);
+    return batch;
+}
+}  // namespace
+
+ParallelCSVBatchReader::ParallelCSVBatchReader(std::istream& is, core::Schema schema,
+                                               CSVOptions options, size_t block_size)
+    : is_(is), schema_(std::move(schema)), options_(options), block_size_(block_size) {
+    if (options_.batch_rows_size == 0 || block_size_ == 0) {
+        THROW_RUNTIME_ERROR("batch_rows_size and block_size must be positive");
+    }
+    if (options_.has_header) {
+        CutChunk(1);
+    }
+    size_t threads = util::ThreadPool::ResolveThreads(options_.threads);
+    max_in_flight_ = 2 * threads;
+    pool_ = std::make_unique<util::ThreadPool>(threads);
+}
+
+ParallelCSVBatchReader::~ParallelCSVBatchReader() = default;
+
+std::optional<core::Batch> ParallelCSVBatchReader::ReadNext() {
+    Schedule();
+    if (in_flight_.empty()) {
+        return std::nullopt;
+    }
+    auto next = std::move(in_flight_.front());
+    in_flight_.pop_front();
+    Schedule();
+    return next.get();
+}
+
+void ParallelCSVBatchReader::Schedule() {
+    while (in_flight_.size() < max_in_flight_) {
+        auto chunk = CutChunk(options_.batch_rows_size);
+        if (!chunk) {
+            return;
+        }
+        auto promise = std::make_shared<std::promise<core::Batch>>();
+        in_flight_.push_back(promise->get_future());
+        pool_->Submit([this, promise, text = std::make_shared<std::string>(std::move(*chunk))] {
+            try {
+                promise->set_value(ParseChunk(*text, schema_, options_));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+    }
+}
+
+std::optional<std::string> ParallelCSVBatchReader::CutChunk(size_t rows) {
+    size_t end = ScanRows(rows);
+    while (end == std::string::npos) {
+        bool filled = FillBuffer();
+        end = ScanRows(rows);
+        if (end == std::string::npos && !filled) {
+            if (chunk_begin_ == buf_.size()) {
+                return std::nullopt;
+            }
+            end = buf_.size();
+        }
+    }
+
+    std::string chunk = buf_.substr(chunk_begin_, end - chunk_begin_);
+    chunk_begin_ = end;
+    scanned_rows_ = 0;
+    return chunk;
+}
+
+size_t ParallelCSVBatchReader::ScanRows(size_t rows) {
+    while (scan_pos_ < buf_.size()) {
+        size_t n = buf_.size() - scan_pos_;
+        if (n < kStructuralBlockSize && !eof_) {
+            return std::string::npos;
+        }
+        const char* data = buf_.data() + scan_pos_;
+        auto masks = n >= kStructuralBlockSize
+                         ? ScanBlock(data, options_.delimiter, options_.quote_char)
+                         : ScanPartialBlock(data, n, options_.delimiter, options_.quote_char);
+        bool in_quotes = in_quotes_;
+        uint64_t row_ends = masks.newlines & ~QuotedRegionMask(masks.quotes, in_quotes);
+        auto found = static_cast<size_t>(std::popcount(row_ends));
+        if (scanned_rows_ + found >= rows) {
+            for (size_t skip = rows - scanned_rows_ - 1; skip > 0; --skip) {
+                row_ends &= row_ends - 1;
+            }
+            // The cut is right after a newline outside of quotes
+            scan_pos_ += static_cast<size_t>(std::countr_zero(row_ends)) + 1;
+            in_quotes_ = false;
+            scanned_rows_ = rows;
+            return scan_pos_;
+        }
+        in_quotes_ = in_quotes;
+        scanned_rows_ += found;
+        scan_pos_ += std::min(n, kStructuralBlockSize);
+    }
+    return std::string::npos;
+}
+
+bool ParallelCSVBatchReader::FillBuffer() {
+    if (eof_) {
+        return false;
+    }
+    buf_.erase(0, chunk_begin_);
+    scan_pos_ -= chunk_begin_;
+    chunk_begin_ = 0;
+
+    size_t old_size = buf_.size();
+    buf_.resize(old_size + block_size_);
+    is_.read(buf_.data() + old_size, static_cast<std::streamsize>(block_size_));
+    size_t got = static_cast<size_t>(is_.gcount());
+    buf_.resize(old_size + got);
+    if (!is_) {
+        eof_ = true;
+    }
+    return got > 0;
+}
+}  // namespace columnar::csv
@@ -1,13 +1,235 @@
 #include <exec/agg_state_buffer.h>
 
+#include <core/columns/dictionary_string_column.h>
 #include <core/columns/string_column.h>
+#include <exec/column_dispatch.h>
 #include <exec/column_row_access.h>
 #include <exec/expression/eval.h>
+#include <exec/group_key_table/memory.h>
 #include <util/macro.h>
 
 #include <limits>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace columnar::exec {
+namespace {
+// Calls f(group_id, row) for every selected row that belongs to a group
+template <typename F>
+void ForGroupedRows(const std::vector<uint32_t>& group_ids, const std::vector<uint32_t>* selection,
+                    F&& f) {
+    if (selection == nullptr) {
+        for (size_t row = 0; row < group_ids.size(); ++row) {
+            if (group_ids[row] != AggStateBuffer::kNoGroup) {
+                f(group_ids[row], row);
+            }
+        }
+        return;
+    }
+    for (size_t k = 0; k < group_ids.size(); ++k) {
+        if (group_ids[k] != AggStateBuffer::kNoGroup) {
+            f(group_ids[k], static_cast<size_t>((*selection)[k]));
+        }
+    }
+}
+
+// Same as ForGroupedRows, but also skips rows where the aggregated value is NULL
+template <typename Col, typename F>
+void ForGroupedValues(const Col& col, const std::vector<uint32_t>& group_ids,
+                      const std::vector<uint32_t>* selection, F&& f) {
+    if (!col.IsNullable()) {
+        ForGroupedRows(group_ids, selection, f);
+        return;
+    }
+    const util::BitVector& nulls = col.GetNullMask();
+    ForGroupedRows(group_ids, selection, [&](uint32_t group_id, size_t row) {
+        if (!nulls.Get(row)) {
+            f(group_id, row);
+        }
+    });
+}
+
+// Calls v with the column cast to its concrete string column type
+template <typename V>
+void VisitStringCol(const core::Column& col, V&& v) {
+    if (col.GetKind() == core::ColumnKind::DictionaryString) {
+        v(static_cast<const core::DictionaryStringColumn&>(col));
+    } else if (col.GetKind() == core::ColumnKind::String) {
+        v(static_cast<const core::StringColumn&>(col));
+    } else {
+        THROW_RUNTIME_ERROR("Column is not string-typed");
+    }
+}
+
+void UpdateCount(agg_array::Count& array, const std::vector<uint32_t>& group_ids) {
+    for (uint32_t group_id : group_ids) {
+        if (group_id != AggStateBuffer::kNoGroup) {
+            ++array.values[group_id];
+        }
+    }
+}
+
+void UpdateSum(agg_array::Sum& array, const core::Column& col,
+               const std::vector<uint32_t>& group_ids, const std::vector<uint32_t>* selection) {
+    if (col.GetDataType() == core::DataType::Double) {
+        if (!array.is_double) {
+            THROW_RUNTIME_ERROR("Cannot read column row as int64");
+        }
+        const auto& typed = static_cast<const core::DoubleColumn&>(col);
+        const auto& data = typed.GetData();
+        ForGroupedValues(typed, group_ids, selection, [&](uint32_t group_id, size_t row) {
+            array.has_value.Set(group_id);
+            array.double_values[group_id] += static_cast<long double>(data[row]);
+        });
+        return;
+    }
+    VisitIntegerCol(col, [&](const auto& typed) {
+        if (array.is_double) {
+            ForGroupedValues(typed, group_ids, selection, [&](uint32_t group_id, size_t row) {
+                array.has_value.Set(group_id);
+                array.double_values[group_id] += static_cast<long double>(
+                    static_cast<double>(static_cast<int64_t>(ReadTypedValue(typed, row))));
+            });
+        } else {
+            ForGroupedValues(typed, group_ids, selection, [&](uint32_t group_id, size_t row) {
+                array.has_value.Set(group_id);
+                array.int_values[group_id] += static_cast<int64_t>(ReadTypedValue(typed, row));
+            });
+        }
+    });
+}
+
+void UpdateAvg(agg_array::Avg& array, const core::Column& col,
+               const std::vector<uint32_t>& group_ids, const std::vector<uint32_t>* selection) {
+    VisitIntegerCol(col, [&](const auto& typed) {
+        ForGroupedValues(typed, group_ids, selection, [&](uint32_t group_id, size_t row) {
+            array.int_sums[group_id] += static_cast<__int128>(ReadTypedValue(typed, row));
+            ++array.counts[group_id];
+        });
+    });
+}
+
+void InsertDistinct(agg_array::Distinct& array, uint32_t group_id, int64_t value) {
+    if (array.ints.emplace(group_id, value).second) {
+        ++array.counts[group_id];
+    }
+}
+
+void InsertDistinct(agg_array::Distinct& array, uint32_t group_id, std::string_view value,
+                    util::StringArena& arena) {
+    if (!array.strings.contains(std::pair(group_id, value))) {
+        array.strings.emplace(group_id, arena.Intern(value));
+        ++array.counts[group_id];
+    }
+}
+
+// Fills the grouped values of array with a counting sort of its shared set by group
+template <typename T>
+void GroupDistinctValues(agg_array::Distinct& array,
+                         const absl::flat_hash_set<std::pair<uint32_t, T>>& set,
+                         std::vector<T>& grouped) {
+    if (array.offsets.size() == array.counts.size() + 1 && grouped.size() == set.size()) {
+        return;
+    }
+    array.offsets.assign(array.counts.size() + 1, 0);
+    for (size_t group_id = 0; group_id < array.counts.size(); ++group_id) {
+        array.offsets[group_id + 1] = array.offsets[group_id] + array.counts[group_id];
+    }
+    std::vector<uint64_t> cursors(array.offsets.begin(), array.offsets.end() - 1);
+    grouped.resize(set.size());
+    for (const auto& [group_id, value] : set) {
+        grouped[cursors[group_id]++] = value;
+    }
+}
+
+void StoreString(agg_array::MinMax& array, uint32_t group_id, std::string_view value) {
+    auto& slot = array.string_values[group_id];
+    size_t capacity = slot.capacity();
+    slot.assign(value.data(), value.size());
+    array.string_bytes += slot.capacity() - capacity;
+    array.has_value.Set(group_id);
+}
+
+void UpdateDistinct(agg_array::Distinct& array, const core::Column& col,
+                    const std::vector<uint32_t>& group_ids, const std::vector<uint32_t>* selection,
+                    util::StringArena& arena) {
+    if (!array.is_string) {
+        VisitIntegerCol(col, [&](const auto& typed) {
+            ForGroupedValues(typed, group_ids, selection, [&](uint32_t group_id, size_t row) {
+                InsertDistinct(array, group_id, static_cast<int64_t>(ReadTypedValue(typed, row)));
+            });
+        });
+        return;
+    }
+    VisitStringCol(col, [&](const auto& typed) {
+        ForGroupedValues(typed, group_ids, selection, [&](uint32_t group_id, size_t row) {
+            InsertDistinct(array, group_id, typed.Get(row), arena);
+        });
+    });
+}
+
+template <typename T, typename Col, typename Read>
+void UpdateMinMaxValues(util::BitVector& has_value, std::vector<T>& values, bool is_min,
+                        const Col& col, const std::vector<uint32_t>& group_ids,
+                        const std::vector<uint32_t>* selection, Read read) {
+    auto update = [&](auto better) {
+        ForGroupedValues(col, group_ids, selection, [&](uint32_t group_id, size_t row) {
+            T value = read(row);
+            if (!has_value.Get(group_id) || better(value, values[group_id])) {
+                values[group_id] = value;
+                has_value.Set(group_id);
+            }
+        });
+    };
+    if (is_min) {
+        update([](const T& a, const T& b) { return a < b; });
+    } else {
+        update([](const T& a, const T& b) { return a > b; });
+    }
+}
+
+void UpdateMinMax(agg_array::MinMax& array, bool is_min, const core::Column& col,
+                  const std::vector<uint32_t>& group_ids, const std::vector<uint32_t>* selection) {
+    if (array.value_type == core::DataType::String) {
+        VisitStringCol(col, [&](const auto& typed) {
+            ForGroupedValues(typed, group_ids, selection, [&](uint32_t group_id, size_t row) {
+                std::string_view value = typed.Get(row);
+                const auto& slot = array.string_values[group_id];
+                if (!array.has_value.Get(group_id) || (is_min ? value < slot : value > slot)) {
+                    StoreString(array, group_id, value);
+                }
+            });
+        });
+    } else if (col.GetDataType() == core::DataType::Double) {
+        if (array.value_type != core::DataType::Double) {
+            THROW_RUNTIME_ERROR("Cannot read column row as int64");
+        }
+        const auto& typed = static_cast<const core::DoubleColumn&>(col);
+        const auto& data = typed.GetData();
+        UpdateMinMaxValues(array.has_value, array.double_values, is_min, typed, group_ids,
+                           selection, [&](size_t row) { return data[row]; });
+    } else {
+        VisitIntegerCol(col, [&](const auto& typed) {
+            if (array.value_type == core::DataType::Double) {
+                UpdateMinMaxValues(array.has_value, array.double_values, is_min, typed, group_ids,
+                                   selection, [&](size_t row) {
+                                       return static_cast<double>(
+                                           static_cast<int64_t>(ReadTypedValue(typed, row)));
+                                   });
+            } else {
+                UpdateMinMaxValues(array.has_value, array.int_values, is_min, typed, group_ids,
+                                   selection, [&](size_t row) {
+                                       return static_cast<int64_t>(ReadTypedValue(typed, row));
+                                   });
+            }
+        });
+    }
+}
+}  // namespace
+
 void agg_array::Count::Reserve(size_t n) {
     values.reserve(n);
 }
@@ -67,19 +289,11 @@ void agg_array::MinMax::PushDefault() {
 }
 
 void agg_array::Distinct::Reserve(size_t n) {
-    if (is_string) {
-        strings.reserve(n);
-    } else {
-        ints.reserve(n);
-    }
+    counts.reserve(n);
 }
 
 void agg_array::Distinct::PushDefault() {
-    if (is_string) {
-        strings.emplace_back();
-    } else {
-        ints.emplace_back();
-    }
+    counts.push_back(0);
 }
 
 agg_array::Any AggStateBuffer::MakeArray(const AggregationUnit& unit) {
@@ -146,78 +360,36 @@ void AggStateBuffer::Reserve(size_t n) {
     }
 }
 
-void AggStateBuffer::UpdateRow(uint32_t group_id, const std::vector<const core::Column*>& agg_cols,
-                               size_t row) {
+void AggStateBuffer::Update(const std::vector<uint32_t>& group_ids,
+                            const std::vector<const core::Column*>& agg_cols,
+                            const std::vector<uint32_t>* selection) {
+    if (single_count_ != nullptr) {
+        UpdateCount(*single_count_, group_ids);
+        return;
+    }
     for (size_t i = 0; i < aggregations_.size(); ++i) {
         auto type = aggregations_[i].type;
-        if (type == AggregationType::Count) {
-            ++std::get<agg_array::Count>(arrays_[i]).values[group_id];
-            continue;
-        }
-        const core::Column& col = *agg_cols[i];
-        if (col.IsNull(row)) {
-            continue;
-        }
         switch (type) {
-            case AggregationType::Sum: {
-                auto& array = std::get<agg_array::Sum>(arrays_[i]);
-                array.has_value.Set(group_id);
-                if (array.is_double) {
-                    array.double_values[group_id] +=
-                        static_cast<long double>(ReadDoubleRow(col, row));
-                } else {
-                    array.int_values[group_id] += ReadIntegerRow(col, row);
-                }
+            case AggregationType::Count:
+                UpdateCount(std::get<agg_array::Count>(arrays_[i]), group_ids);
                 break;
-            }
-            case AggregationType::Avg: {
-                auto& array = std::get<agg_array::Avg>(arrays_[i]);
-                array.int_sums[group_id] += static_cast<__int128>(ReadIntegerRow(col, row));
-                ++array.counts[group_id];
+            case AggregationType::Sum:
+                UpdateSum(std::get<agg_array::Sum>(arrays_[i]), *agg_cols[i], group_ids,
+                          selection);
                 break;
-            }
-            case AggregationType::Distinct: {
-                auto& array = std::get<agg_array::Distinct>(arrays_[i]);
-                if (array.is_string) {
-                    auto value = ReadStringRow(col, row);
-                    auto& set = array.strings[group_id];
-                    if (!set.contains(value)) {
-                        set.insert(arena_.Intern(value));
-                    }
-                } else {
-                    array.ints[group_id].insert(ReadIntegerRow(col, row));
-                }
+            case AggregationType::Avg:
+                UpdateAvg(std::get<agg_array::Avg>(arrays_[i]), *agg_cols[i], group_ids,
+                          selection);
+                break;
+            case AggregationType::Distinct:
+                UpdateDistinct(std::get<agg_array::Distinct>(arrays_[i]), *agg_cols[i],
+                               group_ids, selection, arena_);
                 break;
-            }
             case AggregationType::Min:
-            case AggregationType::Max: {
-                auto& array = std::get<agg_array::MinMax>(arrays_[i]);
-                bool is_min = type == AggregationType::Min;
-                bool has = array.has_value.Get(group_id);
-                if (array.value_type == core::DataType::String) {
-                    auto value = ReadStringRow(col, row);
-                    auto& slot = array.string_values[group_id];
-                    if (!has || (is_min ? value < slot : value > slot)) {
-                        slot.assign(value.data(), value.size());
-                        array.has_value.Set(group_id);
-                    }
-                } else if (array.value_type == core::DataType::Double) {
-                    double value = ReadDoubleRow(col, row);
-                    auto& slot = array.double_values[group_id];
-                    if (!has || (is_min ? value < slot : value > slot)) {
-                        slot = value;
-                        array.has_value.Set(group_id);
-                    }
-                } else {
-                    int64_t value = ReadIntegerRow(col, row);
-                    auto& slot = array.int_values[group_id];
-                    if (!has || (is_min ? value < slot : value > slot)) {
-                        slot = value;
-                        array.has_value.Set(group_id);
-                    }
-                }
+            case AggregationType::Max:
+                UpdateMinMax(std::get<agg_array::MinMax>(arrays_[i]),
+                             type == AggregationType::Min, *agg_cols[i], group_ids, selection);
                 break;
-            }
             default:
                 THROW_RUNTIME_ERROR("AggStateBuffer: unsupported aggregate type " +
                                     std::to_string(static_cast<int>(type)));
@@ -255,9 +427,7 @@ void AggStateBuffer::AppendResult(size_t agg_index, uint32_t group_id, core::Col
         }
         case AggregationType::Distinct: {
             auto& distinct = std::get<agg_array::Distinct>(array);
-            size_t count = distinct.is_string ? distinct.strings[group_id].size()
-                                              : distinct.ints[group_id].size();
-            AppendInteger(out, static_cast<int64_t>(count));
+            AppendInteger(out, static_cast<int64_t>(distinct.counts[group_id]));
             return;
         }
         case AggregationType::Min:
@@ -278,4 +448,179 @@ void AggStateBuffer::AppendResult(size_t agg_index, uint32_t group_id, core::Col
     THROW_RUNTIME_ERROR("AggStateBuffer: unsupported aggregate type " +
                         std::to_string(static_cast<int>(aggregations_[agg_index].type)));
 }
+
+size_t AggStateBuffer::MemoryUsage() const {
+    using group_key::FlatTableBytes;
+    using group_key::VectorBytes;
+    size_t total = 0;
+    for (const auto& array : arrays_) {
+        std::visit(
+            [&](const auto& typed) {
+                using Array = std::decay_t<decltype(typed)>;
+                if constexpr (std::is_same_v<Array, agg_array::Count>) {
+                    total += VectorBytes(typed.values);
+                } else if constexpr (std::is_same_v<Array, agg_array::Sum>) {
+                    total += typed.has_value.Size() / 8 + VectorBytes(typed.int_values) +
+                             VectorBytes(typed.double_values);
+                } else if constexpr (std::is_same_v<Array, agg_array::Avg>) {
+                    total += VectorBytes(typed.int_sums) + VectorBytes(typed.counts);
+                } else if constexpr (std::is_same_v<Array, agg_array::MinMax>) {
+                    total += typed.has_value.Size() / 8 + VectorBytes(typed.int_values) +
+                             VectorBytes(typed.double_values) +
+                             VectorBytes(typed.string_values) + typed.string_bytes;
+                } else {
+                    total += VectorBytes(typed.counts) + FlatTableBytes(typed.ints) +
+                             FlatTableBytes(typed.strings) + VectorBytes(typed.offsets) +
+                             VectorBytes(typed.grouped_ints) +
+                             VectorBytes(typed.grouped_strings);
+                }
+            },
+            array);
+    }
+    return total;
+}
+
+void AggStateBuffer::SerializeGroup(uint32_t group_id, util::BufWriter& w) {
+    for (size_t i = 0; i < aggregations_.size(); ++i) {
+        agg_array::Any& array = arrays_[i];
+        switch (aggregations_[i].type) {
+            case AggregationType::Count:
+                w.Write<int64_t>(std::get<agg_array::Count>(array).values[group_id]);
+                break;
+            case AggregationType::Sum: {
+                auto& sum = std::get<agg_array::Sum>(array);
+                w.Write<uint8_t>(sum.has_value.Get(group_id) ? 1 : 0);
+                if (sum.is_double) {
+                    w.Write<long double>(sum.double_values[group_id]);
+                } else {
+                    w.Write<int64_t>(sum.int_values[group_id]);
+                }
+                break;
+            }
+            case AggregationType::Avg: {
+                auto& avg = std::get<agg_array::Avg>(array);
+                w.Write<__int128>(avg.int_sums[group_id]);
+                w.Write<uint64_t>(avg.counts[group_id]);
+                break;
+            }
+            case AggregationType::Distinct: {
+                auto& distinct = std::get<agg_array::Distinct>(array);
+                if (distinct.is_string) {
+                    GroupDistinctValues(distinct, distinct.strings, distinct.grouped_strings);
+                } else {
+                    GroupDistinctValues(distinct, distinct.ints, distinct.grouped_ints);
+                }
+                uint64_t begin = distinct.offsets[group_id];
+                uint64_t end = distinct.offsets[group_id + 1];
+                w.Write<uint64_t>(end - begin);
+                for (uint64_t k = begin; k < end; ++k) {
+                    if (distinct.is_string) {
+                        std::string_view value = distinct.grouped_strings[k];
+                        w.Write<uint32_t>(static_cast<uint32_t>(value.size()));
+                        w.WriteRaw(value.data(), value.size());
+                    } else {
+                        w.Write<int64_t>(distinct.grouped_ints[k]);
+                    }
+                }
+                break;
+            }
+            case AggregationType::Min:
+            case AggregationType::Max: {
+                auto& min_max = std::get<agg_array::MinMax>(array);
+                bool has = min_max.has_value.Get(group_id);
+                w.Write<uint8_t>(has ? 1 : 0);
+                if (!has) {
+                    break;
+                }
+                if (min_max.value_type == core::DataType::String) {
+                    const auto& value = min_max.string_values[group_id];
+                    w.Write<uint32_t>(static_cast<uint32_t>(value.size()));
+                    w.WriteRaw(value.data(), value.size());
+                } else if (min_max.value_type == core::DataType::Double) {
+                    w.Write<double>(min_max.double_values[group_id]);
+                } else {
+                    w.Write<int64_t>(min_max.int_values[group_id]);
+                }
+                break;
+            }
+        }
+    }
+}
+
+void AggStateBuffer::MergeGroup(uint32_t group_id, util::BufReader& r) {
+    auto read_string = [&r] {
+        auto size = r.Read<uint32_t>();
+        return std::string_view(reinterpret_cast<const char*>(r.Take(size)), size);
+    };
+    for (size_t i = 0; i < aggregations_.size(); ++i) {
+        agg_array::Any& array = arrays_[i];
+        auto type = aggregations_[i].type;
+        switch (type) {
+            case AggregationType::Count:
+                std::get<agg_array::Count>(array).values[group_id] += r.Read<int64_t>();
+                break;
+            case AggregationType::Sum: {
+                auto& sum = std::get<agg_array::Sum>(array);
+                if (r.Read<uint8_t>() != 0) {
+                    sum.has_value.Set(group_id);
+                }
+                if (sum.is_double) {
+                    sum.double_values[group_id] += r.Read<long double>();
+                } else {
+                    sum.int_values[group_id] += r.Read<int64_t>();
+                }
+                break;
+            }
+            case AggregationType::Avg: {
+                auto& avg = std::get<agg_array::Avg>(array);
+                avg.int_sums[group_id] += r.Read<__int128>();
+                avg.counts[group_id] += r.Read<uint64_t>();
+                break;
+            }
+            case AggregationType::Distinct: {
+                auto& distinct = std::get<agg_array::Distinct>(array);
+                auto count = r.Read<uint64_t>();
+                for (uint64_t k = 0; k < count; ++k) {
+                    if (distinct.is_string) {
+                        InsertDistinct(distinct, group_id, read_string(), arena_);
+                    } else {
+                        InsertDistinct(distinct, group_id, r.Read<int64_t>());
+                    }
+                }
+                break;
+            }
+            case AggregationType::Min:
+            case AggregationType::Max: {
+                auto& min_max = std::get<agg_array::MinMax>(array);
+                if (r.Read<uint8_t>() == 0) {
+                    break;
+                }
+                bool is_min = type == AggregationType::Min;
+                bool has = min_max.has_value.Get(group_id);
+                if (min_max.value_type == core::DataType::String) {
+                    auto value = read_string();
+                    const auto& slot = min_max.string_values[group_id];
+                    if (!has || (is_min ? value < slot : value > slot)) {
+                        StoreString(min_max, group_id, value);
+                    }
+                } else if (min_max.value_type == core::DataType::Double) {
+                    auto value = r.Read<double>();
+                    auto& slot = min_max.double_values[group_id];
+                    if (!has || (is_min ? value < slot : value > slot)) {
+                        slot = value;
+                        min_max.has_value.Set(group_id);
+                    }
+                } else {
+                    auto value = r.Read<int64_t>();
+                    auto& slot = min_max.int_values[group_id];
+                    if (!has || (is_min ? value < slot : value > slot)) {
+                        slot = value;
+                        min_max.has_value.Set(group_id);
+                    }
+                }
+                break;
+            }
+        }
+    }
+}
 }  // namespace columnar::exec
@@ -129,7 +129,7 @@ void UpdateAggregationState(AggregationState& state, const AggregationUnit& unit
         case AggregationType::Distinct: {
             auto& distinct = std::get<DistinctState>(state);
             if (type == core::DataType::String) {
-                kernel::DistinctStrings(col, distinct.strings, selection);
+                kernel::DistinctStrings(col, distinct.strings, distinct.arena, selection);
             } else if (HasIntegerValue(type)) {
                 kernel::DistinctInts(col, distinct.ints, selection);
             } else {
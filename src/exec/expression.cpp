@@ -7,6 +7,8 @@
 #include <exec/selection.h>
 #include <exec/expression/utils.h>
 #include <exec/kernel.h>
+#include <exec/runtime_filter.h>
+#include <util/bit_vector.h>
 #include <util/macro.h>
 
 #include <string_view>
@@ -48,92 +50,127 @@ struct BoolColumnTerm {
     const core::BoolColumn* col = nullptr;
 };
 
-using PredicateTerm =
-    std::variant<InIntTerm, IntCompareTerm, StringCompareTerm, ContainsTerm, BoolColumnTerm>;
+struct RuntimeFilterTerm {
+    const core::Column* col = nullptr;
+    const core::DictionaryStringColumn* dict_col = nullptr;
+    const RuntimeFilter* filter = nullptr;
+    std::vector<uint8_t> dict_matches;
+};
 
-std::unique_ptr<core::Column> EvalFunction(const core::Column& arg, ScalarFunction function) {
+using PredicateTerm = std::variant<InIntTerm, IntCompareTerm, StringCompareTerm, ContainsTerm,
+                                   BoolColumnTerm, RuntimeFilterTerm>;
+
+bool RuntimeFilterMatches(const core::Column& col, const RuntimeFilter& filter, size_t row) {
+    if (col.IsNull(row)) {
+        return false;
+    }
+    if (filter.IsString()) {
+        return filter.MayContain(ReadStringRow(col, row));
+    }
+    return filter.MayContain(ReadIntegerRow(col, row));
+}
+
+std::unique_ptr<core::Column> EvalRuntimeFilter(const core::Column& col,
+                                                const RuntimeFilter& filter,
+                                                const std::vector<uint32_t>* selection) {
+    size_t rows = col.Size();
+    util::BitVector data(rows);
+    ForSelectedRows(selection, rows, [&](size_t row) {
+        if (RuntimeFilterMatches(col, filter, row)) {
+            data.Set(row);
+        }
+    });
+    return std::make_unique<core::BoolColumn>(std::move(data), util::BitVector(), false, rows);
+}
+
+std::unique_ptr<core::Column> EvalFunction(const core::Column& arg, ScalarFunction function,
+                                           const std::vector<uint32_t>* selection) {
     switch (function) {
         case ScalarFunction::Length:
-            return kernel::StrLength(arg);
+            return kernel::StrLength(arg, selection);
         case ScalarFunction::ExtractMinute:
-            return kernel::ExtractMinute(arg);
+            return kernel::ExtractMinute(arg, selection);
         case ScalarFunction::TruncMinute:
-            return kernel::TruncMinute(arg);
+            return kernel::TruncMinute(arg, selection);
     }
     THROW_RUNTIME_ERROR("Unsupported scalar function");
 }
 
 std::unique_ptr<core::Column> EvalBinary(const core::Column& lhs, const core::Column& rhs,
-                                         BinaryFunction function) {
+                                         BinaryFunction function,
+                                         const std::vector<uint32_t>* selection) {
     switch (function) {
         case BinaryFunction::Equal:
-            return kernel::Equal(lhs, rhs);
+            return kernel::Equal(lhs, rhs, selection);
         case BinaryFunction::NotEqual:
-            return kernel::NotEqual(lhs, rhs);
+            return kernel::NotEqual(lhs, rhs, selection);
         case BinaryFunction::Less:
-            return kernel::Less(lhs, rhs);
+            return kernel::Less(lhs, rhs, selection);
         case BinaryFunction::LessOrEqual:
-            return kernel::LessOrEqual(lhs, rhs);
+            return kernel::LessOrEqual(lhs, rhs, selection);
         case BinaryFunction::Greater:
-            return kernel::Greater(lhs, rhs);
+            return kernel::Greater(lhs, rhs, selection);
         case BinaryFunction::GreaterOrEqual:
-            return kernel::GreaterOrEqual(lhs, rhs);
+            return kernel::GreaterOrEqual(lhs, rhs, selection);
         case BinaryFunction::And:
-            return kernel::And(lhs, rhs);
+            return kernel::And(lhs, rhs, selection);
         case BinaryFunction::Or:
-            return kernel::Or(lhs, rhs);
+            return kernel::Or(lhs, rhs, selection);
         case BinaryFunction::Plus:
-            return kernel::Add(lhs, rhs);
+            return kernel::Add(lhs, rhs, selection);
         case BinaryFunction::Minus:
-            return kernel::Subtract(lhs, rhs);
+            return kernel::Subtract(lhs, rhs, selection);
         case BinaryFunction::Multiply:
-            return kernel::Multiply(lhs, rhs);
+            return kernel::Multiply(lhs, rhs, selection);
     }
     THROW_RUNTIME_ERROR("Unsupported binary function");
 }
 
 std::unique_ptr<core::Column> EvalIntConstCompare(const core::Column& col, int64_t value,
-                                                  BinaryFunction f) {
+                                                  BinaryFunction f,
+                                                  const std::vector<uint32_t>* selection) {
     switch (f) {
         case BinaryFunction::Equal:
-            return kernel::EqualConstInt(col, value);
+            return kernel::EqualConstInt(col, value, selection);
         case BinaryFunction::NotEqual:
-            return kernel::NotEqualConstInt(col, value);
+            return kernel::NotEqualConstInt(col, value, selection);
         case BinaryFunction::Less:
-            return kernel::LessConstInt(col, value);
+            return kernel::LessConstInt(col, value, selection);
         case BinaryFunction::LessOrEqual:
-            return kernel::LessOrEqualConstInt(col, value);
+            return kernel::LessOrEqualConstInt(col, value, selection);
         case BinaryFunction::Greater:
-            return kernel::GreaterConstInt(col, value);
+            return kernel::GreaterConstInt(col, value, selection);
         case BinaryFunction::GreaterOrEqual:
-            return kernel::GreaterOrEqualConstInt(col, value);
+            return kernel::GreaterOrEqualConstInt(col, value, selection);
         default:
             THROW_RUNTIME_ERROR("EvalIntConstCompare: not a comparison");
     }
 }
 
 std::unique_ptr<core::Column> EvalStringConstCompare(const core::Column& col,
-                                                     std::string_view value, BinaryFunction f) {
+                                                     std::string_view value, BinaryFunction f,
+                                                     const std::vector<uint32_t>* selection) {
     switch (f) {
         case BinaryFunction::Equal:
-            return kernel::EqualConstString(col, value);
+            return kernel::EqualConstString(col, value, selection);
         case BinaryFunction::NotEqual:
-            return kernel::NotEqualConstString(col, value);
+            return kernel::NotEqualConstString(col, value, selection);
         case BinaryFunction::Less:
-            return kernel::LessConstString(col, value);
+            return kernel::LessConstString(col, value, selection);
         case BinaryFunction::LessOrEqual:
-            return kernel::LessOrEqualConstString(col, value);
+            return kernel::LessOrEqualConstString(col, value, selection);
         case BinaryFunction::Greater:
-            return kernel::GreaterConstString(col, value);
+            return kernel::GreaterConstString(col, value, selection);
         case BinaryFunction::GreaterOrEqual:
-            return kernel::GreaterOrEqualConstString(col, value);
+            return kernel::GreaterOrEqualConstString(col, value, selection);
         default:
             THROW_RUNTIME_ERROR("EvalStringConstCompare: not a comparison");
     }
 }
 
 std::unique_ptr<core::Column> TryEvalConstCompare(const core::Batch& batch,
-                                                  const BinaryExpr& binary) {
+                                                  const BinaryExpr& binary,
+                                                  const std::vector<uint32_t>* selection) {
     if (!IsComparisonFunction(binary.function)) {
         return nullptr;
     }
@@ -154,10 +191,12 @@ std::unique_ptr<core::Column> TryEvalConstCompare(const core::Batch& batch,
             return nullptr;
         }
         return EvalIntConstCompare(col_eval.Get(),
-                                   static_cast<const ConstInt64&>(*const_side).value, op);
+                                   static_cast<const ConstInt64&>(*const_side).value, op,
+                                   selection);
     }
     return EvalStringConstCompare(col_eval.Get(),
-                                  static_cast<const ConstString&>(*const_side).value, op);
+                                  static_cast<const ConstString&>(*const_side).value, op,
+                                  selection);
 }
 
 const core::Column& ResolveColumn(const core::Batch& batch, const ColumnExpr& expr) {
@@ -196,6 +235,17 @@ void PrepareDictionaryTerm(StringCompareTerm& term) {
     }
 }
 
+void PrepareDictionaryTerm(RuntimeFilterTerm& term) {
+    term.dict_col = core::AsDictionaryString(term.col);
+    if (term.dict_col == nullptr) {
+        return;
+    }
+    term.dict_matches.resize(term.dict_col->DictSize());
+    for (uint32_t id = 0; id < term.dict_matches.size(); ++id) {
+        term.dict_matches[id] = term.filter->MayContain(term.dict_col->DictValue(id)) ? 1 : 0;
+    }
+}
+
 void PrepareDictionaryTerm(ContainsTerm& term) {
     term.dict_col = core::AsDictionaryString(term.col);
     if (term.dict_col == nullptr) {
@@ -254,6 +304,19 @@ bool TryCompileSimpleTerm(const core::Batch& batch, const Expression& expr,
         return true;
     }
 
+    if (expr.type == ExpressionType::RuntimeFilter) {
+        const auto& runtime_filter = static_cast<const RuntimeFilterExpr&>(expr);
+        if (runtime_filter.key->type != ExpressionType::Column) {
+            return false;
+        }
+        RuntimeFilterTerm term{
+            &ResolveColumn(batch, static_cast<const ColumnExpr&>(*runtime_filter.key)), nullptr,
+            runtime_filter.filter.get(), {}};
+        PrepareDictionaryTerm(term);
+        terms.push_back(std::move(term));
+        return true;
+    }
+
     if (expr.type == ExpressionType::Contains) {
         const auto& contains = static_cast<const ContainsExpr&>(expr);
         if (contains.expr->type != ExpressionType::Column) {
@@ -373,6 +436,12 @@ bool MatchesTerm(const PredicateTerm& term, size_t row) {
                 return typed.negated ? !found : found;
             } else if constexpr (std::is_same_v<T, BoolColumnTerm>) {
                 return !typed.col->IsNull(row) && typed.col->Get(row);
+            } else if constexpr (std::is_same_v<T, RuntimeFilterTerm>) {
+                if (typed.dict_col != nullptr) {
+                    return !typed.col->IsNull(row) &&
+                           typed.dict_matches[typed.dict_col->GetId(row)] != 0;
+                }
+                return RuntimeFilterMatches(*typed.col, *typed.filter, row);
             } else {
                 return false;
             }
@@ -380,16 +449,40 @@ bool MatchesTerm(const PredicateTerm& term, size_t row) {
         term);
 }
 
-std::vector<uint32_t> SelectionFromMask(const core::Batch& batch, const core::BoolColumn& mask) {
-    std::vector<uint32_t> selection;
-    selection.reserve(batch.SelectedRowsCount());
-    const std::vector<uint32_t>* input = batch.HasSelection() ? &batch.Selection() : nullptr;
-    ForSelectedRows(input, batch.RowsCount(), [&](size_t row) {
-        if (!mask.IsNull(row) && mask.Get(row)) {
-            selection.push_back(static_cast<uint32_t>(row));
+core::RowSelection SelectionFromMask(const core::Batch& batch, const core::BoolColumn& mask) {
+    if (batch.HasSelection() &&
+        batch.GetRowSelection().GetKind() == core::RowSelection::Kind::Indices) {
+        std::vector<uint32_t> selection;
+        selection.reserve(batch.SelectedRowsCount());
+        for (uint32_t row : batch.Selection()) {
+            if (!mask.IsNull(row) && mask.Get(row)) {
+                selection.push_back(row);
+            }
         }
-    });
-    return selection;
+        return core::RowSelection::FromIndices(std::move(selection), batch.RowsCount());
+    }
+
+    // A dense or no input selection is intersected with the mask a word at a time
+    size_t rows = batch.RowsCount();
+    std::vector<uint64_t> words = mask.GetData().GetData();
+    words.resize((rows + 63) / 64);
+    if (rows % 64 != 0) {
+        words.back() &= (uint64_t{1} << (rows % 64)) - 1;
+    }
+    if (mask.IsNullable()) {
+        const auto& nulls = mask.GetNullMask().GetData();
+        for (size_t w = 0; w < words.size(); ++w) {
+            words[w] &= ~nulls[w];
+        }
+    }
+    if (batch.HasSelection()) {
+        auto input = batch.GetRowSelection().ToBitmap(rows);
+        const auto& selected = input.GetData();
+        for (size_t w = 0; w < words.size(); ++w) {
+            words[w] &= selected[w];
+        }
+    }
+    return core::RowSelection::FromBitmap(util::BitVector(std::move(words), rows));
 }
 }  // namespace
 
@@ -406,6 +499,7 @@ core::DataType GetExpressionType(const Expression& expr) {
                        ? core::DataType::Int64
                        : core::DataType::Bool;
         case ExpressionType::Contains:
+        case ExpressionType::RuntimeFilter:
             return core::DataType::Bool;
         case ExpressionType::Function:
             return static_cast<const FunctionExpr&>(expr).function == ScalarFunction::TruncMinute
@@ -455,6 +549,9 @@ void CollectColumns(const Expression& expr, std::vector<std::string>& columns) {
         case ExpressionType::PrefixCapture:
             CollectColumns(*static_cast<const PrefixCaptureExpr&>(expr).arg, columns);
             return;
+        case ExpressionType::RuntimeFilter:
+            CollectColumns(*static_cast<const RuntimeFilterExpr&>(expr).key, columns);
+            return;
         case ExpressionType::ConstInt64:
         case ExpressionType::ConstString:
             return;
@@ -464,6 +561,7 @@ void CollectColumns(const Expression& expr, std::vector<std::string>& columns) {
 
 EvalResult Evaluate(const core::Batch& batch, const Expression& expr) {
     size_t rows = batch.RowsCount();
+    const std::vector<uint32_t>* selection = KernelSelection(batch);
     switch (expr.type) {
         case ExpressionType::ConstInt64:
             return EvalResult(kernel::ConstInt64(static_cast<const ConstInt64&>(expr).value, rows));
@@ -476,23 +574,23 @@ EvalResult Evaluate(const core::Batch& batch, const Expression& expr) {
         }
         case ExpressionType::Binary: {
             auto& binary = static_cast<const BinaryExpr&>(expr);
-            if (auto fast = TryEvalConstCompare(batch, binary)) {
+            if (auto fast = TryEvalConstCompare(batch, binary, selection)) {
                 return EvalResult(std::move(fast));
             }
             auto lhs = Evaluate(batch, *binary.lhs);
             auto rhs = Evaluate(batch, *binary.rhs);
-            return EvalResult(EvalBinary(lhs.Get(), rhs.Get(), binary.function));
+            return EvalResult(EvalBinary(lhs.Get(), rhs.Get(), binary.function, selection));
         }
         case ExpressionType::Contains: {
             auto& contains = static_cast<const ContainsExpr&>(expr);
             auto operand = Evaluate(batch, *contains.expr);
-            return EvalResult(
-                kernel::StrContains(operand.Get(), contains.substring, contains.negated));
+            return EvalResult(kernel::StrContains(operand.Get(), contains.substring,
+                                                  contains.negated, selection));
         }
         case ExpressionType::Function: {
             auto& function = static_cast<const FunctionExpr&>(expr);
             auto arg = Evaluate(batch, *function.arg);
-            return EvalResult(EvalFunction(arg.Get(), function.function));
+            return EvalResult(EvalFunction(arg.Get(), function.function, selection));
         }
         case ExpressionType::Case: {
             auto& case_expr = static_cast<const CaseExpr&>(expr);
@@ -500,29 +598,36 @@ EvalResult Evaluate(const core::Batch& batch, const Expression& expr) {
             auto when_true = Evaluate(batch, *case_expr.when_true);
             auto when_false = Evaluate(batch, *case_expr.when_false);
             const auto& mask = static_cast<const core::BoolColumn&>(cond.Get());
-            return EvalResult(kernel::CaseSelect(mask, when_true.Get(), when_false.Get()));
+            return EvalResult(
+                kernel::CaseSelect(mask, when_true.Get(), when_false.Get(), selection));
         }
         case ExpressionType::RegexReplace: {
             auto& regex_replace = static_cast<const RegexReplaceExpr&>(expr);
             auto arg = Evaluate(batch, *regex_replace.arg);
-            return EvalResult(
-                kernel::RegexReplace(arg.Get(), regex_replace.regex, regex_replace.replacement));
+            return EvalResult(kernel::RegexReplace(arg.Get(), regex_replace.regex,
+                                                   regex_replace.replacement, selection));
         }
         case ExpressionType::PrefixCapture: {
             auto& prefix_capture = static_cast<const PrefixCaptureExpr&>(expr);
             auto arg = Evaluate(batch, *prefix_capture.arg);
             return EvalResult(kernel::PrefixCapture(
                 arg.Get(), prefix_capture.prefixes, prefix_capture.delimiter,
-                prefix_capture.require_non_empty, prefix_capture.single_line_tail));
+                prefix_capture.require_non_empty, prefix_capture.single_line_tail, selection));
+        }
+        case ExpressionType::RuntimeFilter: {
+            auto& runtime_filter = static_cast<const RuntimeFilterExpr&>(expr);
+            auto key = Evaluate(batch, *runtime_filter.key);
+            return EvalResult(EvalRuntimeFilter(key.Get(), *runtime_filter.filter, selection));
         }
     }
     THROW_RUNTIME_ERROR("Unsupported expression type");
 }
 
-std::vector<uint32_t> EvaluatePredicateSelection(const core::Batch& batch, const Expression& expr) {
+core::RowSelection EvaluatePredicateSelection(const core::Batch& batch, const Expression& expr) {
     std::vector<PredicateTerm> terms;
     if (!TryCompileTerms(batch, expr, terms) ||
-        (terms.size() == 1 && !std::holds_alternative<InIntTerm>(terms.front()))) {
+        (terms.size() == 1 && !std::holds_alternative<InIntTerm>(terms.front()) &&
+         !std::holds_alternative<RuntimeFilterTerm>(terms.front()))) {
         auto result = Evaluate(batch, expr);
         if (result.Get().GetDataType() != core::DataType::Bool) {
             THROW_RUNTIME_ERROR("Filter condition must produce a boolean column");
@@ -531,30 +636,15 @@ std::vector<uint32_t> EvaluatePredicateSelection(const core::Batch& batch, const
     }
 
     std::vector<uint32_t> selection;
-    if (batch.HasSelection()) {
-        selection = batch.Selection();
-    } else {
-        size_t rows = batch.RowsCount();
-        selection.resize(rows);
-        for (size_t row = 0; row < rows; ++row) {
-            selection[row] = static_cast<uint32_t>(row);
-        }
-    }
-
-    size_t out = 0;
-    for (uint32_t row : selection) {
-        bool matched = true;
+    selection.reserve(batch.SelectedRowsCount());
+    ForSelectedRows(batch, [&](size_t row) {
         for (auto& term : terms) {
             if (!MatchesTerm(term, row)) {
-                matched = false;
-                break;
+                return;
             }
         }
-        if (matched) {
-            selection[out++] = row;
-        }
-    }
-    selection.resize(out);
-    return selection;
+        selection.push_back(static_cast<uint32_t>(row));
+    });
+    return core::RowSelection::FromIndices(std::move(selection), batch.RowsCount());
 }
 }  // namespace columnar::exec
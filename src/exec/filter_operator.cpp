@@ -8,7 +8,7 @@ void FilterSink::Consume(core::Batch batch) {
         return;
     }
     auto selection = EvaluatePredicateSelection(batch, *condition_);
-    size_t selected = selection.size();
+    size_t selected = selection.Count();
     if (selected == 0) {
         return;
     }
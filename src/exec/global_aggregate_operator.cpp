@@ -1,8 +1,6 @@
 #include <exec/global_aggregate_operator.h>
 
 #include <exec/expression/eval.h>
-#include <exec/expression/utils.h>
-#include <exec/kernel.h>
 
 #include <utility>
 #include <vector>
@@ -13,14 +11,10 @@ GlobalAggregationSink::GlobalAggregationSink(IOperator& downstream,
     : downstream_(downstream),
       output_schema_(MakeAggregationSchema(aggregations)),
       aggregations_(std::move(aggregations)),
-      states_(MakeAggregationStates(aggregations_)),
-      needs_dense_(RequiresDenseBatch(aggregations_)) {
+      states_(MakeAggregationStates(aggregations_)) {
 }
 
 void GlobalAggregationSink::Consume(core::Batch batch) {
-    if (batch.HasSelection() && needs_dense_) {
-        batch = kernel::Materialize(batch);
-    }
     const std::vector<uint32_t>* selection = batch.HasSelection() ? &batch.Selection() : nullptr;
     for (size_t i = 0; i < aggregations_.size(); ++i) {
         auto& unit = aggregations_[i];
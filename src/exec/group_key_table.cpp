@@ -5,13 +5,17 @@
 #include <exec/expression/eval.h>
 #include <exec/expression/types.h>
 #include <exec/group_key_table/factories.h>
+#include <exec/group_key_table/key_layout.h>
 
+#include <algorithm>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace columnar::exec {
-std::unique_ptr<GroupKeyTable> GroupKeyTable::Make(const std::vector<ProjectionUnit>& keys,
-                                                   util::StringArena& arena) {
+namespace {
+std::unique_ptr<GroupKeyTable> MakeHashedKeyTable(const std::vector<ProjectionUnit>& keys,
+                                                  util::StringArena& arena) {
     if (keys.size() == 3 && HasIntegerValue(GetExpressionType(*keys[0].expression)) &&
         HasIntegerValue(GetExpressionType(*keys[1].expression)) &&
         GetExpressionType(*keys[2].expression) == core::DataType::String) {
@@ -21,10 +25,6 @@ std::unique_ptr<GroupKeyTable> GroupKeyTable::Make(const std::vector<ProjectionU
         GetExpressionType(*keys[1].expression) == core::DataType::String) {
         return MakeInt64StringKeyTable(arena);
     }
-    if (keys.size() == 2 && HasIntegerValue(GetExpressionType(*keys[0].expression)) &&
-        HasIntegerValue(GetExpressionType(*keys[1].expression))) {
-        return MakeInt64PairKeyTable();
-    }
     if (keys.size() == 1) {
         auto type = GetExpressionType(*keys[0].expression);
         if (type == core::DataType::String) {
@@ -34,6 +34,25 @@ std::unique_ptr<GroupKeyTable> GroupKeyTable::Make(const std::vector<ProjectionU
             return MakeInt64KeyTable();
         }
     }
-    return MakeCompositeKeyTable(keys, arena);
+    auto layout = group_key::MakeKeyLayout(keys);
+    if (!layout.has_strings && layout.fixed_width <= group_key::kMaxPackedKeyBytes) {
+        return MakePackedKeyTable(std::move(layout));
+    }
+    return MakeCompositeKeyTable(std::move(layout), arena);
+}
+}  // namespace
+
+std::unique_ptr<GroupKeyTable> GroupKeyTable::Make(const std::vector<ProjectionUnit>& keys,
+                                                   util::StringArena& arena) {
+    auto table = MakeHashedKeyTable(keys, arena);
+    bool integer_keys = !keys.empty() && std::all_of(keys.begin(), keys.end(), [](auto& key) {
+        return HasIntegerValue(GetExpressionType(*key.expression));
+    });
+    if (integer_keys) {
+        // Small key ranges are grouped in a direct-mapped array, the hashed table takes over
+        // when the range grows
+        return MakeDenseIntegerKeyTable(keys.size(), std::move(table));
+    }
+    return table;
 }
 }  // namespace columnar::exec
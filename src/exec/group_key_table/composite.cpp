@@ -1,279 +1,177 @@
 #include <core/batch.h>
 #include <core/columns/dictionary_string_column.h>
 #include <core/columns/string_column.h>
+#include <exec/column_dispatch.h>
 #include <exec/column_row_access.h>
-#include <exec/expression/eval.h>
-#include <exec/expression/types.h>
 #include <exec/group_key_table.h>
 #include <exec/group_key_table/factories.h>
 #include <exec/group_key_table/hash.h>
+#include <exec/group_key_table/key_layout.h>
+#include <exec/group_key_table/memory.h>
+#include <exec/group_key_table/probe.h>
 #include <exec/selection.h>
 #include <util/string_arena.h>
 
-#include <absl/container/flat_hash_set.h>
+#include <absl/container/flat_hash_map.h>
 
-#include <cassert>
 #include <cstdint>
-#include <functional>
+#include <cstring>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace columnar::exec {
 namespace {
+// Groups keys of any shape by their serialized blob (see KeyLayout), interned in the arena
 class CompositeKeyTable final : public GroupKeyTable {
 public:
-    CompositeKeyTable(const std::vector<ProjectionUnit>& keys, util::StringArena& arena)
-        : arena_(arena), groups_(0, GroupHash{this}, GroupEq{this}) {
-        part_kinds_.reserve(keys.size());
-        int_keys_.resize(keys.size());
-        string_keys_.resize(keys.size());
-        for (auto& key : keys) {
-            auto type = GetExpressionType(*key.expression);
-            part_kinds_.push_back(type == core::DataType::String ? PartKind::String
-                                                                 : PartKind::Int64);
-        }
+    CompositeKeyTable(group_key::KeyLayout layout, util::StringArena& arena)
+        : layout_(std::move(layout)), arena_(arena) {
     }
 
-    void Consume(const std::vector<const core::Column*>& key_cols,
-                 const std::vector<const core::Column*>& agg_cols,
-                 const std::vector<uint32_t>* selection, size_t rows,
-                 AggStateBuffer& state) override {
-        BatchView batch_view(*this, key_cols);
-        ForSelectedRows(selection, rows, [&](size_t row) {
-            if (batch_view.HasNull(row)) {
-                return;
+    void FindGroups(const std::vector<const core::Column*>& key_cols,
+                    const std::vector<uint32_t>* selection, size_t rows, AggStateBuffer& state,
+                    std::vector<uint32_t>& group_ids) override {
+        SerializeRows(key_cols, selection, rows);
+        size_t n = is_null_.size();
+        size_t first_slot = group_ids.size();
+        group_ids.resize(first_slot + n, AggStateBuffer::kNoGroup);
+        probes_.keys.clear();
+        probes_.slots.clear();
+        for (size_t k = 0; k < n; ++k) {
+            if (!is_null_[k]) {
+                std::string_view blob(blobs_.data() + blob_offsets_[k],
+                                      blob_offsets_[k + 1] - blob_offsets_[k]);
+                probes_.keys.push_back(group_key::MakeHashedString(blob));
+                probes_.slots.push_back(static_cast<uint32_t>(first_slot + k));
             }
-            ProbeKey probe{&batch_view, row, batch_view.HashRow(row)};
-            uint32_t group_id;
-            if (!LookupGroup(probe, group_id)) {
-                group_id = state.EmplaceGroup();
-                InsertGroup(group_id, probe);
+        }
+
+        group_key::ResolveProbes(table_, probes_, group_ids, [&](const Key& key) {
+            auto it = table_.find(key);
+            if (it != table_.end()) {
+                return it->second;
             }
-            state.OnRow(group_id, agg_cols, row);
+            if (frozen_) {
+                return AggStateBuffer::kNoGroup;
+            }
+            auto interned = arena_.Intern(key.value);
+            uint32_t group_id = state.EmplaceGroup();
+            table_.emplace(Key{interned, key.hash}, group_id);
+            keys_.push_back(interned);
+            return group_id;
         });
     }
 
     void AppendKeys(uint32_t group_id, core::Batch& out) const override {
-        for (size_t i = 0; i < part_kinds_.size(); ++i) {
-            auto& column = out.ColumnAt(i);
-            if (part_kinds_[i] == PartKind::String) {
-                column.AppendFromString(string_keys_[i][group_id]);
+        const auto* p = reinterpret_cast<const uint8_t*>(keys_[group_id].data());
+        for (size_t i = 0; i < layout_.parts.size(); ++i) {
+            const auto& part = layout_.parts[i];
+            if (part.is_string) {
+                uint32_t size;
+                std::memcpy(&size, p, sizeof(size));
+                p += sizeof(size);
+                out.ColumnAt(i).AppendFromString(
+                    std::string_view(reinterpret_cast<const char*>(p), size));
+                p += size;
             } else {
-                AppendInteger(column, int_keys_[i][group_id]);
+                AppendInteger(out.ColumnAt(i), group_key::LoadInteger(p, part.width));
+                p += part.width;
             }
         }
     }
 
     void ReserveBuckets(size_t n) override {
-        groups_.reserve(n);
-        group_hashes_.reserve(n);
-        for (auto& keys : int_keys_) {
-            keys.reserve(n);
-        }
-        for (auto& keys : string_keys_) {
-            keys.reserve(n);
-        }
+        table_.reserve(n);
+        keys_.reserve(n);
     }
 
-private:
-    enum class PartKind : uint8_t { Int64, String };
-
-    class BatchView {
-    public:
-        BatchView(const CompositeKeyTable& storage, const std::vector<const core::Column*>& columns)
-            : storage_(storage),
-              columns_(columns),
-              dictionary_columns_(columns.size(), nullptr),
-              dictionary_hashes_(columns.size()) {
-            for (size_t i = 0; i < columns_.size(); ++i) {
-                if (storage_.part_kinds_[i] != PartKind::String) {
-                    continue;
-                }
-                dictionary_columns_[i] = core::AsDictionaryString(columns_[i]);
-                if (dictionary_columns_[i] == nullptr) {
-                    continue;
-                }
-                auto& hashes = dictionary_hashes_[i];
-                hashes.resize(dictionary_columns_[i]->DictSize());
-                for (uint32_t id = 0; id < hashes.size(); ++id) {
-                    hashes[id] =
-                        std::hash<std::string_view>{}(dictionary_columns_[i]->DictValue(id));
-                }
-            }
-        }
-
-        bool HasNull(size_t row) const {
-            for (auto* col : columns_) {
-                if (col->IsNull(row)) {
-                    return true;
-                }
-            }
-            return false;
-        }
-
-        size_t HashRow(size_t row) const noexcept {
-            size_t seed = storage_.part_kinds_.size();
-            for (size_t i = 0; i < storage_.part_kinds_.size(); ++i) {
-                if (storage_.part_kinds_[i] == PartKind::String) {
-                    size_t part_hash;
-                    if (dictionary_columns_[i] != nullptr) {
-                        part_hash = dictionary_hashes_[i][dictionary_columns_[i]->GetId(row)];
-                    } else {
-                        part_hash = std::hash<std::string_view>{}(ReadString(i, row));
-                    }
-                    group_key::HashCombine(seed, part_hash);
-                } else {
-                    group_key::HashCombine(seed, std::hash<int64_t>{}(ReadInt(i, row)));
-                }
-            }
-            return seed;
-        }
-
-        int64_t ReadInt(size_t key_index, size_t row) const {
-            return ReadIntegerRow(*columns_[key_index], row);
-        }
-
-        std::string_view ReadString(size_t key_index, size_t row) const {
-            if (dictionary_columns_[key_index] != nullptr) {
-                return dictionary_columns_[key_index]->Get(row);
-            }
-            return static_cast<const core::StringColumn&>(*columns_[key_index]).Get(row);
-        }
-
-    private:
-        const CompositeKeyTable& storage_;
-        const std::vector<const core::Column*>& columns_;
-        std::vector<const core::DictionaryStringColumn*> dictionary_columns_;
-        std::vector<std::vector<size_t>> dictionary_hashes_;
-    };
-
-    struct ProbeKey {
-        const BatchView* batch = nullptr;
-        size_t row = 0;
-        size_t hash = 0;
-    };
-
-    struct GroupHash {
-        using is_transparent = void;  // NOLINT(readability-identifier-naming)
-
-        const CompositeKeyTable* storage = nullptr;
-
-        size_t operator()(uint32_t group_id) const noexcept {
-            return storage->group_hashes_[group_id];
-        }
-
-        size_t operator()(const ProbeKey& key) const noexcept {
-            return key.hash;
-        }
-    };
-
-    struct GroupEq {
-        using is_transparent = void;  // NOLINT(readability-identifier-naming)
-
-        const CompositeKeyTable* storage = nullptr;
-
-        bool operator()(uint32_t lhs, uint32_t rhs) const noexcept {
-            return storage->GroupsEqual(lhs, rhs);
-        }
-
-        bool operator()(uint32_t lhs, const ProbeKey& rhs) const noexcept {
-            return storage->GroupEqualsProbe(lhs, rhs);
-        }
-
-        bool operator()(const ProbeKey& lhs, uint32_t rhs) const noexcept {
-            return storage->GroupEqualsProbe(rhs, lhs);
-        }
-
-        bool operator()(const ProbeKey& lhs, const ProbeKey& rhs) const noexcept {
-            return storage->ProbesEqual(lhs, rhs);
-        }
-    };
-
-    using Groups = absl::flat_hash_set<uint32_t, GroupHash, GroupEq>;
-
-    bool LookupGroup(const ProbeKey& key, uint32_t& group_id) const {
-        auto it = groups_.find(key);
-        if (it == groups_.end()) {
-            return false;
-        }
-        group_id = *it;
-        return true;
-    }
-
-    void InsertGroup(uint32_t group_id, const ProbeKey& key) {
-        assert(group_id == group_hashes_.size());
-        group_hashes_.push_back(key.hash);
-        for (size_t i = 0; i < part_kinds_.size(); ++i) {
-            if (part_kinds_[i] == PartKind::String) {
-                auto value = key.batch->ReadString(i, key.row);
-                string_keys_[i].push_back(arena_.Intern(value));
-            } else {
-                int_keys_[i].push_back(key.batch->ReadInt(i, key.row));
-            }
-        }
-        groups_.insert(group_id);
+    size_t MemoryUsage() const override {
+        return group_key::FlatTableBytes(table_) + group_key::VectorBytes(keys_);
     }
 
-    bool GroupsEqual(uint32_t lhs, uint32_t rhs) const noexcept {
-        if (group_hashes_[lhs] != group_hashes_[rhs]) {
-            return false;
-        }
-        for (size_t i = 0; i < part_kinds_.size(); ++i) {
-            if (part_kinds_[i] == PartKind::String) {
-                if (string_keys_[i][lhs] != string_keys_[i][rhs]) {
-                    return false;
-                }
-            } else if (int_keys_[i][lhs] != int_keys_[i][rhs]) {
-                return false;
-            }
-        }
-        return true;
-    }
+private:
+    using Key = group_key::HashedString;
 
-    bool GroupEqualsProbe(uint32_t group_id, const ProbeKey& key) const noexcept {
-        if (group_hashes_[group_id] != key.hash) {
-            return false;
-        }
-        for (size_t i = 0; i < part_kinds_.size(); ++i) {
-            if (part_kinds_[i] == PartKind::String) {
-                if (string_keys_[i][group_id] != key.batch->ReadString(i, key.row)) {
-                    return false;
-                }
-            } else if (int_keys_[i][group_id] != key.batch->ReadInt(i, key.row)) {
-                return false;
-            }
+    static std::string_view ReadString(const core::Column& col, size_t row) {
+        if (auto* dict = core::AsDictionaryString(&col)) {
+            return dict->Get(row);
         }
-        return true;
+        return static_cast<const core::StringColumn&>(col).Get(row);
     }
 
-    bool ProbesEqual(const ProbeKey& lhs, const ProbeKey& rhs) const noexcept {
-        if (lhs.hash != rhs.hash) {
-            return false;
-        }
-        for (size_t i = 0; i < part_kinds_.size(); ++i) {
-            if (part_kinds_[i] == PartKind::String) {
-                if (lhs.batch->ReadString(i, lhs.row) != rhs.batch->ReadString(i, rhs.row)) {
-                    return false;
+    // Writes the blob of every selected row into blobs_, row k spans
+    // [blob_offsets_[k], blob_offsets_[k + 1])
+    void SerializeRows(const std::vector<const core::Column*>& key_cols,
+                       const std::vector<uint32_t>* selection, size_t rows) {
+        size_t n = selection != nullptr ? selection->size() : rows;
+        is_null_.assign(n, 0);
+        blob_offsets_.assign(n + 1, 0);
+        for (size_t i = 0; i < layout_.parts.size(); ++i) {
+            const core::Column& col = *key_cols[i];
+            size_t k = 0;
+            ForSelectedRows(selection, rows, [&](size_t row) {
+                if (col.IsNull(row)) {
+                    is_null_[k] = 1;
+                } else if (layout_.parts[i].is_string) {
+                    blob_offsets_[k + 1] += sizeof(uint32_t) + ReadString(col, row).size();
                 }
-            } else if (lhs.batch->ReadInt(i, lhs.row) != rhs.batch->ReadInt(i, rhs.row)) {
-                return false;
+                ++k;
+            });
+        }
+        for (size_t k = 0; k < n; ++k) {
+            blob_offsets_[k + 1] += blob_offsets_[k] + layout_.fixed_width;
+        }
+        blobs_.resize(blob_offsets_[n]);
+
+        cursors_.assign(blob_offsets_.begin(), blob_offsets_.end() - 1);
+        auto* data = reinterpret_cast<uint8_t*>(blobs_.data());
+        for (size_t i = 0; i < layout_.parts.size(); ++i) {
+            const auto& part = layout_.parts[i];
+            const core::Column& col = *key_cols[i];
+            size_t k = 0;
+            if (part.is_string) {
+                ForSelectedRows(selection, rows, [&](size_t row) {
+                    if (!is_null_[k]) {
+                        auto value = ReadString(col, row);
+                        auto size = static_cast<uint32_t>(value.size());
+                        std::memcpy(data + cursors_[k], &size, sizeof(size));
+                        std::memcpy(data + cursors_[k] + sizeof(size), value.data(), size);
+                        cursors_[k] += sizeof(size) + size;
+                    }
+                    ++k;
+                });
+                continue;
             }
+            VisitIntegerCol(col, [&](const auto& typed) {
+                ForSelectedRows(selection, rows, [&](size_t row) {
+                    if (!is_null_[k]) {
+                        group_key::StoreInteger(static_cast<int64_t>(ReadTypedValue(typed, row)),
+                                                part.width, data + cursors_[k]);
+                        cursors_[k] += part.width;
+                    }
+                    ++k;
+                });
+            });
         }
-        return true;
     }
 
+    group_key::KeyLayout layout_;
     util::StringArena& arena_;
-    std::vector<PartKind> part_kinds_;
-    std::vector<std::vector<int64_t>> int_keys_;
-    std::vector<std::vector<std::string_view>> string_keys_;
-    std::vector<size_t> group_hashes_;
-    Groups groups_;
+    absl::flat_hash_map<Key, uint32_t, group_key::HashedStringHash> table_;
+    std::vector<std::string_view> keys_;
+    group_key::ProbeBatch<Key> probes_;
+    std::vector<uint8_t> is_null_;
+    std::vector<size_t> blob_offsets_;
+    std::vector<size_t> cursors_;
+    std::string blobs_;
 };
 }  // namespace
 
-std::unique_ptr<GroupKeyTable> MakeCompositeKeyTable(const std::vector<ProjectionUnit>& keys,
+std::unique_ptr<GroupKeyTable> MakeCompositeKeyTable(group_key::KeyLayout layout,
                                                      util::StringArena& arena) {
-    return std::make_unique<CompositeKeyTable>(keys, arena);
+    return std::make_unique<CompositeKeyTable>(std::move(layout), arena);
 }
 }  // namespace columnar::exec
@@ -0,0 +1,276 @@
+#include <core/batch.h>
+#include <core/columns/numeric_column.h>
+#include <exec/aggregation.h>
+#include <exec/column_dispatch.h>
+#include <exec/column_row_access.h>
+#include <exec/group_key_table.h>
+#include <exec/group_key_table/factories.h>
+#include <exec/group_key_table/memory.h>
+#include <exec/selection.h>
+#include <util/string_arena.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace columnar::exec {
+namespace {
+// Wider key ranges are grouped by the hashed fallback table
+constexpr uint64_t kMaxDenseSlots = uint64_t{1} << 18;
+
+// Integer keys whose combined value range is small are packed into one index of a direct-mapped
+// array of group ids. The range is tracked from the keys seen so far; once it outgrows
+// kMaxDenseSlots the groups are moved to the fallback table, which handles all later batches
+class DenseIntegerKeyTable final : public GroupKeyTable {
+public:
+    DenseIntegerKeyTable(size_t key_count, std::unique_ptr<GroupKeyTable> fallback)
+        : key_count_(key_count),
+          fallback_(std::move(fallback)),
+          values_(key_count),
+          mins_(key_count),
+          maxs_(key_count),
+          strides_(key_count) {
+    }
+
+    void FindGroups(const std::vector<const core::Column*>& key_cols,
+                    const std::vector<uint32_t>* selection, size_t rows, AggStateBuffer& state,
+                    std::vector<uint32_t>& group_ids) override {
+        if (hashed_) {
+            fallback_->FindGroups(key_cols, selection, rows, state, group_ids);
+            return;
+        }
+        GatherKeys(key_cols, selection, rows);
+        if (frozen_) {
+            LookupWindow(group_ids);
+            return;
+        }
+        if (!FitWindow()) {
+            MoveToFallback();
+            fallback_->FindGroups(key_cols, selection, rows, state, group_ids);
+            return;
+        }
+
+        size_t n = is_null_.size();
+        indexes_.assign(n, 0);
+        for (size_t i = 0; i < key_count_; ++i) {
+            const auto& values = values_[i];
+            uint64_t min = static_cast<uint64_t>(mins_[i]);
+            uint64_t stride = strides_[i];
+            for (size_t k = 0; k < n; ++k) {
+                indexes_[k] += (static_cast<uint64_t>(values[k]) - min) * stride;
+            }
+        }
+        for (size_t k = 0; k < n; ++k) {
+            if (is_null_[k]) {
+                group_ids.push_back(AggStateBuffer::kNoGroup);
+                continue;
+            }
+            uint32_t& slot = slots_[indexes_[k]];
+            if (slot == AggStateBuffer::kNoGroup) {
+                slot = state.EmplaceGroup();
+                for (size_t i = 0; i < key_count_; ++i) {
+                    keys_.push_back(values_[i][k]);
+                }
+            }
+            group_ids.push_back(slot);
+        }
+    }
+
+    void AppendKeys(uint32_t group_id, core::Batch& out) const override {
+        if (hashed_) {
+            fallback_->AppendKeys(group_id, out);
+            return;
+        }
+        for (size_t i = 0; i < key_count_; ++i) {
+            AppendInteger(out.ColumnAt(i), keys_[group_id * key_count_ + i]);
+        }
+    }
+
+    void ReserveBuckets(size_t n) override {
+        reserved_ = std::max(reserved_, n);
+        if (hashed_) {
+            fallback_->ReserveBuckets(n);
+        } else {
+            keys_.reserve(n * key_count_);
+        }
+    }
+
+    size_t MemoryUsage() const override {
+        return group_key::VectorBytes(slots_) + group_key::VectorBytes(keys_) +
+               fallback_->MemoryUsage();
+    }
+
+    std::optional<size_t> MaxNewGroupsForBatch(const std::vector<const core::Column*>& key_cols,
+                                               size_t selected_rows) const override {
+        if (hashed_) {
+            return fallback_->MaxNewGroupsForBatch(key_cols, selected_rows);
+        }
+        return std::nullopt;
+    }
+
+    void Freeze() override {
+        frozen_ = true;
+        fallback_->Freeze();
+    }
+
+private:
+    size_t GroupsCount() const {
+        return keys_.size() / key_count_;
+    }
+
+    void GatherKeys(const std::vector<const core::Column*>& key_cols,
+                    const std::vector<uint32_t>* selection, size_t rows) {
+        size_t n = selection != nullptr ? selection->size() : rows;
+        is_null_.assign(n, 0);
+        for (size_t i = 0; i < key_count_; ++i) {
+            auto& values = values_[i];
+            values.resize(n);
+            VisitIntegerCol(*key_cols[i], [&](const auto& typed) {
+                const util::BitVector* mask = typed.IsNullable() ? &typed.GetNullMask() : nullptr;
+                size_t k = 0;
+                ForSelectedRows(selection, rows, [&](size_t row) {
+                    values[k] = static_cast<int64_t>(ReadTypedValue(typed, row));
+                    if (mask != nullptr && mask->Get(row)) {
+                        is_null_[k] = 1;
+                    }
+                    ++k;
+                });
+            });
+        }
+    }
+
+    // Looks the gathered keys up without widening the window, keys outside of it have no group
+    void LookupWindow(std::vector<uint32_t>& group_ids) const {
+        for (size_t k = 0; k < is_null_.size(); ++k) {
+            uint32_t group_id = AggStateBuffer::kNoGroup;
+            if (!is_null_[k] && has_window_) {
+                bool inside = true;
+                uint64_t index = 0;
+                for (size_t i = 0; i < key_count_ && inside; ++i) {
+                    int64_t value = values_[i][k];
+                    inside = value >= mins_[i] && value <= maxs_[i];
+                    index += (static_cast<uint64_t>(value) - static_cast<uint64_t>(mins_[i])) *
+                             strides_[i];
+                }
+                if (inside) {
+                    group_id = slots_[index];
+                }
+            }
+            group_ids.push_back(group_id);
+        }
+    }
+
+    // Widens the window to cover the gathered keys. Returns false if the array would need more
+    // than kMaxDenseSlots slots
+    bool FitWindow() {
+        std::vector<int64_t> mins = mins_;
+        std::vector<int64_t> maxs = maxs_;
+        bool any = has_window_;
+        for (size_t k = 0; k < is_null_.size(); ++k) {
+            if (is_null_[k]) {
+                continue;
+            }
+            for (size_t i = 0; i < key_count_; ++i) {
+                int64_t value = values_[i][k];
+                if (!any) {
+                    mins[i] = value;
+                    maxs[i] = value;
+                } else {
+                    mins[i] = std::min(mins[i], value);
+                    maxs[i] = std::max(maxs[i], value);
+                }
+            }
+            any = true;
+        }
+        if (!any) {
+            return true;
+        }
+        if (has_window_ && mins == mins_ && maxs == maxs_) {
+            return true;
+        }
+
+        uint64_t slots = 1;
+        for (size_t i = 0; i < key_count_; ++i) {
+            uint64_t span = static_cast<uint64_t>(maxs[i]) - static_cast<uint64_t>(mins[i]);
+            if (span >= kMaxDenseSlots) {
+                return false;
+            }
+            slots *= span + 1;
+            if (slots > kMaxDenseSlots) {
+                return false;
+            }
+        }
+        Relayout(std::move(mins), std::move(maxs), slots);
+        return true;
+    }
+
+    void Relayout(std::vector<int64_t> mins, std::vector<int64_t> maxs, uint64_t slots) {
+        mins_ = std::move(mins);
+        maxs_ = std::move(maxs);
+        uint64_t stride = 1;
+        for (size_t i = key_count_; i-- > 0;) {
+            strides_[i] = stride;
+            stride *= static_cast<uint64_t>(maxs_[i]) - static_cast<uint64_t>(mins_[i]) + 1;
+        }
+        slots_.assign(slots, AggStateBuffer::kNoGroup);
+        for (size_t group_id = 0; group_id < GroupsCount(); ++group_id) {
+            uint64_t index = 0;
+            for (size_t i = 0; i < key_count_; ++i) {
+                index += (static_cast<uint64_t>(keys_[group_id * key_count_ + i]) -
+                          static_cast<uint64_t>(mins_[i])) *
+                         strides_[i];
+            }
+            slots_[index] = static_cast<uint32_t>(group_id);
+        }
+        has_window_ = true;
+    }
+
+    // Replays the existing groups in id order through the fallback table, so they keep their ids
+    void MoveToFallback() {
+        hashed_ = true;
+        size_t groups = GroupsCount();
+        fallback_->ReserveBuckets(std::max(reserved_, groups));
+        if (groups != 0) {
+            std::vector<core::Int64Column> columns(key_count_);
+            std::vector<const core::Column*> key_cols;
+            for (size_t i = 0; i < key_count_; ++i) {
+                columns[i].Reserve(groups);
+                for (size_t group_id = 0; group_id < groups; ++group_id) {
+                    columns[i].Append(keys_[group_id * key_count_ + i]);
+                }
+                key_cols.push_back(&columns[i]);
+            }
+            std::vector<AggregationUnit> no_aggregations;
+            util::StringArena arena;
+            AggStateBuffer replay(no_aggregations, arena);
+            std::vector<uint32_t> group_ids;
+            fallback_->FindGroups(key_cols, nullptr, groups, replay, group_ids);
+        }
+        std::vector<uint32_t>().swap(slots_);
+        std::vector<int64_t>().swap(keys_);
+    }
+
+    size_t key_count_;
+    std::unique_ptr<GroupKeyTable> fallback_;
+    bool hashed_ = false;
+    bool has_window_ = false;
+    size_t reserved_ = 0;
+    std::vector<std::vector<int64_t>> values_;
+    std::vector<uint8_t> is_null_;
+    std::vector<uint64_t> indexes_;
+    std::vector<int64_t> mins_;
+    std::vector<int64_t> maxs_;
+    std::vector<uint64_t> strides_;
+    std::vector<uint32_t> slots_;
+    std::vector<int64_t> keys_;
+};
+}  // namespace
+
+std::unique_ptr<GroupKeyTable> MakeDenseIntegerKeyTable(size_t key_count,
+                                                        std::unique_ptr<GroupKeyTable> fallback) {
+    return std::make_unique<DenseIntegerKeyTable>(key_count, std::move(fallback));
+}
+}  // namespace columnar::exec
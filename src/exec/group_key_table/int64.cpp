@@ -3,7 +3,8 @@
 #include <exec/column_row_access.h>
 #include <exec/group_key_table.h>
 #include <exec/group_key_table/factories.h>
-#include <exec/selection.h>
+#include <exec/group_key_table/memory.h>
+#include <exec/group_key_table/probe.h>
 
 #include <absl/container/flat_hash_map.h>
 
@@ -15,28 +16,28 @@ namespace columnar::exec {
 namespace {
 class Int64KeyTable final : public GroupKeyTable {
 public:
-    void Consume(const std::vector<const core::Column*>& key_cols,
-                 const std::vector<const core::Column*>& agg_cols,
-                 const std::vector<uint32_t>* selection, size_t rows,
-                 AggStateBuffer& state) override {
+    void FindGroups(const std::vector<const core::Column*>& key_cols,
+                    const std::vector<uint32_t>* selection, size_t rows, AggStateBuffer& state,
+                    std::vector<uint32_t>& group_ids) override {
         VisitIntegerCol(*key_cols[0], [&](const auto& typed) {
             const util::BitVector* mask = typed.IsNullable() ? &typed.GetNullMask() : nullptr;
-            ForSelectedRows(selection, rows, [&](size_t row) {
-                if (mask != nullptr && mask->Get(row)) {
-                    return;
-                }
-                int64_t key = static_cast<int64_t>(ReadTypedValue(typed, row));
-                auto it = table_.find(key);
-                uint32_t group_id;
-                if (it == table_.end()) {
-                    group_id = state.EmplaceGroup();
-                    table_.emplace(key, group_id);
-                    keys_.push_back(key);
-                } else {
-                    group_id = it->second;
-                }
-                state.OnRow(group_id, agg_cols, row);
-            });
+            group_key::GatherProbes(
+                selection, rows, group_ids, probes_,
+                [&](size_t row) { return mask != nullptr && mask->Get(row); },
+                [&](size_t row) { return static_cast<int64_t>(ReadTypedValue(typed, row)); });
+        });
+        group_key::ResolveProbes(table_, probes_, group_ids, [&](int64_t key) {
+            auto it = table_.find(key);
+            if (it != table_.end()) {
+                return it->second;
+            }
+            if (frozen_) {
+                return AggStateBuffer::kNoGroup;
+            }
+            uint32_t group_id = state.EmplaceGroup();
+            table_.emplace(key, group_id);
+            keys_.push_back(key);
+            return group_id;
         });
     }
 
@@ -49,9 +50,14 @@ public:
         keys_.reserve(n);
     }
 
+    size_t MemoryUsage() const override {
+        return group_key::FlatTableBytes(table_) + group_key::VectorBytes(keys_);
+    }
+
 private:
     absl::flat_hash_map<int64_t, uint32_t> table_;
     std::vector<int64_t> keys_;
+    group_key::ProbeBatch<int64_t> probes_;
 };
 }  // namespace
 
@@ -6,7 +6,8 @@
 #include <exec/group_key_table.h>
 #include <exec/group_key_table/factories.h>
 #include <exec/group_key_table/hash.h>
-#include <exec/selection.h>
+#include <exec/group_key_table/memory.h>
+#include <exec/group_key_table/probe.h>
 #include <util/string_arena.h>
 
 #include <absl/container/flat_hash_set.h>
@@ -26,10 +27,9 @@ public:
         : arena_(arena), groups_(0, GroupHash{this}, GroupEq{this}) {
     }
 
-    void Consume(const std::vector<const core::Column*>& key_cols,
-                 const std::vector<const core::Column*>& agg_cols,
-                 const std::vector<uint32_t>* selection, size_t rows,
-                 AggStateBuffer& state) override {
+    void FindGroups(const std::vector<const core::Column*>& key_cols,
+                    const std::vector<uint32_t>* selection, size_t rows, AggStateBuffer& state,
+                    std::vector<uint32_t>& group_ids) override {
         VisitIntegerCol(*key_cols[0], [&](const auto& first_typed) {
             VisitIntegerCol(*key_cols[1], [&](const auto& second_typed) {
                 const util::BitVector* first_mask =
@@ -48,36 +48,42 @@ public:
                     }
                 }
 
-                ForSelectedRows(selection, rows, [&](size_t row) {
-                    if ((first_mask != nullptr && first_mask->Get(row)) ||
-                        (second_mask != nullptr && second_mask->Get(row)) ||
-                        key_cols[2]->IsNull(row)) {
-                        return;
-                    }
-                    int64_t first = static_cast<int64_t>(ReadTypedValue(first_typed, row));
-                    int64_t second = static_cast<int64_t>(ReadTypedValue(second_typed, row));
-                    std::string_view third;
-                    size_t third_hash;
-                    if (dict != nullptr) {
-                        uint32_t id = dict->GetId(row);
-                        third = dict->DictValue(id);
-                        third_hash = dict_hashes[id];
-                    } else {
-                        third = strings->Get(row);
-                        third_hash = std::hash<std::string_view>{}(third);
-                    }
-
-                    ProbeKey probe{first, second, third,
-                                   group_key::HashIntIntString(first, second, third_hash)};
-                    uint32_t group_id;
-                    if (!LookupGroup(probe, group_id)) {
-                        group_id = state.EmplaceGroup();
-                        InsertGroup(group_id, probe);
-                    }
-                    state.OnRow(group_id, agg_cols, row);
-                });
+                group_key::GatherProbes(
+                    selection, rows, group_ids, probes_,
+                    [&](size_t row) {
+                        return (first_mask != nullptr && first_mask->Get(row)) ||
+                               (second_mask != nullptr && second_mask->Get(row)) ||
+                               key_cols[2]->IsNull(row);
+                    },
+                    [&](size_t row) {
+                        int64_t first = static_cast<int64_t>(ReadTypedValue(first_typed, row));
+                        int64_t second = static_cast<int64_t>(ReadTypedValue(second_typed, row));
+                        std::string_view third;
+                        size_t third_hash;
+                        if (dict != nullptr) {
+                            uint32_t id = dict->GetId(row);
+                            third = dict->DictValue(id);
+                            third_hash = dict_hashes[id];
+                        } else {
+                            third = strings->Get(row);
+                            third_hash = std::hash<std::string_view>{}(third);
+                        }
+                        return ProbeKey{first, second, third,
+                                        group_key::HashIntIntString(first, second, third_hash)};
+                    });
             });
         });
+        group_key::ResolveProbes(groups_, probes_, group_ids, [&](const ProbeKey& probe) {
+            uint32_t group_id;
+            if (!LookupGroup(probe, group_id)) {
+                if (frozen_) {
+                    return AggStateBuffer::kNoGroup;
+                }
+                group_id = state.EmplaceGroup();
+                InsertGroup(group_id, probe);
+            }
+            return group_id;
+        });
     }
 
     void AppendKeys(uint32_t group_id, core::Batch& out) const override {
@@ -93,6 +99,11 @@ public:
         keys_.reserve(n);
     }
 
+    size_t MemoryUsage() const override {
+        return group_key::FlatTableBytes(groups_) + group_key::VectorBytes(hashes_) +
+               group_key::VectorBytes(keys_);
+    }
+
 private:
     struct Key {
         int64_t first = 0;
@@ -171,6 +182,7 @@ private:
     std::vector<size_t> hashes_;
     std::vector<Key> keys_;
     Groups groups_;
+    group_key::ProbeBatch<ProbeKey> probes_;
 };
 }  // namespace
 
@@ -6,7 +6,8 @@
 #include <exec/group_key_table.h>
 #include <exec/group_key_table/factories.h>
 #include <exec/group_key_table/hash.h>
-#include <exec/selection.h>
+#include <exec/group_key_table/memory.h>
+#include <exec/group_key_table/probe.h>
 #include <util/string_arena.h>
 
 #include <absl/container/flat_hash_set.h>
@@ -26,10 +27,9 @@ public:
         : arena_(arena), groups_(0, GroupHash{this}, GroupEq{this}) {
     }
 
-    void Consume(const std::vector<const core::Column*>& key_cols,
-                 const std::vector<const core::Column*>& agg_cols,
-                 const std::vector<uint32_t>* selection, size_t rows,
-                 AggStateBuffer& state) override {
+    void FindGroups(const std::vector<const core::Column*>& key_cols,
+                    const std::vector<uint32_t>* selection, size_t rows, AggStateBuffer& state,
+                    std::vector<uint32_t>& group_ids) override {
         VisitIntegerCol(*key_cols[0], [&](const auto& first_typed) {
             const util::BitVector* first_mask =
                 first_typed.IsNullable() ? &first_typed.GetNullMask() : nullptr;
@@ -44,30 +44,37 @@ public:
                 }
             }
 
-            ForSelectedRows(selection, rows, [&](size_t row) {
-                if ((first_mask != nullptr && first_mask->Get(row)) || key_cols[1]->IsNull(row)) {
-                    return;
-                }
-                int64_t first = static_cast<int64_t>(ReadTypedValue(first_typed, row));
-                std::string_view second;
-                size_t second_hash;
-                if (dict != nullptr) {
-                    uint32_t id = dict->GetId(row);
-                    second = dict->DictValue(id);
-                    second_hash = dict_hashes[id];
-                } else {
-                    second = strings->Get(row);
-                    second_hash = std::hash<std::string_view>{}(second);
-                }
-
-                ProbeKey probe{first, second, group_key::HashIntString(first, second_hash)};
-                uint32_t group_id;
-                if (!LookupGroup(probe, group_id)) {
-                    group_id = state.EmplaceGroup();
-                    InsertGroup(group_id, probe);
+            group_key::GatherProbes(
+                selection, rows, group_ids, probes_,
+                [&](size_t row) {
+                    return (first_mask != nullptr && first_mask->Get(row)) ||
+                           key_cols[1]->IsNull(row);
+                },
+                [&](size_t row) {
+                    int64_t first = static_cast<int64_t>(ReadTypedValue(first_typed, row));
+                    std::string_view second;
+                    size_t second_hash;
+                    if (dict != nullptr) {
+                        uint32_t id = dict->GetId(row);
+                        second = dict->DictValue(id);
+                        second_hash = dict_hashes[id];
+                    } else {
+                        second = strings->Get(row);
+                        second_hash = std::hash<std::string_view>{}(second);
+                    }
+                    return ProbeKey{first, second, group_key::HashIntString(first, second_hash)};
+                });
+        });
+        group_key::ResolveProbes(groups_, probes_, group_ids, [&](const ProbeKey& probe) {
+            uint32_t group_id;
+            if (!LookupGroup(probe, group_id)) {
+                if (frozen_) {
+                    return AggStateBuffer::kNoGroup;
                 }
-                state.OnRow(group_id, agg_cols, row);
-            });
+                group_id = state.EmplaceGroup();
+                InsertGroup(group_id, probe);
+            }
+            return group_id;
         });
     }
 
@@ -83,6 +90,11 @@ public:
         keys_.reserve(n);
     }
 
+    size_t MemoryUsage() const override {
+        return group_key::FlatTableBytes(groups_) + group_key::VectorBytes(hashes_) +
+               group_key::VectorBytes(keys_);
+    }
+
 private:
     struct Key {
         int64_t first = 0;
@@ -158,6 +170,7 @@ private:
     std::vector<size_t> hashes_;
     std::vector<Key> keys_;
     Groups groups_;
+    group_key::ProbeBatch<ProbeKey> probes_;
 };
 }  // namespace
 
@@ -0,0 +1,45 @@
+#include <exec/group_key_table/key_layout.h>
+
+#include <core/datatype.h>
+#include <exec/expression/eval.h>
+#include <util/macro.h>
+
+namespace columnar::exec::group_key {
+namespace {
+size_t IntegerWidth(core::DataType type) {
+    switch (core::DataTypeToPhysical(type)) {
+        case core::PhysicalType::Int16:
+            return sizeof(int16_t);
+        case core::PhysicalType::Int32:
+            return sizeof(int32_t);
+        case core::PhysicalType::Int64:
+            return sizeof(int64_t);
+        case core::PhysicalType::Bool:
+        case core::PhysicalType::Char:
+            return 1;
+        default:
+            break;
+    }
+    THROW_RUNTIME_ERROR("GROUP BY key must be integer, string, timestamp, or date");
+}
+}  // namespace
+
+KeyLayout MakeKeyLayout(const std::vector<ProjectionUnit>& keys) {
+    KeyLayout layout;
+    layout.parts.reserve(keys.size());
+    for (auto& key : keys) {
+        KeyPart part;
+        auto type = GetExpressionType(*key.expression);
+        if (type == core::DataType::String) {
+            part.is_string = true;
+            layout.has_strings = true;
+        } else {
+            part.width = IntegerWidth(type);
+            part.offset = layout.fixed_width;
+            layout.fixed_width += part.width;
+        }
+        layout.parts.push_back(part);
+    }
+    return layout;
+}
+}  // namespace columnar::exec::group_key
@@ -0,0 +1,119 @@
+#include <core/batch.h>
+#include <exec/column_dispatch.h>
+#include <exec/column_row_access.h>
+#include <exec/group_key_table.h>
+#include <exec/group_key_table/factories.h>
+#include <exec/group_key_table/key_layout.h>
+#include <exec/group_key_table/memory.h>
+#include <exec/group_key_table/probe.h>
+#include <exec/selection.h>
+#include <util/macro.h>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace columnar::exec {
+namespace {
+// Groups integer-only keys packed by their KeyLayout into kWords words
+template <size_t kWords>
+class PackedKeyTable final : public GroupKeyTable {
+public:
+    explicit PackedKeyTable(group_key::KeyLayout layout) : layout_(std::move(layout)) {
+    }
+
+    void FindGroups(const std::vector<const core::Column*>& key_cols,
+                    const std::vector<uint32_t>* selection, size_t rows, AggStateBuffer& state,
+                    std::vector<uint32_t>& group_ids) override {
+        // Keys are packed column by column, then the rows with a NULL part are dropped
+        size_t n = selection != nullptr ? selection->size() : rows;
+        auto& keys = probes_.keys;
+        keys.assign(n, Key{});
+        is_null_.assign(n, 0);
+        for (size_t i = 0; i < layout_.parts.size(); ++i) {
+            const auto& part = layout_.parts[i];
+            VisitIntegerCol(*key_cols[i], [&](const auto& typed) {
+                const util::BitVector* mask = typed.IsNullable() ? &typed.GetNullMask() : nullptr;
+                size_t k = 0;
+                ForSelectedRows(selection, rows, [&](size_t row) {
+                    group_key::StoreInteger(static_cast<int64_t>(ReadTypedValue(typed, row)),
+                                            part.width, keys[k].Bytes() + part.offset);
+                    if (mask != nullptr && mask->Get(row)) {
+                        is_null_[k] = 1;
+                    }
+                    ++k;
+                });
+            });
+        }
+
+        size_t first_slot = group_ids.size();
+        group_ids.resize(first_slot + n, AggStateBuffer::kNoGroup);
+        probes_.slots.clear();
+        size_t kept = 0;
+        for (size_t k = 0; k < n; ++k) {
+            if (!is_null_[k]) {
+                keys[kept++] = keys[k];
+                probes_.slots.push_back(static_cast<uint32_t>(first_slot + k));
+            }
+        }
+        keys.resize(kept);
+
+        group_key::ResolveProbes(table_, probes_, group_ids, [&](const Key& key) {
+            auto it = table_.find(key);
+            if (it != table_.end()) {
+                return it->second;
+            }
+            if (frozen_) {
+                return AggStateBuffer::kNoGroup;
+            }
+            uint32_t group_id = state.EmplaceGroup();
+            table_.emplace(key, group_id);
+            keys_.push_back(key);
+            return group_id;
+        });
+    }
+
+    void AppendKeys(uint32_t group_id, core::Batch& out) const override {
+        const uint8_t* bytes = keys_[group_id].Bytes();
+        for (size_t i = 0; i < layout_.parts.size(); ++i) {
+            const auto& part = layout_.parts[i];
+            AppendInteger(out.ColumnAt(i), group_key::LoadInteger(bytes + part.offset, part.width));
+        }
+    }
+
+    void ReserveBuckets(size_t n) override {
+        table_.reserve(n);
+        keys_.reserve(n);
+    }
+
+    size_t MemoryUsage() const override {
+        return group_key::FlatTableBytes(table_) + group_key::VectorBytes(keys_);
+    }
+
+private:
+    using Key = group_key::PackedKey<kWords>;
+
+    group_key::KeyLayout layout_;
+    absl::flat_hash_map<Key, uint32_t> table_;
+    std::vector<Key> keys_;
+    group_key::ProbeBatch<Key> probes_;
+    std::vector<uint8_t> is_null_;
+};
+}  // namespace
+
+std::unique_ptr<GroupKeyTable> MakePackedKeyTable(group_key::KeyLayout layout) {
+    if (layout.has_strings || layout.fixed_width > group_key::kMaxPackedKeyBytes) {
+        THROW_RUNTIME_ERROR("Group key does not fit a packed key");
+    }
+    if (layout.fixed_width <= 8) {
+        return std::make_unique<PackedKeyTable<1>>(std::move(layout));
+    }
+    if (layout.fixed_width <= 16) {
+        return std::make_unique<PackedKeyTable<2>>(std::move(layout));
+    }
+    return std::make_unique<PackedKeyTable<4>>(std::move(layout));
+}
+}  // namespace columnar::exec
@@ -3,11 +3,12 @@
 #include <core/columns/string_column.h>
 #include <exec/group_key_table.h>
 #include <exec/group_key_table/factories.h>
+#include <exec/group_key_table/memory.h>
+#include <exec/group_key_table/probe.h>
+#include <exec/group_key_table/string_hash_map.h>
 #include <exec/selection.h>
 #include <util/string_arena.h>
 
-#include <absl/container/flat_hash_map.h>
-
 #include <algorithm>
 #include <cstdint>
 #include <limits>
@@ -23,32 +24,19 @@ public:
     explicit StringKeyTable(util::StringArena& arena) : arena_(arena) {
     }
 
-    void Consume(const std::vector<const core::Column*>& key_cols,
-                 const std::vector<const core::Column*>& agg_cols,
-                 const std::vector<uint32_t>* selection, size_t rows,
-                 AggStateBuffer& state) override {
+    void FindGroups(const std::vector<const core::Column*>& key_cols,
+                    const std::vector<uint32_t>* selection, size_t rows, AggStateBuffer& state,
+                    std::vector<uint32_t>& group_ids) override {
         if (auto* dict = core::AsDictionaryString(key_cols[0])) {
-            ConsumeDictionary(*dict, agg_cols, selection, rows, state);
+            FindDictionaryGroups(*dict, selection, rows, state, group_ids);
             return;
         }
         auto& s = static_cast<const core::StringColumn&>(*key_cols[0]);
-        ForSelectedRows(selection, rows, [&](size_t row) {
-            if (s.IsNull(row)) {
-                return;
-            }
-            auto key = s.Get(row);
-            uint32_t group_id;
-            auto it = table_.find(key);
-            if (it == table_.end()) {
-                auto interned = arena_.Intern(key);
-                group_id = state.EmplaceGroup();
-                table_.emplace(interned, group_id);
-                keys_.push_back(interned);
-            } else {
-                group_id = it->second;
-            }
-            state.OnRow(group_id, agg_cols, row);
-        });
+        group_key::GatherProbes(
+            selection, rows, group_ids, probes_, [&](size_t row) { return s.IsNull(row); },
+            [&](size_t row) { return Map::MakeProbe(s.Get(row)); });
+        group_key::ResolveProbes(table_, probes_, group_ids,
+                                 [&](const Key& key) { return FindOrInsert(key, state); });
     }
 
     void AppendKeys(uint32_t group_id, core::Batch& out) const override {
@@ -56,10 +44,14 @@ public:
     }
 
     void ReserveBuckets(size_t n) override {
-        table_.reserve(n);
+        table_.Reserve(n);
         keys_.reserve(n);
     }
 
+    size_t MemoryUsage() const override {
+        return table_.MemoryUsage() + group_key::VectorBytes(keys_);
+    }
+
     std::optional<size_t> MaxNewGroupsForBatch(const std::vector<const core::Column*>& key_cols,
                                                size_t selected_rows) const override {
         if (auto* dict = core::AsDictionaryString(key_cols[0])) {
@@ -69,43 +61,52 @@ public:
     }
 
 private:
-    void ConsumeDictionary(const core::DictionaryStringColumn& key_col,
-                           const std::vector<const core::Column*>& agg_cols,
-                           const std::vector<uint32_t>* selection, size_t rows,
-                           AggStateBuffer& state) {
+    using Map = group_key::StringHashMap<uint32_t>;
+    using Key = Map::Probe;
+
+    void FindDictionaryGroups(const core::DictionaryStringColumn& key_col,
+                              const std::vector<uint32_t>* selection, size_t rows,
+                              AggStateBuffer& state, std::vector<uint32_t>& group_ids) {
         constexpr uint32_t kUnknownGroup = std::numeric_limits<uint32_t>::max();
         std::vector<uint32_t> id_to_group(key_col.DictSize(), kUnknownGroup);
 
         auto resolve_group = [&](uint32_t local_id) {
             uint32_t group_id = id_to_group[local_id];
-            if (group_id != kUnknownGroup) {
-                return group_id;
+            if (group_id == kUnknownGroup) {
+                group_id =
+                    FindOrInsert(Map::MakeProbe(key_col.DictValue(local_id)), state);
+                id_to_group[local_id] = group_id;
             }
-            auto key = key_col.DictValue(local_id);
-            auto it = table_.find(key);
-            if (it == table_.end()) {
-                auto interned = arena_.Intern(key);
-                group_id = state.EmplaceGroup();
-                table_.emplace(interned, group_id);
-                keys_.push_back(interned);
-            } else {
-                group_id = it->second;
-            }
-            id_to_group[local_id] = group_id;
             return group_id;
         };
 
         ForSelectedRows(selection, rows, [&](size_t row) {
             if (key_col.IsNull(row)) {
+                group_ids.push_back(AggStateBuffer::kNoGroup);
                 return;
             }
-            state.OnRow(resolve_group(key_col.GetId(row)), agg_cols, row);
+            group_ids.push_back(resolve_group(key_col.GetId(row)));
         });
     }
 
+    uint32_t FindOrInsert(const Key& key, AggStateBuffer& state) {
+        if (const uint32_t* group_id = table_.Find(key)) {
+            return *group_id;
+        }
+        if (frozen_) {
+            return AggStateBuffer::kNoGroup;
+        }
+        auto interned = arena_.Intern(key.value);
+        uint32_t group_id = state.EmplaceGroup();
+        table_.Insert(key, interned, group_id);
+        keys_.push_back(interned);
+        return group_id;
+    }
+
     util::StringArena& arena_;
-    absl::flat_hash_map<std::string_view, uint32_t> table_;
+    Map table_;
     std::vector<std::string_view> keys_;
+    group_key::ProbeBatch<Key> probes_;
 };
 }  // namespace
 
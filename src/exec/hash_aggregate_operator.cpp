@@ -5,16 +5,23 @@
 #include <exec/column_dispatch.h>
 #include <exec/expression/types.h>
 #include <exec/expression/eval.h>
-#include <exec/expression/utils.h>
-#include <exec/kernel.h>
 #include <util/macro.h>
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 namespace columnar::exec {
 namespace {
+// Groups are written to and read from spill files this many at a time
+constexpr size_t kSpillChunkGroups = 4096;
+constexpr size_t kSpilledOutputBatchRows = 65536;
 core::DataType KeyOutputType(const Expression& expr) {
     auto type = GetExpressionType(expr);
     if (type == core::DataType::String || type == core::DataType::Timestamp ||
@@ -26,6 +33,7 @@ core::DataType KeyOutputType(const Expression& expr) {
     }
     THROW_RUNTIME_ERROR("GROUP BY key must be integer, string, timestamp, or date");
 }
+}  // namespace
 
 core::Schema MakeHashAggregateSchema(const std::vector<ProjectionUnit>& keys,
                                      const std::vector<AggregationUnit>& aggregations) {
@@ -40,17 +48,28 @@ core::Schema MakeHashAggregateSchema(const std::vector<ProjectionUnit>& keys,
     }
     return core::Schema(std::move(fields));
 }
+
+namespace {
+core::Schema MakeKeySchema(const core::Schema& output_schema, size_t keys_count) {
+    const auto& fields = output_schema.GetFields();
+    return core::Schema(std::vector<core::Field>(fields.begin(), fields.begin() + keys_count));
+}
 }  // namespace
 
 HashAggregationSink::HashAggregationSink(IOperator& downstream, std::vector<ProjectionUnit> keys,
-                                         std::vector<AggregationUnit> aggregations)
+                                         std::vector<AggregationUnit> aggregations,
+                                         HashAggregationOptions options)
     : downstream_(downstream),
       keys_(std::move(keys)),
       aggregations_(std::move(aggregations)),
+      options_(std::move(options)),
       output_schema_(MakeHashAggregateSchema(keys_, aggregations_)),
-      needs_dense_(RequiresDenseBatch(keys_) || RequiresDenseBatch(aggregations_)),
-      state_(aggregations_, string_arena_),
+      key_schema_(MakeKeySchema(output_schema_, keys_.size())),
+      state_(std::make_unique<AggStateBuffer>(aggregations_, string_arena_)),
       key_table_(GroupKeyTable::Make(keys_, string_arena_)) {
+    if (options_.memory_budget != 0 && options_.spill_partitions == 0) {
+        THROW_RUNTIME_ERROR("HashAggregation needs at least one spill partition");
+    }
 }
 
 void HashAggregationSink::ReserveForBatch(size_t selected_rows, size_t max_new_groups) {
@@ -60,7 +79,7 @@ void HashAggregationSink::ReserveForBatch(size_t selected_rows, size_t max_new_g
 
     size_t expected_new_groups = max_new_groups;
     if (input_rows_seen_ != 0) {
-        long double groups_per_row = static_cast<long double>(state_.GroupsCount()) /
+        long double groups_per_row = static_cast<long double>(state_->GroupsCount()) /
                                      static_cast<long double>(input_rows_seen_);
         expected_new_groups =
             static_cast<size_t>(static_cast<long double>(selected_rows) * groups_per_row * 1.25L) +
@@ -68,7 +87,7 @@ void HashAggregationSink::ReserveForBatch(size_t selected_rows, size_t max_new_g
         expected_new_groups = std::min(expected_new_groups, max_new_groups);
     }
 
-    size_t target_groups = static_cast<size_t>(state_.GroupsCount()) + expected_new_groups;
+    size_t target_groups = static_cast<size_t>(state_->GroupsCount()) + expected_new_groups;
     if (target_groups <= reserved_groups_) {
         return;
     }
@@ -82,7 +101,7 @@ void HashAggregationSink::ReserveForBatch(size_t selected_rows, size_t max_new_g
     }
 
     reserved_groups_ = reserve_groups;
-    state_.Reserve(reserve_groups);
+    state_->Reserve(reserve_groups);
     key_table_->ReserveBuckets(reserve_groups);
 }
 
@@ -91,10 +110,6 @@ void HashAggregationSink::Consume(core::Batch batch) {
     if (rows == 0) {
         return;
     }
-    if (batch.HasSelection() && needs_dense_) {
-        batch = kernel::Materialize(batch);
-        rows = batch.RowsCount();
-    }
     size_t selected_rows = batch.SelectedRowsCount();
 
     std::vector<EvalResult> key_evals;
@@ -122,19 +137,196 @@ void HashAggregationSink::Consume(core::Batch batch) {
     }
 
     const std::vector<uint32_t>* selection = batch.HasSelection() ? &batch.Selection() : nullptr;
-    key_table_->Consume(key_cols, agg_cols, selection, rows, state_);
+    group_ids_.clear();
+    group_ids_.reserve(selected_rows);
+    key_table_->FindGroups(key_cols, selection, rows, *state_, group_ids_);
+    state_->Update(group_ids_, agg_cols, selection);
     input_rows_seen_ += selected_rows;
+
+    if (options_.memory_budget != 0 && MemoryUsage() > options_.memory_budget) {
+        SpillGeneration();
+    }
+}
+
+size_t HashAggregationSink::MemoryUsage() const {
+    return key_table_->MemoryUsage() + state_->MemoryUsage() + string_arena_.BytesReserved();
+}
+
+void HashAggregationSink::SpillGeneration() {
+    if (partitions_.empty()) {
+        for (size_t i = 0; i < options_.spill_partitions; ++i) {
+            partitions_.push_back(std::make_unique<SpillFile>(options_.spill_directory));
+        }
+    }
+
+    // Record: [u32 key size][encoded keys][u64 first seen][partial states]
+    std::vector<uint8_t> record;
+    uint32_t groups = state_->GroupsCount();
+    for (uint32_t begin = 0; begin < groups; begin += kSpillChunkGroups) {
+        uint32_t end = std::min<uint32_t>(groups, begin + kSpillChunkGroups);
+        core::Batch key_batch(key_schema_, end - begin);
+        for (uint32_t group_id = begin; group_id < end; ++group_id) {
+            key_table_->AppendKeys(group_id, key_batch);
+        }
+        for (uint32_t group_id = begin; group_id < end; ++group_id) {
+            record.clear();
+            util::BufWriter w(record);
+            w.Write<uint32_t>(0);
+            for (size_t i = 0; i < keys_.size(); ++i) {
+                EncodeValue(key_batch.ColumnAt(i), group_id - begin, w);
+            }
+            auto key_size = static_cast<uint32_t>(record.size() - sizeof(uint32_t));
+            std::memcpy(record.data(), &key_size, sizeof(key_size));
+            w.Write<uint64_t>((static_cast<uint64_t>(generation_) << 32) | group_id);
+            state_->SerializeGroup(group_id, w);
+
+            std::string_view key(reinterpret_cast<const char*>(record.data()) + sizeof(uint32_t),
+                                 key_size);
+            partitions_[std::hash<std::string_view>{}(key) % partitions_.size()]->Append(record);
+        }
+    }
+
+    key_table_.reset();
+    state_.reset();
+    string_arena_.Reset();
+    state_ = std::make_unique<AggStateBuffer>(aggregations_, string_arena_);
+    key_table_ = GroupKeyTable::Make(keys_, string_arena_);
+    reserved_groups_ = 0;
+    ++generation_;
+}
+
+void HashAggregationSink::MergePartition(SpillFile& partition, SpillFile& run) const {
+    util::StringArena arena;
+    AggStateBuffer state(aggregations_, arena);
+    auto key_table = GroupKeyTable::Make(keys_, arena);
+    std::vector<uint64_t> first_seen;
+    std::vector<uint32_t> group_ids;
+    std::vector<const core::Column*> key_cols(keys_.size());
+
+    partition.Rewind();
+    std::vector<std::vector<uint8_t>> records(kSpillChunkGroups);
+    while (true) {
+        size_t n = 0;
+        while (n < records.size() && partition.Next(records[n])) {
+            ++n;
+        }
+        if (n == 0) {
+            break;
+        }
+        core::Batch key_batch(key_schema_, n);
+        std::vector<size_t> states_offsets(n);
+        for (size_t k = 0; k < n; ++k) {
+            util::BufReader r(records[k].data(), records[k].size());
+            r.Read<uint32_t>();
+            for (size_t i = 0; i < keys_.size(); ++i) {
+                DecodeValue(r, key_batch.ColumnAt(i));
+            }
+            states_offsets[k] = static_cast<size_t>(r.Pos() - records[k].data());
+        }
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            key_cols[i] = &key_batch.ColumnAt(i);
+        }
+        group_ids.clear();
+        key_table->FindGroups(key_cols, nullptr, n, state, group_ids);
+        first_seen.resize(state.GroupsCount(), std::numeric_limits<uint64_t>::max());
+        for (size_t k = 0; k < n; ++k) {
+            util::BufReader r(records[k].data() + states_offsets[k],
+                              records[k].size() - states_offsets[k]);
+            uint32_t group_id = group_ids[k];
+            first_seen[group_id] = std::min(first_seen[group_id], r.Read<uint64_t>());
+            state.MergeGroup(group_id, r);
+        }
+    }
+
+    std::vector<uint32_t> order(state.GroupsCount());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t lhs, uint32_t rhs) { return first_seen[lhs] < first_seen[rhs]; });
+
+    // Record: [u64 first seen][encoded output row]
+    std::vector<uint8_t> record;
+    for (size_t begin = 0; begin < order.size(); begin += kSpillChunkGroups) {
+        size_t end = std::min(order.size(), begin + kSpillChunkGroups);
+        core::Batch out(output_schema_, end - begin);
+        for (size_t k = begin; k < end; ++k) {
+            key_table->AppendKeys(order[k], out);
+            for (size_t i = 0; i < aggregations_.size(); ++i) {
+                state.AppendResult(i, order[k], out.ColumnAt(keys_.size() + i));
+            }
+        }
+        for (size_t k = begin; k < end; ++k) {
+            record.clear();
+            util::BufWriter w(record);
+            w.Write<uint64_t>(first_seen[order[k]]);
+            for (size_t i = 0; i < output_schema_.GetFields().size(); ++i) {
+                EncodeValue(out.ColumnAt(i), k - begin, w);
+            }
+            run.Append(record);
+        }
+    }
+    run.Rewind();
+}
+
+void HashAggregationSink::EmitRuns(std::vector<std::unique_ptr<SpillFile>>& runs) {
+    using Head = std::pair<uint64_t, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    std::vector<std::vector<uint8_t>> records(runs.size());
+    auto advance = [&](size_t run) {
+        if (runs[run]->Next(records[run])) {
+            util::BufReader r(records[run].data(), records[run].size());
+            heads.emplace(r.Read<uint64_t>(), run);
+        }
+    };
+    for (size_t run = 0; run < runs.size(); ++run) {
+        advance(run);
+    }
+
+    size_t columns = output_schema_.GetFields().size();
+    bool emitted = false;
+    core::Batch out(output_schema_, kSpilledOutputBatchRows);
+    while (!heads.empty() && !downstream_.Done()) {
+        size_t run = heads.top().second;
+        heads.pop();
+        util::BufReader r(records[run].data(), records[run].size());
+        r.Read<uint64_t>();
+        for (size_t i = 0; i < columns; ++i) {
+            DecodeValue(r, out.ColumnAt(i));
+        }
+        advance(run);
+        if (out.RowsCount() == kSpilledOutputBatchRows) {
+            downstream_.Consume(std::move(out));
+            out = core::Batch(output_schema_, kSpilledOutputBatchRows);
+            emitted = true;
+        }
+    }
+    if (out.RowsCount() != 0 || !emitted) {
+        downstream_.Consume(std::move(out));
+    }
 }
 
 void HashAggregationSink::Finalize() {
-    core::Batch out(output_schema_, state_.GroupsCount());
-    for (uint32_t group_id = 0; group_id < state_.GroupsCount(); ++group_id) {
-        key_table_->AppendKeys(group_id, out);
-        for (size_t i = 0; i < aggregations_.size(); ++i) {
-            state_.AppendResult(i, group_id, out.ColumnAt(keys_.size() + i));
+    if (partitions_.empty()) {
+        core::Batch out(output_schema_, state_->GroupsCount());
+        for (uint32_t group_id = 0; group_id < state_->GroupsCount(); ++group_id) {
+            key_table_->AppendKeys(group_id, out);
+            for (size_t i = 0; i < aggregations_.size(); ++i) {
+                state_->AppendResult(i, group_id, out.ColumnAt(keys_.size() + i));
+            }
         }
+        downstream_.Consume(std::move(out));
+        downstream_.Finalize();
+        return;
+    }
+
+    SpillGeneration();
+    std::vector<std::unique_ptr<SpillFile>> runs;
+    for (auto& partition : partitions_) {
+        runs.push_back(std::make_unique<SpillFile>(options_.spill_directory));
+        MergePartition(*partition, *runs.back());
+        partition.reset();
     }
-    downstream_.Consume(std::move(out));
+    partitions_.clear();
+    EmitRuns(runs);
     downstream_.Finalize();
 }
 }  // namespace columnar::exec
@@ -0,0 +1,222 @@
+#include <exec/hash_join_operator.h>
+
+#include <core/datatype.h>
+#include <core/field.h>
+#include <exec/column_dispatch.h>
+#include <exec/column_row_access.h>
+#include <exec/expression/eval.h>
+#include <exec/selection.h>
+#include <util/macro.h>
+
+#include <limits>
+#include <utility>
+
+namespace columnar::exec {
+namespace {
+constexpr uint32_t kNoRow = std::numeric_limits<uint32_t>::max();
+
+std::vector<ProjectionUnit> MakeKeyUnits(const std::vector<std::shared_ptr<Expression>>& keys) {
+    std::vector<ProjectionUnit> units;
+    units.reserve(keys.size());
+    for (auto& key : keys) {
+        units.push_back(ProjectionUnit{key, {}});
+    }
+    return units;
+}
+
+// Both sides are looked up in the table built for the build keys, so the key parts must be laid
+// out alike
+void CheckKeyTypes(const std::vector<ProjectionUnit>& probe_keys,
+                   const std::vector<ProjectionUnit>& build_keys) {
+    if (probe_keys.empty() || probe_keys.size() != build_keys.size()) {
+        THROW_RUNTIME_ERROR("Hash join needs the same nonzero number of probe and build keys");
+    }
+    for (size_t i = 0; i < probe_keys.size(); ++i) {
+        auto probe_type = GetExpressionType(*probe_keys[i].expression);
+        auto build_type = GetExpressionType(*build_keys[i].expression);
+        if (probe_type != core::DataType::String && !HasIntegerValue(probe_type)) {
+            THROW_RUNTIME_ERROR("Join key must be integer, string, timestamp, or date");
+        }
+        if (core::DataTypeToPhysical(probe_type) != core::DataTypeToPhysical(build_type)) {
+            THROW_RUNTIME_ERROR("Join keys " + std::to_string(i) +
+                                " have different physical types");
+        }
+    }
+}
+}  // namespace
+
+HashJoinSink::HashJoinSink(IOperator& downstream, const std::vector<core::Batch>& build,
+                           const core::Schema& build_schema,
+                           const std::vector<std::shared_ptr<Expression>>& probe_keys,
+                           const std::vector<std::shared_ptr<Expression>>& build_keys,
+                           JoinType join_type)
+    : downstream_(downstream),
+      build_(build),
+      probe_keys_(MakeKeyUnits(probe_keys)),
+      build_keys_(MakeKeyUnits(build_keys)),
+      join_type_(join_type) {
+    CheckKeyTypes(probe_keys_, build_keys_);
+    std::vector<core::Field> fields = build_schema.GetFields();
+    if (join_type_ == JoinType::Left) {
+        for (auto& field : fields) {
+            field.nullable = true;
+        }
+    }
+    build_schema_ = core::Schema(std::move(fields));
+    state_ = std::make_unique<AggStateBuffer>(no_aggregations_, string_arena_);
+    key_table_ = GroupKeyTable::Make(build_keys_, string_arena_);
+    Build();
+}
+
+void HashJoinSink::FindGroups(const core::Batch& batch, const std::vector<ProjectionUnit>& keys) {
+    std::vector<EvalResult> key_evals;
+    key_evals.reserve(keys.size());
+    std::vector<const core::Column*> key_cols;
+    key_cols.reserve(keys.size());
+    for (auto& key : keys) {
+        key_evals.emplace_back(Evaluate(batch, *key.expression));
+        key_cols.push_back(&key_evals.back().Get());
+    }
+
+    const std::vector<uint32_t>* selection = batch.HasSelection() ? &batch.Selection() : nullptr;
+    group_ids_.clear();
+    group_ids_.reserve(batch.SelectedRowsCount());
+    key_table_->FindGroups(key_cols, selection, batch.RowsCount(), *state_, group_ids_);
+}
+
+void HashJoinSink::Build() {
+    std::vector<uint32_t> last_row;
+    for (size_t b = 0; b < build_.size(); ++b) {
+        const auto& batch = build_[b];
+        if (batch.SelectedRowsCount() == 0) {
+            continue;
+        }
+        FindGroups(batch, build_keys_);
+        first_row_.resize(state_->GroupsCount(), kNoRow);
+        last_row.resize(state_->GroupsCount(), kNoRow);
+
+        size_t k = 0;
+        ForSelectedRows(batch, [&](size_t row) {
+            uint32_t group_id = group_ids_[k++];
+            if (group_id == AggStateBuffer::kNoGroup) {
+                return;
+            }
+            auto build_row = static_cast<uint32_t>(build_rows_.size());
+            build_rows_.push_back({static_cast<uint32_t>(b), static_cast<uint32_t>(row)});
+            next_row_.push_back(kNoRow);
+            if (last_row[group_id] == kNoRow) {
+                first_row_[group_id] = build_row;
+            } else {
+                next_row_[last_row[group_id]] = build_row;
+            }
+            last_row[group_id] = build_row;
+        });
+    }
+    key_table_->Freeze();
+}
+
+std::shared_ptr<const RuntimeFilter> HashJoinSink::KeyFilter() const {
+    if ((join_type_ != JoinType::Inner && join_type_ != JoinType::Semi) ||
+        build_keys_.size() != 1) {
+        return nullptr;
+    }
+    auto type = GetExpressionType(*build_keys_[0].expression);
+    core::Schema key_schema(
+        {core::Field("key", type == core::DataType::String ? type : core::DataType::Int64)});
+    uint32_t groups = state_->GroupsCount();
+    core::Batch keys(std::move(key_schema), groups);
+    for (uint32_t group_id = 0; group_id < groups; ++group_id) {
+        key_table_->AppendKeys(group_id, keys);
+    }
+    return std::make_shared<RuntimeFilter>(keys.ColumnAt(0));
+}
+
+void HashJoinSink::Consume(core::Batch batch) {
+    if (batch.SelectedRowsCount() == 0) {
+        return;
+    }
+    FindGroups(batch, probe_keys_);
+    switch (join_type_) {
+        case JoinType::Semi:
+            EmitFiltered(std::move(batch), true);
+            return;
+        case JoinType::Anti:
+            EmitFiltered(std::move(batch), false);
+            return;
+        case JoinType::Inner:
+        case JoinType::Left:
+            EmitJoined(batch);
+            return;
+    }
+}
+
+void HashJoinSink::EmitFiltered(core::Batch batch, bool matched) {
+    std::vector<uint32_t> out_selection;
+    out_selection.reserve(group_ids_.size());
+    size_t k = 0;
+    ForSelectedRows(batch, [&](size_t row) {
+        if ((group_ids_[k++] != AggStateBuffer::kNoGroup) == matched) {
+            out_selection.push_back(static_cast<uint32_t>(row));
+        }
+    });
+    if (out_selection.empty()) {
+        return;
+    }
+    if (out_selection.size() != batch.RowsCount()) {
+        batch.SetSelection(std::move(out_selection));
+    }
+    downstream_.Consume(std::move(batch));
+}
+
+void HashJoinSink::EmitJoined(const core::Batch& batch) {
+    // Matched pairs first, the columns are then gathered one at a time
+    std::vector<uint32_t> probe_rows;
+    std::vector<uint32_t> build_rows;
+    probe_rows.reserve(group_ids_.size());
+    build_rows.reserve(group_ids_.size());
+    size_t k = 0;
+    ForSelectedRows(batch, [&](size_t row) {
+        uint32_t group_id = group_ids_[k++];
+        if (group_id == AggStateBuffer::kNoGroup) {
+            if (join_type_ == JoinType::Left) {
+                probe_rows.push_back(static_cast<uint32_t>(row));
+                build_rows.push_back(kNoRow);
+            }
+            return;
+        }
+        for (uint32_t r = first_row_[group_id]; r != kNoRow; r = next_row_[r]) {
+            probe_rows.push_back(static_cast<uint32_t>(row));
+            build_rows.push_back(r);
+        }
+    });
+    if (probe_rows.empty()) {
+        return;
+    }
+
+    std::vector<core::Field> fields = batch.GetSchema().GetFields();
+    for (auto& field : build_schema_.GetFields()) {
+        fields.push_back(field);
+    }
+    core::Batch out(core::Schema(std::move(fields)), probe_rows.size());
+    size_t probe_cols = batch.ColumnsCount();
+    for (size_t c = 0; c < probe_cols; ++c) {
+        auto& dst = out.ColumnAt(c);
+        const auto& src = batch.ColumnAt(c);
+        for (uint32_t row : probe_rows) {
+            AppendRow(dst, src, row);
+        }
+    }
+    for (size_t c = 0; c < build_schema_.FieldsCount(); ++c) {
+        auto& dst = out.ColumnAt(probe_cols + c);
+        for (uint32_t r : build_rows) {
+            if (r == kNoRow) {
+                dst.AppendNull();
+                continue;
+            }
+            const auto& build_row = build_rows_[r];
+            AppendRow(dst, build_[build_row.batch].ColumnAt(c), build_row.row);
+        }
+    }
+    downstream_.Consume(std::move(out));
+}
+}  // namespace columnar::exec
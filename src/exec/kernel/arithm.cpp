@@ -16,7 +16,7 @@ namespace columnar::exec::kernel {
 namespace {
 template <typename Op>
 std::unique_ptr<core::Column> ArithmeticIntImpl(const core::Column& lhs, const core::Column& rhs,
-                                                Op op) {
+                                                const std::vector<uint32_t>* selection, Op op) {
     size_t rows = lhs.Size();
     if (rhs.Size() != rows) {
         THROW_RUNTIME_ERROR("Arithmetic: row count mismatch");
@@ -29,20 +29,20 @@ std::unique_ptr<core::Column> ArithmeticIntImpl(const core::Column& lhs, const c
             const util::BitVector* lmask = l.IsNullable() ? &l.GetNullMask() : nullptr;
             const util::BitVector* rmask = r.IsNullable() ? &r.GetNullMask() : nullptr;
             if (lmask == nullptr && rmask == nullptr) {
-                for (size_t i = 0; i < rows; ++i) {
+                ForSelectedRows(selection, rows, [&](size_t i) {
                     data[i] = op(static_cast<int64_t>(ReadTypedValue(l, i)),
                                  static_cast<int64_t>(ReadTypedValue(r, i)));
-                }
+                });
                 return;
             }
-            for (size_t i = 0; i < rows; ++i) {
+            ForSelectedRows(selection, rows, [&](size_t i) {
                 if ((lmask != nullptr && lmask->Get(i)) || (rmask != nullptr && rmask->Get(i))) {
                     mask.Set(i);
-                    continue;
+                    return;
                 }
                 data[i] = op(static_cast<int64_t>(ReadTypedValue(l, i)),
                              static_cast<int64_t>(ReadTypedValue(r, i)));
-            }
+            });
         });
     });
     return std::make_unique<core::Int64Column>(std::move(data), std::move(mask), nullable);
@@ -50,6 +50,7 @@ std::unique_ptr<core::Column> ArithmeticIntImpl(const core::Column& lhs, const c
 
 template <typename Op>
 std::unique_ptr<core::Column> BoolBinaryImpl(const core::Column& lhs, const core::Column& rhs,
+                                             const std::vector<uint32_t>* selection,
                                              const char* name, Op op) {
     if (lhs.GetDataType() != core::DataType::Bool || rhs.GetDataType() != core::DataType::Bool) {
         THROW_RUNTIME_ERROR(std::string(name) + " operands must be boolean");
@@ -62,41 +63,42 @@ std::unique_ptr<core::Column> BoolBinaryImpl(const core::Column& lhs, const core
     }
     const auto& ld = l.GetData();
     const auto& rd = r.GetData();
-    auto out = MakeBoolColumn(rows);
     if (!l.IsNullable() && !r.IsNullable()) {
-        for (size_t i = 0; i < rows; ++i) {
-            out->Append(op(ld.Get(i), rd.Get(i)));
-        }
-        return out;
+        return MakeBoolColumnWhere(rows, selection,
+                                   [&](size_t i) { return op(ld.Get(i), rd.Get(i)); });
     }
     const util::BitVector* lmask = l.IsNullable() ? &l.GetNullMask() : nullptr;
     const util::BitVector* rmask = r.IsNullable() ? &r.GetNullMask() : nullptr;
-    for (size_t i = 0; i < rows; ++i) {
+    return MakeBoolColumnWhere(rows, selection, [&](size_t i) {
         bool lv = ld.Get(i) && !(lmask && lmask->Get(i));
         bool rv = rd.Get(i) && !(rmask && rmask->Get(i));
-        out->Append(op(lv, rv));
-    }
-    return out;
+        return op(lv, rv);
+    });
 }
 }  // namespace
 
-std::unique_ptr<core::Column> And(const core::Column& lhs, const core::Column& rhs) {
-    return BoolBinaryImpl(lhs, rhs, "AND", [](bool a, bool b) { return a && b; });
+std::unique_ptr<core::Column> And(const core::Column& lhs, const core::Column& rhs,
+                                  const std::vector<uint32_t>* selection) {
+    return BoolBinaryImpl(lhs, rhs, selection, "AND", [](bool a, bool b) { return a && b; });
 }
 
-std::unique_ptr<core::Column> Or(const core::Column& lhs, const core::Column& rhs) {
-    return BoolBinaryImpl(lhs, rhs, "OR", [](bool a, bool b) { return a || b; });
+std::unique_ptr<core::Column> Or(const core::Column& lhs, const core::Column& rhs,
+                                 const std::vector<uint32_t>* selection) {
+    return BoolBinaryImpl(lhs, rhs, selection, "OR", [](bool a, bool b) { return a || b; });
 }
 
-std::unique_ptr<core::Column> Add(const core::Column& lhs, const core::Column& rhs) {
-    return ArithmeticIntImpl(lhs, rhs, [](int64_t a, int64_t b) { return a + b; });
+std::unique_ptr<core::Column> Add(const core::Column& lhs, const core::Column& rhs,
+                                  const std::vector<uint32_t>* selection) {
+    return ArithmeticIntImpl(lhs, rhs, selection, [](int64_t a, int64_t b) { return a + b; });
 }
 
-std::unique_ptr<core::Column> Subtract(const core::Column& lhs, const core::Column& rhs) {
-    return ArithmeticIntImpl(lhs, rhs, [](int64_t a, int64_t b) { return a - b; });
+std::unique_ptr<core::Column> Subtract(const core::Column& lhs, const core::Column& rhs,
+                                       const std::vector<uint32_t>* selection) {
+    return ArithmeticIntImpl(lhs, rhs, selection, [](int64_t a, int64_t b) { return a - b; });
 }
 
-std::unique_ptr<core::Column> Multiply(const core::Column& lhs, const core::Column& rhs) {
-    return ArithmeticIntImpl(lhs, rhs, [](int64_t a, int64_t b) { return a * b; });
+std::unique_ptr<core::Column> Multiply(const core::Column& lhs, const core::Column& rhs,
+                                       const std::vector<uint32_t>* selection) {
+    return ArithmeticIntImpl(lhs, rhs, selection, [](int64_t a, int64_t b) { return a * b; });
 }
 }  // namespace columnar::exec::kernel
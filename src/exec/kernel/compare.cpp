@@ -7,52 +7,131 @@
 #include <util/macro.h>
 
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <memory>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace columnar::exec::kernel {
 namespace {
+constexpr size_t kWordBits = 64;
+// Below one selected row in kSparseSelection the kernels visit the selected rows one by one,
+// above it they compare every row a word at a time
+constexpr size_t kSparseSelection = 8;
+
+// Packs 64 bytes of 0 or 1 into a word, bit i from byte i
+uint64_t PackBytes(const uint8_t* bytes) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < kWordBits / 8; ++i) {
+        uint64_t chunk;
+        std::memcpy(&chunk, bytes + 8 * i, sizeof(chunk));
+        word |= ((chunk * 0x0102040810204080ULL) >> 56) << (8 * i);
+    }
+    return word;
+}
+
+// The results of a word are first written as bytes, a loop the compiler turns into vector
+// compares at the width of the operands, and then packed into the word
+template <typename Pred>
+std::vector<uint64_t> PackRows(size_t rows, Pred&& pred) {
+    std::vector<uint64_t> words((rows + kWordBits - 1) / kWordBits, 0);
+    uint8_t bytes[kWordBits];
+    size_t full_words = rows / kWordBits;
+    for (size_t w = 0; w < full_words; ++w) {
+        size_t base = w * kWordBits;
+        for (size_t j = 0; j < kWordBits; ++j) {
+            bytes[j] = pred(base + j);
+        }
+        words[w] = PackBytes(bytes);
+    }
+    for (size_t i = full_words * kWordBits; i < rows; ++i) {
+        words[full_words] |= static_cast<uint64_t>(pred(i)) << (i % kWordBits);
+    }
+    return words;
+}
+
+void ClearNulls(std::vector<uint64_t>& words, const util::BitVector* is_null) {
+    if (is_null == nullptr) {
+        return;
+    }
+    const auto& nulls = is_null->GetData();
+    for (size_t w = 0; w < words.size(); ++w) {
+        words[w] &= ~nulls[w];
+    }
+}
+
+bool IsSparse(const std::vector<uint32_t>* selection, size_t rows) {
+    return selection != nullptr && selection->size() * kSparseSelection < rows;
+}
+
+// pred(i) of the rows that are not NULL on either side, NULL rows compare false
+template <typename Pred>
+std::unique_ptr<core::Column> CompareRows(size_t rows, const std::vector<uint32_t>* selection,
+                                          const util::BitVector* lnulls,
+                                          const util::BitVector* rnulls, Pred&& pred) {
+    if (IsSparse(selection, rows)) {
+        return MakeBoolColumnWhere(rows, selection, [&](size_t i) {
+            bool null = (lnulls && lnulls->Get(i)) || (rnulls && rnulls->Get(i));
+            return !null && pred(i);
+        });
+    }
+    auto words = PackRows(rows, pred);
+    ClearNulls(words, lnulls);
+    ClearNulls(words, rnulls);
+    return std::make_unique<core::BoolColumn>(util::BitVector(std::move(words), rows),
+                                              util::BitVector(), false, rows);
+}
+
+template <typename Col>
+const util::BitVector* NullsOf(const Col& col) {
+    return col.IsNullable() ? &col.GetNullMask() : nullptr;
+}
+
+// Reads the values of numeric columns straight from their data, which keeps the compare loops
+// free of calls
+template <typename Col>
+auto ValueReader(const Col& col) {
+    if constexpr (std::is_same_v<std::remove_cvref_t<Col>, core::BoolColumn>) {
+        return [&col](size_t i) { return col.Get(i); };
+    } else {
+        return [data = col.GetData().data()](size_t i) { return data[i]; };
+    }
+}
+
+// Both sides are compared at their common type, so Int16 and Int32 columns are not widened
 template <typename L, typename R, typename Cmp>
-std::unique_ptr<core::Column> ComparePair(const L& lhs, const R& rhs, Cmp&& cmp) {
+std::unique_ptr<core::Column> ComparePair(const L& lhs, const R& rhs,
+                                          const std::vector<uint32_t>* selection, Cmp&& cmp) {
     size_t rows = TypedColumnSize(lhs);
     if (TypedColumnSize(rhs) != rows) {
         THROW_RUNTIME_ERROR("Compare: row count mismatch");
     }
-    auto out = MakeBoolColumn(rows);
-    if (!lhs.IsNullable() && !rhs.IsNullable()) {
-        for (size_t i = 0; i < rows; ++i) {
-            out->Append(cmp(ReadTypedValue(lhs, i), ReadTypedValue(rhs, i)));
-        }
-        return out;
-    }
-    const util::BitVector* lmask = lhs.IsNullable() ? &lhs.GetNullMask() : nullptr;
-    const util::BitVector* rmask = rhs.IsNullable() ? &rhs.GetNullMask() : nullptr;
-    for (size_t i = 0; i < rows; ++i) {
-        bool null = (lmask && lmask->Get(i)) || (rmask && rmask->Get(i));
-        out->Append(!null && cmp(ReadTypedValue(lhs, i), ReadTypedValue(rhs, i)));
-    }
-    return out;
+    using Common = std::common_type_t<decltype(ReadTypedValue(lhs, 0)),
+                                      decltype(ReadTypedValue(rhs, 0))>;
+    auto l = ValueReader(lhs);
+    auto r = ValueReader(rhs);
+    return CompareRows(rows, selection, NullsOf(lhs), NullsOf(rhs), [&](size_t i) {
+        return cmp(static_cast<Common>(l(i)), static_cast<Common>(r(i)));
+    });
 }
 
 template <typename Cmp>
 std::unique_ptr<core::Column> CompareIntegers(const core::Column& lhs, const core::Column& rhs,
-                                              Cmp cmp) {
+                                              const std::vector<uint32_t>* selection, Cmp cmp) {
     return VisitIntegerCol(lhs, [&](const auto& l) {
-        return VisitIntegerCol(rhs, [&](const auto& r) {
-            return ComparePair(l, r, [&](auto a, auto b) {
-                return cmp(static_cast<int64_t>(a), static_cast<int64_t>(b));
-            });
-        });
+        return VisitIntegerCol(rhs,
+                               [&](const auto& r) { return ComparePair(l, r, selection, cmp); });
     });
 }
 
 template <typename Cmp>
 std::unique_ptr<core::Column> CompareDoubles(const core::Column& lhs, const core::Column& rhs,
-                                             Cmp cmp) {
+                                             const std::vector<uint32_t>* selection, Cmp cmp) {
     return VisitNumericCol(lhs, [&](const auto& l) {
         return VisitNumericCol(rhs, [&](const auto& r) {
-            return ComparePair(l, r, [&](auto a, auto b) {
+            return ComparePair(l, r, selection, [&](auto a, auto b) {
                 return cmp(static_cast<double>(a), static_cast<double>(b));
             });
         });
@@ -61,7 +140,7 @@ std::unique_ptr<core::Column> CompareDoubles(const core::Column& lhs, const core
 
 template <typename Cmp>
 std::unique_ptr<core::Column> CompareStrings(const core::Column& lhs, const core::Column& rhs,
-                                             Cmp cmp) {
+                                             const std::vector<uint32_t>* selection, Cmp cmp) {
     if (lhs.GetDataType() != core::DataType::String ||
         rhs.GetDataType() != core::DataType::String) {
         THROW_RUNTIME_ERROR("Compare: expected string columns on both sides");
@@ -70,52 +149,49 @@ std::unique_ptr<core::Column> CompareStrings(const core::Column& lhs, const core
     if (rhs.Size() != rows) {
         THROW_RUNTIME_ERROR("Compare: row count mismatch");
     }
-    auto out = MakeBoolColumn(rows);
-    for (size_t i = 0; i < rows; ++i) {
-        if (lhs.IsNull(i) || rhs.IsNull(i)) {
-            out->Append(false);
-        } else {
-            out->Append(cmp(ReadStringRow(lhs, i), ReadStringRow(rhs, i)));
-        }
-    }
-    return out;
+    return MakeBoolColumnWhere(rows, selection, [&](size_t i) {
+        return !lhs.IsNull(i) && !rhs.IsNull(i) &&
+               cmp(ReadStringRow(lhs, i), ReadStringRow(rhs, i));
+    });
 }
 
 template <typename Cmp>
 std::unique_ptr<core::Column> CompareDispatch(const core::Column& lhs, const core::Column& rhs,
-                                              Cmp cmp) {
+                                              const std::vector<uint32_t>* selection, Cmp cmp) {
     if (lhs.GetDataType() == core::DataType::String ||
         rhs.GetDataType() == core::DataType::String) {
-        return CompareStrings(lhs, rhs, cmp);
+        return CompareStrings(lhs, rhs, selection, cmp);
     }
     if (lhs.GetDataType() == core::DataType::Double ||
         rhs.GetDataType() == core::DataType::Double) {
-        return CompareDoubles(lhs, rhs, cmp);
+        return CompareDoubles(lhs, rhs, selection, cmp);
     }
-    return CompareIntegers(lhs, rhs, cmp);
+    return CompareIntegers(lhs, rhs, selection, cmp);
 }
 
+// The constant is narrowed to the width of the column. A constant outside its range compares
+// alike with every value, 0 among them
 template <typename Cmp>
-std::unique_ptr<core::Column> CompareIntConst(const core::Column& col, int64_t value, Cmp cmp) {
+std::unique_ptr<core::Column> CompareIntConst(const core::Column& col, int64_t value,
+                                              const std::vector<uint32_t>* selection, Cmp cmp) {
     return VisitIntegerCol(col, [&](const auto& typed) -> std::unique_ptr<core::Column> {
+        using T = decltype(ReadTypedValue(typed, 0));
         size_t rows = TypedColumnSize(typed);
-        auto out = MakeBoolColumn(rows);
-        if (!typed.IsNullable()) {
-            for (size_t i = 0; i < rows; ++i) {
-                out->Append(cmp(static_cast<int64_t>(ReadTypedValue(typed, i)), value));
-            }
-            return out;
-        }
-        const auto& mask = typed.GetNullMask();
-        for (size_t i = 0; i < rows; ++i) {
-            out->Append(!mask.Get(i) && cmp(static_cast<int64_t>(ReadTypedValue(typed, i)), value));
+        const util::BitVector* nulls = NullsOf(typed);
+        auto read = ValueReader(typed);
+        if (value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max()) {
+            bool result = cmp(int64_t{0}, value);
+            return CompareRows(rows, selection, nulls, nullptr, [&](size_t) { return result; });
         }
-        return out;
+        auto narrowed = static_cast<T>(value);
+        return CompareRows(rows, selection, nulls, nullptr,
+                           [&](size_t i) { return cmp(read(i), narrowed); });
     });
 }
 
 template <typename Cmp>
 std::unique_ptr<core::Column> CompareStringConst(const core::Column& col, std::string_view value,
+                                                 const std::vector<uint32_t>* selection,
                                                  Cmp cmp) {
     if (col.GetDataType() != core::DataType::String) {
         THROW_RUNTIME_ERROR("CompareStringConst: expected string column");
@@ -125,106 +201,115 @@ std::unique_ptr<core::Column> CompareStringConst(const core::Column& col, std::s
         for (uint32_t id = 0; id < dict_results.size(); ++id) {
             dict_results[id] = cmp(dict->DictValue(id), value) ? 1 : 0;
         }
-        size_t rows = dict->Size();
-        auto out = MakeBoolColumn(rows);
-        for (size_t i = 0; i < rows; ++i) {
-            out->Append(!dict->IsNull(i) && dict_results[dict->GetId(i)] != 0);
-        }
-        return out;
+        return MakeBoolColumnWhere(dict->Size(), selection, [&](size_t i) {
+            return !dict->IsNull(i) && dict_results[dict->GetId(i)] != 0;
+        });
     }
     auto& s = static_cast<const core::StringColumn&>(col);
-    size_t rows = s.Size();
-    auto out = MakeBoolColumn(rows);
     if (!s.IsNullable()) {
-        for (size_t i = 0; i < rows; ++i) {
-            out->Append(cmp(s.Get(i), value));
-        }
-        return out;
-    }
-    for (size_t i = 0; i < rows; ++i) {
-        out->Append(!s.IsNull(i) && cmp(s.Get(i), value));
+        return MakeBoolColumnWhere(s.Size(), selection,
+                                   [&](size_t i) { return cmp(s.Get(i), value); });
     }
-    return out;
+    return MakeBoolColumnWhere(s.Size(), selection,
+                               [&](size_t i) { return !s.IsNull(i) && cmp(s.Get(i), value); });
 }
 }  // namespace
 
-std::unique_ptr<core::Column> Equal(const core::Column& lhs, const core::Column& rhs) {
-    return CompareDispatch(lhs, rhs, [](auto a, auto b) { return a == b; });
+std::unique_ptr<core::Column> Equal(const core::Column& lhs, const core::Column& rhs,
+                                    const std::vector<uint32_t>* selection) {
+    return CompareDispatch(lhs, rhs, selection, [](auto a, auto b) { return a == b; });
 }
 
-std::unique_ptr<core::Column> NotEqual(const core::Column& lhs, const core::Column& rhs) {
-    return CompareDispatch(lhs, rhs, [](auto a, auto b) { return a != b; });
+std::unique_ptr<core::Column> NotEqual(const core::Column& lhs, const core::Column& rhs,
+                                       const std::vector<uint32_t>* selection) {
+    return CompareDispatch(lhs, rhs, selection, [](auto a, auto b) { return a != b; });
 }
 
-std::unique_ptr<core::Column> Less(const core::Column& lhs, const core::Column& rhs) {
-    return CompareDispatch(lhs, rhs, [](auto a, auto b) { return a < b; });
+std::unique_ptr<core::Column> Less(const core::Column& lhs, const core::Column& rhs,
+                                   const std::vector<uint32_t>* selection) {
+    return CompareDispatch(lhs, rhs, selection, [](auto a, auto b) { return a < b; });
 }
 
-std::unique_ptr<core::Column> LessOrEqual(const core::Column& lhs, const core::Column& rhs) {
-    return CompareDispatch(lhs, rhs, [](auto a, auto b) { return a <= b; });
+std::unique_ptr<core::Column> LessOrEqual(const core::Column& lhs, const core::Column& rhs,
+                                          const std::vector<uint32_t>* selection) {
+    return CompareDispatch(lhs, rhs, selection, [](auto a, auto b) { return a <= b; });
 }
 
-std::unique_ptr<core::Column> Greater(const core::Column& lhs, const core::Column& rhs) {
-    return CompareDispatch(lhs, rhs, [](auto a, auto b) { return a > b; });
+std::unique_ptr<core::Column> Greater(const core::Column& lhs, const core::Column& rhs,
+                                      const std::vector<uint32_t>* selection) {
+    return CompareDispatch(lhs, rhs, selection, [](auto a, auto b) { return a > b; });
 }
 
-std::unique_ptr<core::Column> GreaterOrEqual(const core::Column& lhs, const core::Column& rhs) {
-    return CompareDispatch(lhs, rhs, [](auto a, auto b) { return a >= b; });
+std::unique_ptr<core::Column> GreaterOrEqual(const core::Column& lhs, const core::Column& rhs,
+                                             const std::vector<uint32_t>* selection) {
+    return CompareDispatch(lhs, rhs, selection, [](auto a, auto b) { return a >= b; });
 }
 
-std::unique_ptr<core::Column> EqualConstInt(const core::Column& col, int64_t value) {
-    return CompareIntConst(col, value, [](int64_t a, int64_t b) { return a == b; });
+std::unique_ptr<core::Column> EqualConstInt(const core::Column& col, int64_t value,
+                                            const std::vector<uint32_t>* selection) {
+    return CompareIntConst(col, value, selection, [](auto a, auto b) { return a == b; });
 }
 
-std::unique_ptr<core::Column> NotEqualConstInt(const core::Column& col, int64_t value) {
-    return CompareIntConst(col, value, [](int64_t a, int64_t b) { return a != b; });
+std::unique_ptr<core::Column> NotEqualConstInt(const core::Column& col, int64_t value,
+                                               const std::vector<uint32_t>* selection) {
+    return CompareIntConst(col, value, selection, [](auto a, auto b) { return a != b; });
 }
 
-std::unique_ptr<core::Column> LessConstInt(const core::Column& col, int64_t value) {
-    return CompareIntConst(col, value, [](int64_t a, int64_t b) { return a < b; });
+std::unique_ptr<core::Column> LessConstInt(const core::Column& col, int64_t value,
+                                           const std::vector<uint32_t>* selection) {
+    return CompareIntConst(col, value, selection, [](auto a, auto b) { return a < b; });
 }
 
-std::unique_ptr<core::Column> LessOrEqualConstInt(const core::Column& col, int64_t value) {
-    return CompareIntConst(col, value, [](int64_t a, int64_t b) { return a <= b; });
+std::unique_ptr<core::Column> LessOrEqualConstInt(const core::Column& col, int64_t value,
+                                                  const std::vector<uint32_t>* selection) {
+    return CompareIntConst(col, value, selection, [](auto a, auto b) { return a <= b; });
 }
 
-std::unique_ptr<core::Column> GreaterConstInt(const core::Column& col, int64_t value) {
-    return CompareIntConst(col, value, [](int64_t a, int64_t b) { return a > b; });
+std::unique_ptr<core::Column> GreaterConstInt(const core::Column& col, int64_t value,
+                                              const std::vector<uint32_t>* selection) {
+    return CompareIntConst(col, value, selection, [](auto a, auto b) { return a > b; });
 }
 
-std::unique_ptr<core::Column> GreaterOrEqualConstInt(const core::Column& col, int64_t value) {
-    return CompareIntConst(col, value, [](int64_t a, int64_t b) { return a >= b; });
+std::unique_ptr<core::Column> GreaterOrEqualConstInt(const core::Column& col, int64_t value,
+                                                     const std::vector<uint32_t>* selection) {
+    return CompareIntConst(col, value, selection, [](auto a, auto b) { return a >= b; });
 }
 
-std::unique_ptr<core::Column> EqualConstString(const core::Column& col, std::string_view value) {
-    return CompareStringConst(col, value,
+std::unique_ptr<core::Column> EqualConstString(const core::Column& col, std::string_view value,
+                                               const std::vector<uint32_t>* selection) {
+    return CompareStringConst(col, value, selection,
                               [](std::string_view a, std::string_view b) { return a == b; });
 }
 
-std::unique_ptr<core::Column> NotEqualConstString(const core::Column& col, std::string_view value) {
-    return CompareStringConst(col, value,
+std::unique_ptr<core::Column> NotEqualConstString(const core::Column& col, std::string_view value,
+                                                  const std::vector<uint32_t>* selection) {
+    return CompareStringConst(col, value, selection,
                               [](std::string_view a, std::string_view b) { return a != b; });
 }
 
-std::unique_ptr<core::Column> LessConstString(const core::Column& col, std::string_view value) {
-    return CompareStringConst(col, value,
+std::unique_ptr<core::Column> LessConstString(const core::Column& col, std::string_view value,
+                                              const std::vector<uint32_t>* selection) {
+    return CompareStringConst(col, value, selection,
                               [](std::string_view a, std::string_view b) { return a < b; });
 }
 
 std::unique_ptr<core::Column> LessOrEqualConstString(const core::Column& col,
-                                                     std::string_view value) {
-    return CompareStringConst(col, value,
+                                                     std::string_view value,
+                                                     const std::vector<uint32_t>* selection) {
+    return CompareStringConst(col, value, selection,
                               [](std::string_view a, std::string_view b) { return a <= b; });
 }
 
-std::unique_ptr<core::Column> GreaterConstString(const core::Column& col, std::string_view value) {
-    return CompareStringConst(col, value,
+std::unique_ptr<core::Column> GreaterConstString(const core::Column& col, std::string_view value,
+                                                 const std::vector<uint32_t>* selection) {
+    return CompareStringConst(col, value, selection,
                               [](std::string_view a, std::string_view b) { return a > b; });
 }
 
 std::unique_ptr<core::Column> GreaterOrEqualConstString(const core::Column& col,
-                                                        std::string_view value) {
-    return CompareStringConst(col, value,
+                                                        std::string_view value,
+                                                        const std::vector<uint32_t>* selection) {
+    return CompareStringConst(col, value, selection,
                               [](std::string_view a, std::string_view b) { return a >= b; });
 }
 }  // namespace columnar::exec::kernel
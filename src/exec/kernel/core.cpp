@@ -4,8 +4,11 @@
 #include <core/columns/bool_column.h>
 #include <core/columns/numeric_column.h>
 #include <exec/column_row_access.h>
+#include <exec/kernel/internal.h>
+#include <exec/selection.h>
 #include <util/macro.h>
 
+#include <bit>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -22,27 +25,38 @@ std::unique_ptr<core::Column> ConstInt64(int64_t value, size_t rows) {
 
 std::unique_ptr<core::Column> CaseSelect(const core::BoolColumn& mask,
                                          const core::Column& when_true,
-                                         const core::Column& when_false) {
+                                         const core::Column& when_false,
+                                         const std::vector<uint32_t>* selection) {
     size_t rows = mask.Size();
     if (when_true.Size() != rows || when_false.Size() != rows) {
         THROW_RUNTIME_ERROR("CASE: row count mismatch");
     }
     auto out = core::MakeColumn(when_true.GetDataType(),
                                 when_true.IsNullable() || when_false.IsNullable());
-    for (size_t i = 0; i < rows; ++i) {
-        bool take_true = !mask.IsNull(i) && mask.Get(i);
-        AppendRow(*out, take_true ? when_true : when_false, i);
-    }
+    out->Reserve(rows);
+    ForRowsBySelection(
+        selection, rows,
+        [&](size_t i) {
+            bool take_true = !mask.IsNull(i) && mask.Get(i);
+            AppendRow(*out, take_true ? when_true : when_false, i);
+        },
+        [&](size_t) { out->AppendDefault(); });
     return out;
 }
 
 std::vector<uint32_t> MaskToSelection(const core::BoolColumn& mask) {
     std::vector<uint32_t> selection;
     selection.reserve(mask.GetData().PopCount());
+    const auto& words = mask.GetData().GetData();
     size_t rows = mask.Size();
-    for (size_t i = 0; i < rows; ++i) {
-        if (mask.Get(i)) {
-            selection.push_back(static_cast<uint32_t>(i));
+    size_t words_count = (rows + 63) / 64;
+    for (size_t w = 0; w < words_count; ++w) {
+        uint64_t word = words[w];
+        if (w + 1 == words_count && rows % 64 != 0) {
+            word &= (uint64_t{1} << (rows % 64)) - 1;
+        }
+        for (; word != 0; word &= word - 1) {
+            selection.push_back(static_cast<uint32_t>(w * 64 + std::countr_zero(word)));
         }
     }
     return selection;
@@ -52,14 +66,11 @@ core::Batch Materialize(const core::Batch& batch) {
     if (!batch.HasSelection()) {
         THROW_RUNTIME_ERROR("Materialize: batch has no selection");
     }
-    const auto& selection = batch.Selection();
-    core::Batch out(batch.GetSchema(), selection.size());
+    core::Batch out(batch.GetSchema(), batch.SelectedRowsCount());
     for (size_t col = 0; col < batch.ColumnsCount(); ++col) {
         const auto& src = batch.ColumnAt(col);
         auto& dst = out.ColumnAt(col);
-        for (uint32_t row : selection) {
-            AppendRow(dst, src, row);
-        }
+        ForSelectedRows(batch, [&](size_t row) { AppendRow(dst, src, row); });
     }
     return out;
 }
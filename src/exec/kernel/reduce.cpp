@@ -9,7 +9,6 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
-#include <unordered_set>
 #include <vector>
 
 namespace columnar::exec::kernel {
@@ -131,21 +130,25 @@ uint64_t CountNonNull(const core::Column& col, const std::vector<uint32_t>* sele
     return c;
 }
 
-void DistinctInts(const core::Column& col, std::unordered_set<int64_t>& out,
+void DistinctInts(const core::Column& col, absl::flat_hash_set<int64_t>& out,
                   const std::vector<uint32_t>* selection) {
     VisitIntegerCol(col, [&](const auto& typed) {
         ForEachNonNullCol(typed, selection, [&](auto v) { out.insert(static_cast<int64_t>(v)); });
     });
 }
 
-void DistinctStrings(const core::Column& col, std::unordered_set<std::string>& out,
-                     const std::vector<uint32_t>* selection) {
+void DistinctStrings(const core::Column& col, absl::flat_hash_set<std::string_view>& out,
+                     util::StringArena& arena, const std::vector<uint32_t>* selection) {
     if (col.GetDataType() != core::DataType::String) {
         THROW_RUNTIME_ERROR("DistinctStrings: not a string column");
     }
     ForSelectedRows(selection, col.Size(), [&](size_t i) {
-        if (!col.IsNull(i)) {
-            out.emplace(ReadStringRow(col, i));
+        if (col.IsNull(i)) {
+            return;
+        }
+        std::string_view value = ReadStringRow(col, i);
+        if (!out.contains(value)) {
+            out.insert(arena.Intern(value));
         }
     });
 }
@@ -85,7 +85,7 @@ std::unique_ptr<core::Column> ConstString(std::string_view value, size_t rows) {
 }
 
 std::unique_ptr<core::Column> StrContains(const core::Column& operand, std::string_view substring,
-                                          bool negated) {
+                                          bool negated, const std::vector<uint32_t>* selection) {
     if (operand.GetDataType() != core::DataType::String) {
         THROW_RUNTIME_ERROR("StrContains operand must be a string column");
     }
@@ -95,64 +95,54 @@ std::unique_ptr<core::Column> StrContains(const core::Column& operand, std::stri
             bool found = dict->DictValue(id).find(substring) != std::string_view::npos;
             dict_results[id] = (found != negated) ? 1 : 0;
         }
-        size_t rows = dict->Size();
-        auto out = MakeBoolColumn(rows);
-        for (size_t i = 0; i < rows; ++i) {
-            out->Append(!dict->IsNull(i) && dict_results[dict->GetId(i)] != 0);
-        }
-        return out;
+        return MakeBoolColumnWhere(dict->Size(), selection, [&](size_t i) {
+            return !dict->IsNull(i) && dict_results[dict->GetId(i)] != 0;
+        });
     }
     auto& s = static_cast<const core::StringColumn&>(operand);
-    size_t rows = s.Size();
-    auto out = MakeBoolColumn(rows);
-    for (size_t i = 0; i < rows; ++i) {
+    return MakeBoolColumnWhere(s.Size(), selection, [&](size_t i) {
         if (s.IsNull(i)) {
-            out->Append(false);
-            continue;
+            return false;
         }
         bool found = s.Get(i).find(substring) != std::string_view::npos;
-        out->Append(found != negated);
-    }
-    return out;
+        return found != negated;
+    });
 }
 
-std::unique_ptr<core::Column> StrLength(const core::Column& operand) {
+std::unique_ptr<core::Column> StrLength(const core::Column& operand,
+                                        const std::vector<uint32_t>* selection) {
     if (operand.GetDataType() != core::DataType::String) {
         THROW_RUNTIME_ERROR("length() operand must be a string column");
     }
+    size_t rows = operand.Size();
+    bool nullable = operand.IsNullable();
+    std::vector<int64_t> data(rows);
+    util::BitVector mask = nullable ? util::BitVector(rows) : util::BitVector();
+    auto fill = [&](auto&& length) {
+        ForSelectedRows(selection, rows, [&](size_t i) {
+            if (operand.IsNull(i)) {
+                mask.Set(i);
+            } else {
+                data[i] = length(i);
+            }
+        });
+    };
     if (auto* dict = core::AsDictionaryString(operand)) {
         std::vector<int64_t> lengths(dict->DictSize(), 0);
         for (uint32_t id = 0; id < lengths.size(); ++id) {
             lengths[id] = static_cast<int64_t>(dict->DictValue(id).size());
         }
-        size_t rows = dict->Size();
-        auto out = std::make_unique<core::Int64Column>(dict->IsNullable());
-        out->Reserve(rows);
-        for (size_t i = 0; i < rows; ++i) {
-            if (dict->IsNull(i)) {
-                out->AppendNull();
-            } else {
-                out->Append(lengths[dict->GetId(i)]);
-            }
-        }
-        return out;
+        fill([&](size_t i) { return lengths[dict->GetId(i)]; });
+    } else {
+        auto& s = static_cast<const core::StringColumn&>(operand);
+        fill([&](size_t i) { return static_cast<int64_t>(s.Get(i).size()); });
     }
-    auto& s = static_cast<const core::StringColumn&>(operand);
-    size_t rows = s.Size();
-    auto out = std::make_unique<core::Int64Column>(s.IsNullable());
-    out->Reserve(rows);
-    for (size_t i = 0; i < rows; ++i) {
-        if (s.IsNull(i)) {
-            out->AppendNull();
-        } else {
-            out->Append(static_cast<int64_t>(s.Get(i).size()));
-        }
-    }
-    return out;
+    return std::make_unique<core::Int64Column>(std::move(data), std::move(mask), nullable);
 }
 
 std::unique_ptr<core::Column> RegexReplace(const core::Column& operand, const RE2& regex,
-                                           const std::string& replacement) {
+                                           const std::string& replacement,
+                                           const std::vector<uint32_t>* selection) {
     if (operand.GetDataType() != core::DataType::String) {
         THROW_RUNTIME_ERROR("REGEXP_REPLACE operand must be a string column");
     }
@@ -167,23 +157,26 @@ std::unique_ptr<core::Column> RegexReplace(const core::Column& operand, const RE
     size_t rows = s.Size();
     auto out = std::make_unique<core::StringColumn>(s.IsNullable());
     out->Reserve(rows);
-    for (size_t i = 0; i < rows; ++i) {
-        if (s.IsNull(i)) {
-            out->AppendNull();
-            continue;
-        }
-        auto value = s.Get(i);
-        std::string replaced(value);
-        RE2::GlobalReplace(&replaced, regex, replacement);
-        out->Append(replaced);
-    }
+    ForRowsBySelection(
+        selection, rows,
+        [&](size_t i) {
+            if (s.IsNull(i)) {
+                out->AppendNull();
+                return;
+            }
+            std::string replaced(s.Get(i));
+            RE2::GlobalReplace(&replaced, regex, replacement);
+            out->Append(replaced);
+        },
+        [&](size_t) { out->AppendDefault(); });
     return out;
 }
 
 std::unique_ptr<core::Column> PrefixCapture(const core::Column& operand,
                                             const std::vector<std::string>& prefixes,
                                             char delimiter, bool require_non_empty,
-                                            bool single_line_tail) {
+                                            bool single_line_tail,
+                                            const std::vector<uint32_t>* selection) {
     if (operand.GetDataType() != core::DataType::String) {
         THROW_RUNTIME_ERROR("PrefixCapture operand must be a string column");
     }
@@ -198,15 +191,17 @@ std::unique_ptr<core::Column> PrefixCapture(const core::Column& operand,
     size_t rows = s.Size();
     auto out = std::make_unique<core::StringColumn>(s.IsNullable());
     out->Reserve(rows);
-    for (size_t i = 0; i < rows; ++i) {
-        if (s.IsNull(i)) {
-            out->AppendNull();
-            continue;
-        }
-        auto value = s.Get(i);
-        out->Append(
-            ApplyPrefixCapture(value, prefixes, delimiter, require_non_empty, single_line_tail));
-    }
+    ForRowsBySelection(
+        selection, rows,
+        [&](size_t i) {
+            if (s.IsNull(i)) {
+                out->AppendNull();
+                return;
+            }
+            out->Append(ApplyPrefixCapture(s.Get(i), prefixes, delimiter, require_non_empty,
+                                           single_line_tail));
+        },
+        [&](size_t) { out->AppendDefault(); });
     return out;
 }
 }  // namespace columnar::exec::kernel
@@ -2,15 +2,18 @@
 #include <core/columns/timestamp_column.h>
 #include <exec/column_row_access.h>
 #include <exec/kernel.h>
+#include <exec/kernel/internal.h>
 #include <util/macro.h>
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace columnar::exec::kernel {
 namespace {
 template <typename Transform>
 std::unique_ptr<core::Column> MapTimestamp(const core::Column& operand, bool to_timestamp,
+                                           const std::vector<uint32_t>* selection,
                                            Transform&& transform) {
     if (operand.GetDataType() != core::DataType::Timestamp) {
         THROW_RUNTIME_ERROR("expected a timestamp column");
@@ -21,24 +24,30 @@ std::unique_ptr<core::Column> MapTimestamp(const core::Column& operand, bool to_
                            std::make_unique<core::TimestampColumn>(operand.IsNullable()))
                      : std::unique_ptr<core::Column>(
                            std::make_unique<core::Int64Column>(operand.IsNullable()));
-    for (size_t i = 0; i < rows; ++i) {
-        if (operand.IsNull(i)) {
-            out->AppendNull();
-        } else {
-            AppendInteger(*out, transform(ReadIntegerRow(operand, i)));
-        }
-    }
+    out->Reserve(rows);
+    ForRowsBySelection(
+        selection, rows,
+        [&](size_t i) {
+            if (operand.IsNull(i)) {
+                out->AppendNull();
+            } else {
+                AppendInteger(*out, transform(ReadIntegerRow(operand, i)));
+            }
+        },
+        [&](size_t) { out->AppendDefault(); });
     return out;
 }
 }  // namespace
 
-std::unique_ptr<core::Column> ExtractMinute(const core::Column& operand) {
-    return MapTimestamp(operand, /*to_timestamp=*/false,
+std::unique_ptr<core::Column> ExtractMinute(const core::Column& operand,
+                                            const std::vector<uint32_t>* selection) {
+    return MapTimestamp(operand, /*to_timestamp=*/false, selection,
                         [](int64_t seconds) { return (seconds / 60) % 60; });
 }
 
-std::unique_ptr<core::Column> TruncMinute(const core::Column& operand) {
-    return MapTimestamp(operand, /*to_timestamp=*/true,
+std::unique_ptr<core::Column> TruncMinute(const core::Column& operand,
+                                          const std::vector<uint32_t>* selection) {
+    return MapTimestamp(operand, /*to_timestamp=*/true, selection,
                         [](int64_t seconds) { return seconds - seconds % 60; });
 }
 }  // namespace columnar::exec::kernel
@@ -0,0 +1,98 @@
+#include <exec/late_materialize_operator.h>
+
+#include <core/columns/numeric_column.h>
+#include <exec/column_row_access.h>
+#include <exec/kernel.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace columnar::exec {
+void LateMaterializeSink::Consume(core::Batch batch) {
+    if (batch.SelectedRowsCount() == 0) {
+        return;
+    }
+    if (batch.HasSelection()) {
+        batch = kernel::Materialize(batch);
+    }
+    buffer_.push_back(std::move(batch));
+}
+
+void LateMaterializeSink::Finalize() {
+    if (buffer_.empty()) {
+        downstream_.Finalize();
+        return;
+    }
+    const auto& input_schema = buffer_.front().GetSchema();
+    size_t row_id_col = input_schema.GetIndex(kRowIdColumn);
+
+    struct RowRef {
+        uint64_t row_id;
+        uint32_t batch_idx;
+        uint32_t row_idx;
+    };
+    std::vector<RowRef> refs;
+    for (size_t b = 0; b < buffer_.size(); ++b) {
+        const auto& ids = static_cast<const core::Int64Column&>(buffer_[b].ColumnAt(row_id_col));
+        for (size_t row = 0; row < ids.Size(); ++row) {
+            refs.push_back({static_cast<uint64_t>(ids.Get(row)), static_cast<uint32_t>(b),
+                            static_cast<uint32_t>(row)});
+        }
+    }
+    std::vector<uint32_t> order(refs.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return refs[a].row_id < refs[b].row_id; });
+
+    // One fetch per row group, fetched[f] holds the rows of the refs in order[f]
+    std::vector<core::Batch> fetched;
+    std::vector<std::pair<uint32_t, uint32_t>> fetched_pos(refs.size());
+    std::vector<uint32_t> rows;
+    for (size_t begin = 0; begin < order.size();) {
+        uint64_t group = refs[order[begin]].row_id >> 32;
+        rows.clear();
+        size_t end = begin;
+        for (; end < order.size() && refs[order[end]].row_id >> 32 == group; ++end) {
+            auto row = static_cast<uint32_t>(refs[order[end]].row_id);
+            if (rows.empty() || rows.back() != row) {
+                rows.push_back(row);
+            }
+            fetched_pos[order[end]] = {static_cast<uint32_t>(fetched.size()),
+                                       static_cast<uint32_t>(rows.size() - 1)};
+        }
+        fetched.push_back(reader_.FetchRows(static_cast<size_t>(group), column_indexes_, rows));
+        begin = end;
+    }
+
+    std::vector<core::Field> fields;
+    for (size_t c = 0; c < input_schema.FieldsCount(); ++c) {
+        if (c != row_id_col) {
+            fields.push_back(input_schema.GetFields()[c]);
+        }
+    }
+    auto late_schema = reader_.ProjectSchema(column_indexes_);
+    for (auto& field : late_schema.GetFields()) {
+        fields.push_back(field);
+    }
+    core::Batch out(core::Schema(std::move(fields)), refs.size());
+    for (size_t i = 0; i < refs.size(); ++i) {
+        const auto& batch = buffer_[refs[i].batch_idx];
+        size_t out_col = 0;
+        for (size_t c = 0; c < batch.ColumnsCount(); ++c) {
+            if (c != row_id_col) {
+                AppendRow(out.ColumnAt(out_col++), batch.ColumnAt(c), refs[i].row_idx);
+            }
+        }
+        const auto& late = fetched[fetched_pos[i].first];
+        for (size_t c = 0; c < late.ColumnsCount(); ++c) {
+            AppendRow(out.ColumnAt(out_col++), late.ColumnAt(c), fetched_pos[i].second);
+        }
+    }
+    buffer_.clear();
+    downstream_.Consume(std::move(out));
+    downstream_.Finalize();
+}
+}  // namespace columnar::exec
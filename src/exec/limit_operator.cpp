@@ -0,0 +1,41 @@
+#include <exec/limit_operator.h>
+
+#include <exec/selection.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace columnar::exec {
+void LimitSink::Consume(core::Batch batch) {
+    size_t selected = batch.SelectedRowsCount();
+    if (Done() || selected == 0) {
+        return;
+    }
+    if (to_skip_ >= selected) {
+        to_skip_ -= selected;
+        return;
+    }
+    if (to_skip_ == 0 && selected <= remaining_) {
+        remaining_ -= selected;
+        downstream_.Consume(std::move(batch));
+        return;
+    }
+
+    size_t take = std::min(selected - to_skip_, remaining_);
+    std::vector<uint32_t> selection;
+    selection.reserve(take);
+    size_t pos = 0;
+    ForSelectedRows(batch, [&](size_t row) {
+        if (pos >= to_skip_ && pos < to_skip_ + take) {
+            selection.push_back(static_cast<uint32_t>(row));
+        }
+        ++pos;
+    });
+    to_skip_ = 0;
+    remaining_ -= take;
+    batch.SetSelection(std::move(selection));
+    downstream_.Consume(std::move(batch));
+}
+}  // namespace columnar::exec
@@ -1,7 +1,10 @@
 #include <exec/metadata_pruning.h>
 
 #include <bruh/bruh_batch_reader.h>
+#include <exec/column_dispatch.h>
 #include <exec/expression/utils.h>
+#include <exec/runtime_filter.h>
+#include <exec/topn_operator.h>
 
 #include <algorithm>
 #include <string_view>
@@ -134,6 +137,29 @@ bool ContainsMayMatch(bruh::BruhBatchReader& reader, size_t row_group,
     }
     return statistics.has_min_max;
 }
+
+bool RuntimeFilterMayMatch(bruh::BruhBatchReader& reader, size_t row_group,
+                           const RuntimeFilterExpr& runtime_filter) {
+    if (runtime_filter.key->type != ExpressionType::Column) {
+        return true;
+    }
+    auto& column = static_cast<const ColumnExpr&>(*runtime_filter.key);
+    auto& statistics = ColumnStatistics(reader, row_group, column);
+    if (!statistics.present) {
+        return true;
+    }
+    if (!statistics.has_min_max) {
+        return false;
+    }
+    const auto& filter = *runtime_filter.filter;
+    if (filter.IsString()) {
+        return filter.MayOverlap(statistics.min_string, statistics.max_string);
+    }
+    if (!HasIntegerValue(column.type)) {
+        return true;
+    }
+    return filter.MayOverlap(statistics.min_int, statistics.max_int);
+}
 }  // namespace
 
 bool PredicateMayMatch(bruh::BruhBatchReader& reader, size_t row_group, const Expression& expr) {
@@ -158,8 +184,43 @@ bool PredicateMayMatch(bruh::BruhBatchReader& reader, size_t row_group, const Ex
             return ColumnBoolMayMatch(reader, row_group, static_cast<const ColumnExpr&>(expr));
         case ExpressionType::Contains:
             return ContainsMayMatch(reader, row_group, static_cast<const ContainsExpr&>(expr));
+        case ExpressionType::RuntimeFilter:
+            return RuntimeFilterMayMatch(reader, row_group,
+                                         static_cast<const RuntimeFilterExpr&>(expr));
         default:
             return true;
     }
 }
+
+bool TopNMayImprove(bruh::BruhBatchReader& reader, size_t row_group, const ColumnExpr& column,
+                    const TopNThreshold& threshold) {
+    // NULLs sort first. Doubles are not pruned since NaN sorts last and is not counted in the
+    // statistics
+    if (!threshold.active || column.type == core::DataType::Double ||
+        column.type == core::DataType::Bool) {
+        return true;
+    }
+    auto& statistics = ColumnStatistics(reader, row_group, column);
+    if (!statistics.present) {
+        return true;
+    }
+    if (threshold.is_null) {
+        return !threshold.ascending || statistics.nulls_count != 0;
+    }
+    if (threshold.ascending && statistics.nulls_count != 0) {
+        return true;
+    }
+    if (!statistics.has_min_max) {
+        return false;
+    }
+    if (column.type == core::DataType::String) {
+        return threshold.ascending ? statistics.min_string <= threshold.string_value
+                                   : statistics.max_string >= threshold.string_value;
+    }
+    if (!HasIntegerValue(column.type)) {
+        return true;
+    }
+    return threshold.ascending ? statistics.min_int <= threshold.int_value
+                               : statistics.max_int >= threshold.int_value;
+}
 }  // namespace columnar::exec
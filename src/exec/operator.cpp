@@ -1,17 +1,25 @@
 #include <exec/operator.h>
 
 #include <core/columns/numeric_column.h>
+#include <exec/expression/builders.h>
 #include <exec/expression/eval.h>
 #include <exec/filter_operator.h>
 #include <exec/global_aggregate_operator.h>
 #include <exec/hash_aggregate_operator.h>
+#include <exec/hash_join_operator.h>
 #include <exec/kernel.h>
+#include <exec/late_materialize_operator.h>
+#include <exec/limit_operator.h>
 #include <exec/metadata_pruning.h>
 #include <exec/operator_visit.h>
 #include <exec/project_operator.h>
+#include <exec/sort_operator.h>
 #include <exec/topn_operator.h>
 #include <util/macro.h>
 
+#include <algorithm>
+#include <functional>
+
 namespace columnar::exec {
 void CollectSink::Consume(core::Batch batch) {
     if (batch.HasSelection()) {
@@ -21,6 +29,13 @@ void CollectSink::Consume(core::Batch batch) {
 }
 
 namespace {
+// Decides before a row group is read whether the scan may skip it, false skips the group
+using RowGroupFilter = std::function<bool(size_t row_group)>;
+
+// A TopN returning at most this many rows reads the columns it does not sort or filter by only
+// for the rows it returns
+constexpr size_t kLateMaterializeMaxRows = 1024;
+
 std::vector<std::string> ScanColumnNames(const ScanOperator& scan) {
     std::vector<std::string> columns;
     columns.reserve(scan.schema.FieldsCount());
@@ -30,35 +45,97 @@ std::vector<std::string> ScanColumnNames(const ScanOperator& scan) {
     return columns;
 }
 
+core::Schema MakeCountSchema(const CountTableOperator& op) {
+    return core::Schema({core::Field(op.output_name, core::DataType::Int64)});
+}
+
 core::Batch MakeCountBatch(const CountTableOperator& op, uint64_t rows) {
-    core::Schema schema({core::Field(op.output_name, core::DataType::Int64)});
-    core::Batch batch(schema, 1);
+    core::Batch batch(MakeCountSchema(op), 1);
     static_cast<core::Int64Column&>(batch.ColumnAt(0)).Append(static_cast<int64_t>(rows));
     return batch;
 }
 
+core::Batch ReadScanRowGroup(bruh::BruhBatchReader& reader, const ScanOperator& scan,
+                             size_t group, const std::vector<size_t>& column_indexes) {
+    auto batch = reader.ReadRowGroup(group, column_indexes);
+    if (!scan.row_ids) {
+        return batch;
+    }
+    auto fields = batch.GetSchema().GetFields();
+    fields.emplace_back(std::string(kRowIdColumn), core::DataType::Int64);
+    core::Batch with_ids(core::Schema(std::move(fields)));
+    size_t rows = batch.RowsCount();
+    for (size_t c = 0; c < batch.ColumnsCount(); ++c) {
+        with_ids.GetColumns()[c] = std::move(batch.GetColumns()[c]);
+    }
+    auto& ids = static_cast<core::Int64Column&>(with_ids.ColumnAt(batch.ColumnsCount()));
+    int64_t* data = ids.AppendZeros(rows);
+    for (size_t row = 0; row < rows; ++row) {
+        data[row] = static_cast<int64_t>((static_cast<uint64_t>(group) << 32) | row);
+    }
+    return with_ids;
+}
+
 void ExecuteScanInto(bruh::BruhBatchReader& reader, const ScanOperator& scan,
-                     IOperator& downstream) {
+                     IOperator& downstream, const RowGroupFilter& row_group_filter) {
     auto column_indexes = reader.ResolveColumnNames(ScanColumnNames(scan));
-    for (size_t group = 0; group < reader.NumRowGroups(); ++group) {
-        downstream.Consume(reader.ReadRowGroup(group, column_indexes));
+    for (size_t group = 0; group < reader.NumRowGroups() && !downstream.Done(); ++group) {
+        if (row_group_filter && !row_group_filter(group)) {
+            continue;
+        }
+        downstream.Consume(ReadScanRowGroup(reader, scan, group, column_indexes));
     }
     downstream.Finalize();
 }
 
 void ExecuteFilterScanInto(bruh::BruhBatchReader& reader, const ScanOperator& scan,
-                           const std::shared_ptr<Expression>& condition, IOperator& downstream) {
+                           const std::shared_ptr<Expression>& condition, IOperator& downstream,
+                           const RowGroupFilter& row_group_filter) {
     auto column_indexes = reader.ResolveColumnNames(ScanColumnNames(scan));
     FilterSink sink(downstream, condition);
-    for (size_t group = 0; group < reader.NumRowGroups(); ++group) {
-        if (!PredicateMayMatch(reader, group, *condition)) {
+    for (size_t group = 0; group < reader.NumRowGroups() && !sink.Done(); ++group) {
+        if (!PredicateMayMatch(reader, group, *condition) ||
+            (row_group_filter && !row_group_filter(group))) {
             continue;
         }
-        sink.Consume(reader.ReadRowGroup(group, column_indexes));
+        sink.Consume(ReadScanRowGroup(reader, scan, group, column_indexes));
     }
     sink.Finalize();
 }
 
+// Whether op is a scan under zero or more filters
+bool IsFilteredScan(const Operator* op) {
+    while (op->type == OperatorType::Filter) {
+        op = static_cast<const FilterOperator&>(*op).child.get();
+    }
+    return op->type == OperatorType::Scan;
+}
+
+// The scan column a TopN sorts by first, if only filters lie between the TopN and the scan
+const ColumnExpr* TopNScanColumn(const TopNOperator& topn) {
+    if (!topn.limit || topn.sort_units.empty() ||
+        topn.sort_units[0].expression->type != ExpressionType::Column ||
+        !IsFilteredScan(topn.child.get())) {
+        return nullptr;
+    }
+    return static_cast<const ColumnExpr*>(topn.sort_units[0].expression.get());
+}
+
+// Adds condition to the filters of a filtered scan, checked together with the filter right
+// above the scan
+std::shared_ptr<Operator> AddScanCondition(const std::shared_ptr<Operator>& op,
+                                           std::shared_ptr<Expression> condition) {
+    if (op->type == OperatorType::Scan) {
+        return MakeFilter(op, std::move(condition));
+    }
+    auto& filter = static_cast<const FilterOperator&>(*op);
+    if (filter.child->type == OperatorType::Scan) {
+        return MakeFilter(filter.child,
+                          MakeBinary(BinaryFunction::And, std::move(condition), filter.condition));
+    }
+    return MakeFilter(AddScanCondition(filter.child, std::move(condition)), filter.condition);
+}
+
 void PlanRec(const std::shared_ptr<Operator>& op, const core::Schema& table_schema,
              std::vector<std::string> required_columns);
 
@@ -69,7 +146,12 @@ struct PlanVisitor {
     void Visit(ScanOperator& scan) const {
         std::vector<core::Field> fields;
         fields.reserve(required_columns.size());
+        scan.row_ids = false;
         for (auto& name : required_columns) {
+            if (name == kRowIdColumn) {
+                scan.row_ids = true;
+                continue;
+            }
             auto* field = table_schema.FindField(name);
             if (field == nullptr) {
                 THROW_RUNTIME_ERROR("Unknown field: " + name);
@@ -122,11 +204,61 @@ struct PlanVisitor {
     }
 
     void Visit(TopNOperator& topn) const {
+        topn.late_columns.clear();
+        if (topn.limit && *topn.limit + topn.offset.value_or(0) <= kLateMaterializeMaxRows &&
+            IsFilteredScan(topn.child.get())) {
+            std::vector<std::string> early_columns;
+            for (auto& unit : topn.sort_units) {
+                CollectColumns(*unit.expression, early_columns);
+            }
+            for (const Operator* op = topn.child.get(); op->type == OperatorType::Filter;
+                 op = static_cast<const FilterOperator&>(*op).child.get()) {
+                CollectColumns(*static_cast<const FilterOperator&>(*op).condition, early_columns);
+            }
+            for (auto& name : required_columns) {
+                if (std::find(early_columns.begin(), early_columns.end(), name) ==
+                    early_columns.end()) {
+                    topn.late_columns.push_back(name);
+                }
+            }
+        }
+        if (!topn.late_columns.empty()) {
+            std::erase_if(required_columns, [&](const std::string& name) {
+                return std::find(topn.late_columns.begin(), topn.late_columns.end(), name) !=
+                       topn.late_columns.end();
+            });
+            required_columns.emplace_back(kRowIdColumn);
+        }
         for (auto& unit : topn.sort_units) {
             CollectColumns(*unit.expression, required_columns);
         }
         PlanRec(topn.child, table_schema, std::move(required_columns));
     }
+
+    void Visit(SortOperator& sort) const {
+        for (auto& unit : sort.sort_units) {
+            CollectColumns(*unit.expression, required_columns);
+        }
+        PlanRec(sort.child, table_schema, std::move(required_columns));
+    }
+
+    void Visit(LimitOperator& limit) const {
+        PlanRec(limit.child, table_schema, std::move(required_columns));
+    }
+
+    // Columns the table does not have are left to the build side, which is planned on its own
+    void Visit(HashJoinOperator& join) const {
+        std::vector<std::string> probe_required;
+        for (auto& name : required_columns) {
+            if (table_schema.HasField(name)) {
+                probe_required.push_back(name);
+            }
+        }
+        for (auto& key : join.probe_keys) {
+            CollectColumns(*key, probe_required);
+        }
+        PlanRec(join.probe, table_schema, std::move(probe_required));
+    }
 };
 
 void PlanRec(const std::shared_ptr<Operator>& op, const core::Schema& table_schema,
@@ -135,15 +267,105 @@ void PlanRec(const std::shared_ptr<Operator>& op, const core::Schema& table_sche
     VisitOperator(*op, visitor);
 }
 
+core::Schema OutputSchema(bruh::BruhBatchReader& reader, const Operator& op);
+
+core::Schema JoinBuildSchema(const JoinBuild& build) {
+    if (build.reader == nullptr) {
+        return build.schema;
+    }
+    PlanRec(build.plan, build.reader->GetSchema(), {});
+    return OutputSchema(*build.reader, *build.plan);
+}
+
+// The schema of the batches a planned operator outputs, known before any of them is produced
+struct OutputSchemaVisitor {
+    bruh::BruhBatchReader& reader;
+    core::Schema& schema;
+
+    void Visit(const ScanOperator& scan) const {
+        schema = scan.schema;
+        if (scan.row_ids) {
+            schema.AddField(core::Field(std::string(kRowIdColumn), core::DataType::Int64));
+        }
+    }
+
+    void Visit(const CountTableOperator& count) const {
+        schema = MakeCountSchema(count);
+    }
+
+    void Visit(const GlobalAggregationOperator& aggregate) const {
+        schema = MakeAggregationSchema(aggregate.aggregations);
+    }
+
+    void Visit(const HashAggregationOperator& aggregate) const {
+        schema = MakeHashAggregateSchema(aggregate.keys, aggregate.aggregations);
+    }
+
+    void Visit(const FilterOperator& filter) const {
+        schema = OutputSchema(reader, *filter.child);
+    }
+
+    void Visit(const ProjectOperator& project) const {
+        schema = MakeProjectionSchema(project.projections, OutputSchema(reader, *project.child));
+    }
+
+    // Late columns replace the row ids and follow the other columns
+    void Visit(const TopNOperator& topn) const {
+        schema = OutputSchema(reader, *topn.child);
+        if (topn.late_columns.empty()) {
+            return;
+        }
+        std::vector<core::Field> fields;
+        for (auto& field : schema.GetFields()) {
+            if (field.name != kRowIdColumn) {
+                fields.push_back(field);
+            }
+        }
+        auto late_schema = reader.ProjectSchema(reader.ResolveColumnNames(topn.late_columns));
+        for (auto& field : late_schema.GetFields()) {
+            fields.push_back(field);
+        }
+        schema = core::Schema(std::move(fields));
+    }
+
+    void Visit(const SortOperator& sort) const {
+        schema = OutputSchema(reader, *sort.child);
+    }
+
+    void Visit(const LimitOperator& limit) const {
+        schema = OutputSchema(reader, *limit.child);
+    }
+
+    void Visit(const HashJoinOperator& join) const {
+        schema = OutputSchema(reader, *join.probe);
+        if (join.join_type == JoinType::Semi || join.join_type == JoinType::Anti) {
+            return;
+        }
+        for (auto field : JoinBuildSchema(join.build).GetFields()) {
+            field.nullable = field.nullable || join.join_type == JoinType::Left;
+            schema.AddField(std::move(field));
+        }
+    }
+};
+
+core::Schema OutputSchema(bruh::BruhBatchReader& reader, const Operator& op) {
+    core::Schema schema;
+    OutputSchemaVisitor visitor{reader, schema};
+    VisitOperator(op, visitor);
+    return schema;
+}
+
 void ExecuteInto(bruh::BruhBatchReader& reader, const std::shared_ptr<Operator>& op,
-                 IOperator& downstream);
+                 IOperator& downstream, const RowGroupFilter& row_group_filter = {});
 
 struct ExecuteVisitor {
     bruh::BruhBatchReader& reader;
     IOperator& downstream;
+    // Passed through filters down to the scan
+    const RowGroupFilter& row_group_filter;
 
     void Visit(const ScanOperator& scan) const {
-        ExecuteScanInto(reader, scan, downstream);
+        ExecuteScanInto(reader, scan, downstream, row_group_filter);
     }
 
     void Visit(const CountTableOperator& count) const {
@@ -157,18 +379,19 @@ struct ExecuteVisitor {
     }
 
     void Visit(const HashAggregationOperator& aggregate) const {
-        HashAggregationSink sink(downstream, aggregate.keys, aggregate.aggregations);
+        HashAggregationSink sink(downstream, aggregate.keys, aggregate.aggregations,
+                                 aggregate.options);
         ExecuteInto(reader, aggregate.child, sink);
     }
 
     void Visit(const FilterOperator& filter) const {
         if (filter.child->type == OperatorType::Scan) {
             ExecuteFilterScanInto(reader, static_cast<const ScanOperator&>(*filter.child),
-                                  filter.condition, downstream);
+                                  filter.condition, downstream, row_group_filter);
             return;
         }
         FilterSink sink(downstream, filter.condition);
-        ExecuteInto(reader, filter.child, sink);
+        ExecuteInto(reader, filter.child, sink, row_group_filter);
     }
 
     void Visit(const ProjectOperator& project) const {
@@ -177,14 +400,63 @@ struct ExecuteVisitor {
     }
 
     void Visit(const TopNOperator& topn) const {
-        TopNSink sink(downstream, topn.sort_units, topn.limit, topn.offset);
-        ExecuteInto(reader, topn.child, sink);
+        if (!topn.late_columns.empty()) {
+            LateMaterializeSink late(reader, downstream,
+                                     reader.ResolveColumnNames(topn.late_columns));
+            ExecuteTopNInto(topn, late);
+            return;
+        }
+        ExecuteTopNInto(topn, downstream);
+    }
+
+    void ExecuteTopNInto(const TopNOperator& topn, IOperator& out) const {
+        TopNSink sink(out, topn.sort_units, topn.limit, topn.offset);
+        // Row groups that cannot beat the current threshold of the sink are not read
+        RowGroupFilter may_improve;
+        if (const ColumnExpr* column = TopNScanColumn(topn)) {
+            may_improve = [this, column, &sink](size_t row_group) {
+                return TopNMayImprove(reader, row_group, *column, sink.Threshold());
+            };
+        }
+        ExecuteInto(reader, topn.child, sink, may_improve);
+    }
+
+    void Visit(const SortOperator& sort) const {
+        SortSink sink(downstream, sort.sort_units, sort.options);
+        ExecuteInto(reader, sort.child, sink);
+    }
+
+    void Visit(const LimitOperator& limit) const {
+        LimitSink sink(downstream, limit.limit, limit.offset.value_or(0));
+        // Skipping row groups below the limit would change which rows come first
+        ExecuteInto(reader, limit.child, sink);
+    }
+
+    void Visit(const HashJoinOperator& join) const {
+        std::vector<core::Batch> executed;
+        if (join.build.reader != nullptr) {
+            executed = Execute(*join.build.reader, join.build.plan);
+        }
+        const auto& build = join.build.reader != nullptr ? executed : join.build.batches;
+        HashJoinSink sink(downstream, build, JoinBuildSchema(join.build), join.probe_keys,
+                          join.build_keys, join.join_type);
+        // The build keys are checked at the probe scan, which also skips the row groups whose
+        // statistics rule all of them out
+        auto probe = join.probe;
+        if (join.probe_keys.size() == 1 && join.probe_keys[0]->type == ExpressionType::Column &&
+            IsFilteredScan(probe.get())) {
+            if (auto filter = sink.KeyFilter()) {
+                probe = AddScanCondition(probe,
+                                         MakeRuntimeFilter(join.probe_keys[0], std::move(filter)));
+            }
+        }
+        ExecuteInto(reader, probe, sink);
     }
 };
 
 void ExecuteInto(bruh::BruhBatchReader& reader, const std::shared_ptr<Operator>& op,
-                 IOperator& downstream) {
-    ExecuteVisitor visitor{reader, downstream};
+                 IOperator& downstream, const RowGroupFilter& row_group_filter) {
+    ExecuteVisitor visitor{reader, downstream, row_group_filter};
     VisitOperator(*op, visitor);
 }
 }  // namespace
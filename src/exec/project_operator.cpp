@@ -4,8 +4,7 @@
 #include <exec/column_row_access.h>
 #include <exec/expression/types.h>
 #include <exec/expression/eval.h>
-#include <exec/expression/utils.h>
-#include <exec/kernel.h>
+#include <exec/selection.h>
 
 #include <utility>
 
@@ -19,6 +18,7 @@ bool ProjectionNullable(const ProjectionUnit& unit, const core::Schema& input_sc
     return unit.expression->type != ExpressionType::ConstInt64 &&
            unit.expression->type != ExpressionType::ConstString;
 }
+}  // namespace
 
 core::Schema MakeProjectionSchema(const std::vector<ProjectionUnit>& projections,
                                   const core::Schema& input_schema) {
@@ -30,35 +30,20 @@ core::Schema MakeProjectionSchema(const std::vector<ProjectionUnit>& projections
     }
     return core::Schema(std::move(fields));
 }
-}  // namespace
 
 ProjectSink::ProjectSink(IOperator& downstream, std::vector<ProjectionUnit> projections)
     : downstream_(downstream),
-      projections_(std::move(projections)),
-      needs_dense_(RequiresDenseBatch(projections_)) {
+      projections_(std::move(projections)) {
 }
 
 void ProjectSink::Consume(core::Batch batch) {
-    if (batch.HasSelection() && needs_dense_) {
-        batch = kernel::Materialize(batch);
-    }
-    size_t rows = batch.RowsCount();
-    const std::vector<uint32_t>* selection = batch.HasSelection() ? &batch.Selection() : nullptr;
     auto output_schema = MakeProjectionSchema(projections_, batch.GetSchema());
     core::Batch out(std::move(output_schema), batch.SelectedRowsCount());
     for (size_t i = 0; i < projections_.size(); ++i) {
         auto eval = Evaluate(batch, *projections_[i].expression);
         auto& src = eval.Get();
         auto& dst = out.ColumnAt(i);
-        if (selection != nullptr) {
-            for (uint32_t row : *selection) {
-                AppendRow(dst, src, row);
-            }
-        } else {
-            for (size_t row = 0; row < rows; ++row) {
-                AppendRow(dst, src, row);
-            }
-        }
+        ForSelectedRows(batch, [&](size_t row) { AppendRow(dst, src, row); });
     }
     downstream_.Consume(std::move(out));
 }
@@ -0,0 +1,126 @@
+#include <exec/runtime_filter.h>
+
+#include <core/datatype.h>
+#include <exec/column_row_access.h>
+
+#include <absl/strings/string_view.h>
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace columnar::exec {
+namespace {
+constexpr size_t kBloomBitsPerKey = 16;
+constexpr size_t kBloomBits = 4;
+
+uint64_t MixHash(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+uint64_t HashKey(int64_t key) {
+    return MixHash(static_cast<uint64_t>(key));
+}
+
+uint64_t HashKey(std::string_view key) {
+    return MixHash(std::hash<std::string_view>{}(key));
+}
+
+// The low bits of the hash pick the word, kBloomBits groups of 6 bits above them pick the bits
+uint64_t BloomMask(uint64_t hash) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < kBloomBits; ++i) {
+        mask |= uint64_t{1} << ((hash >> (40 + 6 * i)) & 63);
+    }
+    return mask;
+}
+}  // namespace
+
+RuntimeFilter::RuntimeFilter(const core::Column& keys)
+    : is_string_(keys.GetDataType() == core::DataType::String),
+      keys_count_(keys.Size()),
+      exact_(keys_count_ <= kMaxExactKeys) {
+    if (!exact_) {
+        bloom_.assign(std::bit_ceil((keys_count_ * kBloomBitsPerKey + 63) / 64), 0);
+    }
+    for (size_t row = 0; row < keys_count_; ++row) {
+        if (is_string_) {
+            auto key = ReadStringRow(keys, row);
+            if (row == 0 || key < min_string_) {
+                min_string_ = key;
+            }
+            if (row == 0 || key > max_string_) {
+                max_string_ = key;
+            }
+            if (exact_) {
+                strings_.emplace(key);
+            } else {
+                AddToBloom(HashKey(key));
+            }
+        } else {
+            int64_t key = ReadIntegerRow(keys, row);
+            min_int_ = row == 0 ? key : std::min(min_int_, key);
+            max_int_ = row == 0 ? key : std::max(max_int_, key);
+            if (exact_) {
+                ints_.insert(key);
+            } else {
+                AddToBloom(HashKey(key));
+            }
+        }
+    }
+}
+
+void RuntimeFilter::AddToBloom(uint64_t hash) {
+    bloom_[hash & (bloom_.size() - 1)] |= BloomMask(hash);
+}
+
+bool RuntimeFilter::BloomMayContain(uint64_t hash) const {
+    uint64_t mask = BloomMask(hash);
+    return (bloom_[hash & (bloom_.size() - 1)] & mask) == mask;
+}
+
+bool RuntimeFilter::MayContain(int64_t key) const {
+    if (IsEmpty() || key < min_int_ || key > max_int_) {
+        return false;
+    }
+    return exact_ ? ints_.contains(key) : BloomMayContain(HashKey(key));
+}
+
+bool RuntimeFilter::MayContain(std::string_view key) const {
+    if (IsEmpty() || key < min_string_ || key > max_string_) {
+        return false;
+    }
+    if (exact_) {
+        // The set hashes absl::string_view, which this absl does not alias to std::string_view
+        return strings_.contains(absl::string_view(key.data(), key.size()));
+    }
+    return BloomMayContain(HashKey(key));
+}
+
+bool RuntimeFilter::MayOverlap(int64_t min, int64_t max) const {
+    if (IsEmpty() || max < min_int_ || min > max_int_) {
+        return false;
+    }
+    if (!exact_) {
+        return true;
+    }
+    return std::any_of(ints_.begin(), ints_.end(),
+                       [&](int64_t key) { return min <= key && key <= max; });
+}
+
+bool RuntimeFilter::MayOverlap(std::string_view min, std::string_view max) const {
+    if (IsEmpty() || max < min_string_ || min > max_string_) {
+        return false;
+    }
+    if (!exact_) {
+        return true;
+    }
+    return std::any_of(strings_.begin(), strings_.end(),
+                       [&](const std::string& key) { return min <= key && key <= max; });
+}
+}  // namespace columnar::exec
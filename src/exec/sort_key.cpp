@@ -0,0 +1,169 @@
+#include <exec/sort_key.h>
+
+#include <core/datatype.h>
+#include <exec/column_dispatch.h>
+#include <exec/column_row_access.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace columnar::exec {
+namespace {
+constexpr uint8_t kNullByte = 0x00;
+constexpr uint8_t kValueByte = 0x01;
+
+void StoreBigEndian(uint64_t value, uint8_t* out) {
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * (sizeof(value) - 1 - i)));
+    }
+}
+
+uint64_t NormalizeInteger(int64_t value) {
+    return static_cast<uint64_t>(value) ^ (uint64_t{1} << 63);
+}
+
+// Negative doubles have all bits inverted, the others only the sign bit, so that the unsigned
+// order of the bits is the numeric order. -0.0 is stored as 0.0, since the two compare equal, and
+// every NaN as the positive quiet NaN, which sorts after +inf
+uint64_t NormalizeDouble(double value) {
+    if (value == 0) {
+        value = 0;
+    } else if (std::isnan(value)) {
+        value = std::numeric_limits<double>::quiet_NaN();
+    }
+    auto bits = std::bit_cast<uint64_t>(value);
+    return (bits & (uint64_t{1} << 63)) != 0 ? ~bits : bits | (uint64_t{1} << 63);
+}
+
+size_t EncodedStringSize(std::string_view value) {
+    return value.size() + static_cast<size_t>(std::count(value.begin(), value.end(), '\0')) + 2;
+}
+
+uint8_t* EncodeString(std::string_view value, uint8_t* out) {
+    for (char c : value) {
+        *out++ = static_cast<uint8_t>(c);
+        if (c == '\0') {
+            *out++ = 0xFF;
+        }
+    }
+    *out++ = 0x00;
+    *out++ = 0x00;
+    return out;
+}
+}  // namespace
+
+void NormalizedKeys::Append(const std::vector<SortUnit>& sort_units,
+                            const std::vector<const core::Column*>& key_cols, size_t rows) {
+    Append(sort_units, key_cols, nullptr, rows);
+}
+
+void NormalizedKeys::Append(const std::vector<SortUnit>& sort_units,
+                            const std::vector<const core::Column*>& key_cols,
+                            const std::vector<uint32_t>* selection, size_t rows) {
+    size_t count = selection != nullptr ? selection->size() : rows;
+    auto row_at = [&](size_t i) -> size_t { return selection != nullptr ? (*selection)[i] : i; };
+    size_t first = Size();
+    offsets_.resize(first + count + 1, 0);
+    size_t* sizes = offsets_.data() + first + 1;
+    for (const core::Column* col : key_cols) {
+        bool is_string = col->GetDataType() == core::DataType::String;
+        for (size_t i = 0; i < count; ++i) {
+            size_t row = row_at(i);
+            sizes[i] += 1;
+            if (col->IsNull(row)) {
+                continue;
+            }
+            sizes[i] += is_string ? EncodedStringSize(ReadStringRow(*col, row)) : 8;
+        }
+    }
+    for (size_t i = first + 1; i < offsets_.size(); ++i) {
+        offsets_[i] += offsets_[i - 1];
+    }
+    bytes_.resize(offsets_.back());
+
+    std::vector<size_t> cursors(offsets_.begin() + static_cast<ptrdiff_t>(first),
+                                offsets_.end() - 1);
+    for (size_t s = 0; s < key_cols.size(); ++s) {
+        const core::Column& col = *key_cols[s];
+        auto type = col.GetDataType();
+        for (size_t i = 0; i < count; ++i) {
+            size_t row = row_at(i);
+            uint8_t* out = bytes_.data() + cursors[i];
+            uint8_t* begin = out;
+            if (col.IsNull(row)) {
+                *out++ = kNullByte;
+            } else {
+                *out++ = kValueByte;
+                if (type == core::DataType::String) {
+                    out = EncodeString(ReadStringRow(col, row), out);
+                } else if (type == core::DataType::Double) {
+                    StoreBigEndian(NormalizeDouble(ReadDoubleRow(col, row)), out);
+                    out += 8;
+                } else {
+                    StoreBigEndian(NormalizeInteger(ReadIntegerRow(col, row)), out);
+                    out += 8;
+                }
+            }
+            if (!sort_units[s].ascending) {
+                for (uint8_t* p = begin; p != out; ++p) {
+                    *p = static_cast<uint8_t>(~*p);
+                }
+            }
+            cursors[i] = static_cast<size_t>(out - bytes_.data());
+        }
+    }
+}
+
+void NormalizedKeys::AppendKey(std::string_view key) {
+    bytes_.insert(bytes_.end(), key.begin(), key.end());
+    offsets_.push_back(bytes_.size());
+}
+
+uint64_t NormalizedKeys::Prefix(size_t i) const noexcept {
+    uint8_t buf[8] = {};
+    size_t size = std::min<size_t>(sizeof(buf), offsets_[i + 1] - offsets_[i]);
+    std::memcpy(buf, bytes_.data() + offsets_[i], size);
+    uint64_t prefix = 0;
+    for (uint8_t byte : buf) {
+        prefix = (prefix << 8) | byte;
+    }
+    return prefix;
+}
+
+std::vector<uint32_t> NormalizedKeys::SortedOrder() const {
+    struct Entry {
+        uint64_t prefix;
+        uint32_t index;
+    };
+    std::vector<Entry> entries(Size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        entries[i] = {Prefix(i), static_cast<uint32_t>(i)};
+    }
+    std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+        if (a.prefix != b.prefix) {
+            return a.prefix < b.prefix;
+        }
+        int cmp = Key(a.index).compare(Key(b.index));
+        return cmp != 0 ? cmp < 0 : a.index < b.index;
+    });
+    std::vector<uint32_t> order;
+    order.reserve(entries.size());
+    for (auto& entry : entries) {
+        order.push_back(entry.index);
+    }
+    return order;
+}
+
+int CompareNormalizedKeys(const NormalizedKeys& a, size_t i, const NormalizedKeys& b,
+                          size_t j) noexcept {
+    uint64_t prefix_a = a.Prefix(i);
+    uint64_t prefix_b = b.Prefix(j);
+    if (prefix_a != prefix_b) {
+        return prefix_a < prefix_b ? -1 : 1;
+    }
+    return a.Key(i).compare(b.Key(j));
+}
+}  // namespace columnar::exec
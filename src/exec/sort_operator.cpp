@@ -0,0 +1,254 @@
+#include <exec/sort_operator.h>
+
+#include <core/datatype.h>
+#include <core/field.h>
+#include <exec/column_row_access.h>
+#include <exec/expression/eval.h>
+#include <exec/kernel.h>
+#include <exec/sort_key.h>
+#include <util/byte_buffer.h>
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace columnar::exec {
+namespace {
+constexpr size_t kSortOutputBatchRows = 65536;
+// Rows decoded from a run at a time during the merge
+constexpr size_t kMergeChunkRows = 1024;
+
+size_t EstimateBatchBytes(const core::Batch& batch) {
+    size_t bytes = 0;
+    for (size_t c = 0; c < batch.ColumnsCount(); ++c) {
+        const auto& col = batch.ColumnAt(c);
+        bytes += col.Size() * sizeof(int64_t);
+        if (col.GetDataType() == core::DataType::String) {
+            for (size_t row = 0; row < col.Size(); ++row) {
+                bytes += ReadStringRow(col, row).size();
+            }
+        }
+    }
+    return bytes;
+}
+
+// Tournament tree over k sources that keeps the loser of every match in the inner nodes, so that
+// replacing the winner replays only the log2(k) matches on its path. beats(a, b) tells whether
+// source a is taken before source b
+template <typename Beats>
+class LoserTree {
+public:
+    LoserTree(size_t k, Beats beats) : k_(k), beats_(std::move(beats)), tree_(k, k) {
+        for (size_t source = k; source-- > 0;) {
+            Replay(source);
+        }
+    }
+
+    size_t Winner() const {
+        return tree_[0];
+    }
+
+    // Replays the matches of source after its head has changed
+    void Replay(size_t source) {
+        for (size_t node = (source + k_) / 2; node > 0; node /= 2) {
+            if (Wins(tree_[node], source)) {
+                std::swap(source, tree_[node]);
+            }
+        }
+        tree_[0] = source;
+    }
+
+private:
+    // Source k stands for an empty slot that beats everything while the tree is built
+    bool Wins(size_t a, size_t b) {
+        if (a == k_ || b == k_) {
+            return a == k_;
+        }
+        return beats_(a, b);
+    }
+
+    size_t k_;
+    Beats beats_;
+    std::vector<size_t> tree_;
+};
+
+struct RunCursor {
+    SpillFile* run;
+    std::vector<uint8_t> key_bytes;
+    std::vector<size_t> key_offsets;
+    core::Batch rows;
+    size_t pos = 0;
+    bool done = false;
+
+    std::string_view Key() const {
+        return {reinterpret_cast<const char*>(key_bytes.data()) + key_offsets[pos],
+                key_offsets[pos + 1] - key_offsets[pos]};
+    }
+};
+}  // namespace
+
+SortSink::SortSink(IOperator& downstream, std::vector<SortUnit> sort_units, SortOptions options)
+    : downstream_(downstream),
+      sort_units_(std::move(sort_units)),
+      options_(std::move(options)) {
+}
+
+void SortSink::Consume(core::Batch batch) {
+    if (batch.SelectedRowsCount() == 0) {
+        return;
+    }
+    if (batch.HasSelection()) {
+        batch = kernel::Materialize(batch);
+    }
+    if (!has_schema_) {
+        schema_ = batch.GetSchema();
+        has_schema_ = true;
+    }
+    buffered_bytes_ += EstimateBatchBytes(batch);
+    buffer_.push_back(std::move(batch));
+    if (options_.memory_budget != 0 && buffered_bytes_ > options_.memory_budget) {
+        SpillRun();
+    }
+}
+
+template <typename Emit>
+void SortSink::SortBuffer(Emit&& emit) {
+    NormalizedKeys keys;
+    std::vector<RowRef> refs;
+    for (size_t b = 0; b < buffer_.size(); ++b) {
+        std::vector<EvalResult> key_evals;
+        std::vector<const core::Column*> key_cols;
+        key_evals.reserve(sort_units_.size());
+        for (auto& unit : sort_units_) {
+            key_evals.emplace_back(Evaluate(buffer_[b], *unit.expression));
+            key_cols.push_back(&key_evals.back().Get());
+        }
+        keys.Append(sort_units_, key_cols, buffer_[b].RowsCount());
+        for (size_t row = 0; row < buffer_[b].RowsCount(); ++row) {
+            refs.push_back({static_cast<uint32_t>(b), static_cast<uint32_t>(row)});
+        }
+    }
+
+    for (uint32_t index : keys.SortedOrder()) {
+        const RowRef& ref = refs[index];
+        emit(buffer_[ref.batch_idx], ref.row_idx, keys.Key(index));
+    }
+}
+
+// Record: [u32 key size][normalized key][encoded row]
+void SortSink::SpillRun() {
+    runs_.push_back(std::make_unique<SpillFile>(options_.spill_directory));
+    SpillFile& run = *runs_.back();
+    std::vector<uint8_t> record;
+    SortBuffer([&](const core::Batch& batch, size_t row, std::string_view key) {
+        record.clear();
+        util::BufWriter w(record);
+        w.Write<uint32_t>(static_cast<uint32_t>(key.size()));
+        w.WriteRaw(key.data(), key.size());
+        for (size_t c = 0; c < batch.ColumnsCount(); ++c) {
+            EncodeValue(batch.ColumnAt(c), row, w);
+        }
+        run.Append(record);
+    });
+    run.Rewind();
+    buffer_.clear();
+    buffered_bytes_ = 0;
+}
+
+void SortSink::MergeRuns() {
+    std::vector<RunCursor> cursors;
+    cursors.reserve(runs_.size());
+    for (auto& run : runs_) {
+        cursors.push_back(RunCursor{run.get(), {}, {}, core::Batch()});
+    }
+    std::vector<uint8_t> record;
+    auto refill = [&](RunCursor& cursor) {
+        cursor.key_bytes.clear();
+        cursor.key_offsets.assign(1, 0);
+        cursor.rows = core::Batch(schema_, kMergeChunkRows);
+        size_t n = 0;
+        while (n < kMergeChunkRows && cursor.run->Next(record)) {
+            util::BufReader r(record.data(), record.size());
+            auto key_size = r.Read<uint32_t>();
+            const uint8_t* key = r.Take(key_size);
+            cursor.key_bytes.insert(cursor.key_bytes.end(), key, key + key_size);
+            cursor.key_offsets.push_back(cursor.key_bytes.size());
+            for (size_t c = 0; c < cursor.rows.ColumnsCount(); ++c) {
+                DecodeValue(r, cursor.rows.ColumnAt(c));
+            }
+            ++n;
+        }
+        cursor.pos = 0;
+        cursor.done = n == 0;
+    };
+    for (auto& cursor : cursors) {
+        refill(cursor);
+    }
+
+    // Runs hold consecutive parts of the input, so ties are taken from the earlier run
+    LoserTree tree(cursors.size(), [&](size_t a, size_t b) {
+        if (cursors[a].done || cursors[b].done) {
+            return !cursors[a].done;
+        }
+        int cmp = cursors[a].Key().compare(cursors[b].Key());
+        return cmp != 0 ? cmp < 0 : a < b;
+    });
+
+    core::Batch out(schema_, kSortOutputBatchRows);
+    while (!cursors[tree.Winner()].done) {
+        size_t winner = tree.Winner();
+        RunCursor& cursor = cursors[winner];
+        for (size_t c = 0; c < out.ColumnsCount(); ++c) {
+            AppendRow(out.ColumnAt(c), cursor.rows.ColumnAt(c), cursor.pos);
+        }
+        if (++cursor.pos == cursor.rows.RowsCount()) {
+            refill(cursor);
+        }
+        tree.Replay(winner);
+        if (out.RowsCount() == kSortOutputBatchRows) {
+            downstream_.Consume(std::move(out));
+            out = core::Batch(schema_, kSortOutputBatchRows);
+        }
+    }
+    if (out.RowsCount() != 0) {
+        downstream_.Consume(std::move(out));
+    }
+    runs_.clear();
+}
+
+void SortSink::Finalize() {
+    if (!has_schema_) {
+        downstream_.Finalize();
+        return;
+    }
+    if (!runs_.empty()) {
+        if (!buffer_.empty()) {
+            SpillRun();
+        }
+        MergeRuns();
+        downstream_.Finalize();
+        return;
+    }
+
+    size_t rows = 0;
+    for (auto& batch : buffer_) {
+        rows += batch.RowsCount();
+    }
+    core::Batch out(schema_, std::min(rows, kSortOutputBatchRows));
+    SortBuffer([&](const core::Batch& batch, size_t row, std::string_view) {
+        for (size_t c = 0; c < out.ColumnsCount(); ++c) {
+            AppendRow(out.ColumnAt(c), batch.ColumnAt(c), row);
+        }
+        if (out.RowsCount() == kSortOutputBatchRows) {
+            downstream_.Consume(std::move(out));
+            out = core::Batch(schema_, kSortOutputBatchRows);
+        }
+    });
+    if (out.RowsCount() != 0) {
+        downstream_.Consume(std::move(out));
+    }
+    buffer_.clear();
+    downstream_.Finalize();
+}
+}  // namespace columnar::exec
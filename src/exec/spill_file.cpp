@@ -0,0 +1,105 @@
+#include <exec/spill_file.h>
+
+#include <core/datatype.h>
+#include <exec/column_row_access.h>
+#include <util/macro.h>
+
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <string_view>
+#include <system_error>
+
+namespace columnar::exec {
+namespace {
+std::string MakeSpillPath(const std::string& directory) {
+    static std::atomic<uint64_t> counter{0};
+    std::filesystem::path dir = directory.empty() ? std::filesystem::temp_directory_path()
+                                                  : std::filesystem::path(directory);
+    uint64_t token = (static_cast<uint64_t>(std::random_device{}()) << 32) ^ counter++;
+    return (dir / ("columnar-spill-" + std::to_string(token))).string();
+}
+}  // namespace
+
+SpillFile::SpillFile(const std::string& directory)
+    : path_(MakeSpillPath(directory)), buf_(kSpillFileBufSize) {
+    file_.pubsetbuf(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+    if (!file_.open(path_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc)) {
+        THROW_RUNTIME_ERROR("Cannot create spill file " + path_);
+    }
+}
+
+SpillFile::~SpillFile() {
+    file_.close();
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+}
+
+void SpillFile::Append(const std::vector<uint8_t>& record) {
+    auto size = static_cast<uint32_t>(record.size());
+    auto n = static_cast<std::streamsize>(record.size());
+    if (file_.sputn(reinterpret_cast<const char*>(&size), sizeof(size)) != sizeof(size) ||
+        file_.sputn(reinterpret_cast<const char*>(record.data()), n) != n) {
+        THROW_RUNTIME_ERROR("Cannot write spill file " + path_);
+    }
+    ++records_;
+}
+
+void SpillFile::Rewind() {
+    if (file_.pubsync() != 0 || file_.pubseekpos(0) != std::streampos(0)) {
+        THROW_RUNTIME_ERROR("Cannot rewind spill file " + path_);
+    }
+    records_read_ = 0;
+}
+
+bool SpillFile::Next(std::vector<uint8_t>& record) {
+    if (records_read_ == records_) {
+        return false;
+    }
+    uint32_t size;
+    if (file_.sgetn(reinterpret_cast<char*>(&size), sizeof(size)) != sizeof(size)) {
+        THROW_RUNTIME_ERROR("Spill file " + path_ + " is truncated");
+    }
+    record.resize(size);
+    auto n = static_cast<std::streamsize>(size);
+    if (file_.sgetn(reinterpret_cast<char*>(record.data()), n) != n) {
+        THROW_RUNTIME_ERROR("Spill file " + path_ + " is truncated");
+    }
+    ++records_read_;
+    return true;
+}
+
+void EncodeValue(const core::Column& col, size_t row, util::BufWriter& w) {
+    bool is_null = col.IsNull(row);
+    w.Write<uint8_t>(is_null ? 1 : 0);
+    if (is_null) {
+        return;
+    }
+    auto type = col.GetDataType();
+    if (type == core::DataType::String) {
+        std::string_view value = ReadStringRow(col, row);
+        w.Write<uint32_t>(static_cast<uint32_t>(value.size()));
+        w.WriteRaw(value.data(), value.size());
+    } else if (type == core::DataType::Double) {
+        w.Write<double>(ReadDoubleRow(col, row));
+    } else {
+        w.Write<int64_t>(ReadIntegerRow(col, row));
+    }
+}
+
+void DecodeValue(util::BufReader& r, core::Column& out) {
+    if (r.Read<uint8_t>() != 0) {
+        out.AppendNull();
+        return;
+    }
+    auto type = out.GetDataType();
+    if (type == core::DataType::String) {
+        auto size = r.Read<uint32_t>();
+        out.AppendFromString(std::string_view(reinterpret_cast<const char*>(r.Take(size)), size));
+    } else if (type == core::DataType::Double) {
+        AppendDouble(out, r.Read<double>());
+    } else {
+        AppendInteger(out, r.Read<int64_t>());
+    }
+}
+}  // namespace columnar::exec
@@ -1,16 +1,17 @@
 #include <exec/topn_operator.h>
 
+#include <core/column_factory.h>
 #include <core/columns/string_column.h>
 #include <core/datatype.h>
 #include <core/schema.h>
 #include <exec/column_row_access.h>
-#include <exec/selection.h>
 #include <exec/expression/eval.h>
-#include <exec/expression/utils.h>
-#include <exec/kernel.h>
+#include <exec/selection.h>
+#include <exec/sort_key.h>
 #include <util/macro.h>
 
 #include <algorithm>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -21,35 +22,8 @@ struct RowRef {
     uint32_t row_idx;
 };
 
-template <typename T>
-int Compare3(const T& a, const T& b) {
-    if (a < b) {
-        return -1;
-    }
-    if (a > b) {
-        return 1;
-    }
-    return 0;
-}
-
-int CompareRowRefs(const core::Column& col_a, size_t row_a, const core::Column& col_b,
-                   size_t row_b) {
-    bool a_null = col_a.IsNull(row_a);
-    bool b_null = col_b.IsNull(row_b);
-    if (a_null != b_null) {
-        return a_null ? -1 : 1;
-    }
-    if (a_null) {
-        return 0;
-    }
-    switch (col_a.GetDataType()) {
-        case core::DataType::String:
-            return Compare3(ReadStringRow(col_a, row_a), ReadStringRow(col_b, row_b));
-        case core::DataType::Double:
-            return Compare3(ReadDoubleRow(col_a, row_a), ReadDoubleRow(col_b, row_b));
-        default:
-            return Compare3(ReadIntegerRow(col_a, row_a), ReadIntegerRow(col_b, row_b));
-    }
+const std::vector<uint32_t>* SelectedRows(const core::Batch& batch) {
+    return batch.HasSelection() ? &batch.Selection() : nullptr;
 }
 }  // namespace
 
@@ -58,101 +32,202 @@ TopNSink::TopNSink(IOperator& downstream, std::vector<SortUnit> sort_units,
     : downstream_(downstream),
       sort_units_(std::move(sort_units)),
       limit_(limit),
-      offset_(offset),
-      needs_dense_(RequiresDenseBatch(sort_units_)) {
+      offset_(offset) {
+    if (limit_) {
+        capacity_ = offset_.value_or(0) + *limit_;
+    }
 }
 
 void TopNSink::Consume(core::Batch batch) {
     if (batch.SelectedRowsCount() == 0) {
         return;
     }
-    if (batch.HasSelection() && needs_dense_) {
-        batch = kernel::Materialize(batch);
+    if (limit_) {
+        ConsumeBounded(std::move(batch));
+        return;
     }
     buffer_.push_back(std::move(batch));
 }
 
-void TopNSink::Finalize() {
-    if (buffer_.empty()) {
-        downstream_.Finalize();
-        return;
+// Rows are compared by their normalized sort keys, see NormalizedKeys
+void TopNSink::ConsumeBounded(core::Batch batch) {
+    std::vector<EvalResult> key_evals;
+    key_evals.reserve(sort_units_.size());
+    std::vector<const core::Column*> key_cols;
+    key_cols.reserve(sort_units_.size());
+    for (auto& unit : sort_units_) {
+        key_evals.emplace_back(Evaluate(batch, *unit.expression));
+        key_cols.push_back(&key_evals.back().Get());
     }
-    size_t total_rows = 0;
-    for (auto& b : buffer_) {
-        total_rows += b.SelectedRowsCount();
+    if (!has_rows_) {
+        rows_ = core::Batch(batch.GetSchema());
+        if (!key_cols.empty()) {
+            first_keys_ = core::MakeColumn(key_cols[0]->GetDataType(), true);
+        }
+        has_rows_ = true;
+    }
+    if (capacity_ == 0) {
+        return;
     }
 
-    auto for_each_input_row = [&](auto&& emit) {
-        for (size_t b = 0; b < buffer_.size(); ++b) {
-            const auto& batch = buffer_[b];
-            const std::vector<uint32_t>* sel = batch.HasSelection() ? &batch.Selection() : nullptr;
-            ForSelectedRows(sel, batch.RowsCount(), [&](size_t row) {
-                emit(static_cast<uint32_t>(b), static_cast<uint32_t>(row));
-            });
+    // Key i of batch_keys belongs to the i-th selected row
+    NormalizedKeys batch_keys;
+    batch_keys.Append(sort_units_, key_cols, SelectedRows(batch), batch.RowsCount());
+    auto kept_less = [&](uint32_t a, uint32_t b) {
+        int cmp = CompareNormalizedKeys(keys_, a, keys_, b);
+        return cmp != 0 ? cmp < 0 : sequence_[a] < sequence_[b];
+    };
+    auto keep = [&](size_t row, size_t key) {
+        auto index = static_cast<uint32_t>(sequence_.size());
+        for (size_t c = 0; c < batch.ColumnsCount(); ++c) {
+            AppendRow(rows_.ColumnAt(c), batch.ColumnAt(c), row);
         }
+        if (first_keys_) {
+            AppendRow(*first_keys_, *key_cols[0], row);
+        }
+        keys_.AppendKey(batch_keys.Key(key));
+        sequence_.push_back(rows_seen_);
+        return index;
     };
 
-    std::vector<std::vector<EvalResult>> sort_evals(sort_units_.size());
-    std::vector<std::vector<const core::Column*>> sort_cols(sort_units_.size());
-    for (size_t s = 0; s < sort_units_.size(); ++s) {
-        sort_evals[s].reserve(buffer_.size());
-        sort_cols[s].reserve(buffer_.size());
-        for (auto& batch : buffer_) {
-            sort_evals[s].emplace_back(Evaluate(batch, *sort_units_[s].expression));
-            sort_cols[s].push_back(&sort_evals[s].back().Get());
+    // Later rows lose ties, so a row enters a full heap only if it sorts strictly before the top
+    size_t compact_at = std::max<size_t>(2 * capacity_, 1024);
+    size_t key = 0;
+    ForSelectedRows(batch, [&](size_t row) {
+        if (heap_.size() < capacity_) {
+            heap_.push_back(keep(row, key));
+            std::push_heap(heap_.begin(), heap_.end(), kept_less);
+        } else if (CompareNormalizedKeys(batch_keys, key, keys_, heap_.front()) < 0) {
+            std::pop_heap(heap_.begin(), heap_.end(), kept_less);
+            heap_.back() = keep(row, key);
+            std::push_heap(heap_.begin(), heap_.end(), kept_less);
+            if (sequence_.size() >= compact_at) {
+                CompactRows();
+            }
         }
-    }
+        ++key;
+        ++rows_seen_;
+    });
+    UpdateThreshold();
+}
 
-    auto less = [&](const RowRef& a, const RowRef& b) {
-        for (size_t s = 0; s < sort_units_.size(); ++s) {
-            int cmp = CompareRowRefs(*sort_cols[s][a.batch_idx], a.row_idx,
-                                     *sort_cols[s][b.batch_idx], b.row_idx);
-            if (cmp == 0) {
-                continue;
-            }
-            return sort_units_[s].ascending ? cmp < 0 : cmp > 0;
+// Moves the rows still in the heap to the front, the heap order of their indexes is unchanged
+void TopNSink::CompactRows() {
+    core::Batch rows(rows_.GetSchema(), heap_.size());
+    NormalizedKeys keys;
+    std::unique_ptr<core::Column> first_keys;
+    if (first_keys_) {
+        first_keys = core::MakeColumn(first_keys_->GetDataType(), true);
+    }
+    std::vector<uint64_t> sequence;
+    sequence.reserve(heap_.size());
+    for (size_t i = 0; i < heap_.size(); ++i) {
+        uint32_t index = heap_[i];
+        for (size_t c = 0; c < rows.ColumnsCount(); ++c) {
+            AppendRow(rows.ColumnAt(c), rows_.ColumnAt(c), index);
         }
-        if (a.batch_idx != b.batch_idx) {
-            return a.batch_idx < b.batch_idx;
+        if (first_keys) {
+            AppendRow(*first_keys, *first_keys_, index);
         }
-        return a.row_idx < b.row_idx;
-    };
+        keys.AppendKey(keys_.Key(index));
+        sequence.push_back(sequence_[index]);
+        heap_[i] = static_cast<uint32_t>(i);
+    }
+    rows_ = std::move(rows);
+    keys_ = std::move(keys);
+    first_keys_ = std::move(first_keys);
+    sequence_ = std::move(sequence);
+}
 
-    size_t offset = offset_.value_or(0);
+void TopNSink::UpdateThreshold() {
+    if (heap_.size() < capacity_ || capacity_ == 0 || !first_keys_) {
+        return;
+    }
+    const core::Column& key = *first_keys_;
+    uint32_t row = heap_.front();
+    threshold_.active = true;
+    threshold_.ascending = sort_units_[0].ascending;
+    threshold_.type = key.GetDataType();
+    threshold_.is_null = key.IsNull(row);
+    if (threshold_.is_null) {
+        return;
+    }
+    if (threshold_.type == core::DataType::String) {
+        threshold_.string_value = ReadStringRow(key, row);
+    } else if (threshold_.type == core::DataType::Double) {
+        threshold_.double_value = ReadDoubleRow(key, row);
+    } else {
+        threshold_.int_value = ReadIntegerRow(key, row);
+    }
+}
+
+void TopNSink::Finalize() {
+    if (limit_) {
+        FinalizeBounded();
+    } else {
+        FinalizeBuffered();
+    }
+}
+
+void TopNSink::FinalizeBounded() {
+    if (!has_rows_) {
+        downstream_.Finalize();
+        return;
+    }
+    std::sort_heap(heap_.begin(), heap_.end(), [&](uint32_t a, uint32_t b) {
+        int cmp = CompareNormalizedKeys(keys_, a, keys_, b);
+        return cmp != 0 ? cmp < 0 : sequence_[a] < sequence_[b];
+    });
+    size_t offset = std::min(offset_.value_or(0), heap_.size());
+
+    core::Batch out(rows_.GetSchema(), heap_.size() - offset);
+    for (size_t c = 0; c < out.ColumnsCount(); ++c) {
+        auto& dst = out.ColumnAt(c);
+        for (size_t i = offset; i < heap_.size(); ++i) {
+            AppendRow(dst, rows_.ColumnAt(c), heap_[i]);
+        }
+    }
+    downstream_.Consume(std::move(out));
+    downstream_.Finalize();
+}
 
-    size_t prefix = total_rows;
-    if (limit_ && offset < total_rows) {
-        prefix = offset + std::min(*limit_, total_rows - offset);
+void TopNSink::FinalizeBuffered() {
+    if (buffer_.empty()) {
+        downstream_.Finalize();
+        return;
+    }
+    size_t total_rows = 0;
+    for (auto& b : buffer_) {
+        total_rows += b.SelectedRowsCount();
     }
 
+    // Ties keep the input order
+    NormalizedKeys keys;
     std::vector<RowRef> refs;
-    if (limit_ && prefix < total_rows) {
-        refs.reserve(prefix);
-        if (prefix > 0) {
-            for_each_input_row([&](uint32_t b, uint32_t r) {
-                RowRef ref{b, r};
-                if (refs.size() < prefix) {
-                    refs.push_back(ref);
-                    std::push_heap(refs.begin(), refs.end(), less);
-                } else if (less(ref, refs.front())) {
-                    std::pop_heap(refs.begin(), refs.end(), less);
-                    refs.back() = ref;
-                    std::push_heap(refs.begin(), refs.end(), less);
-                }
-            });
-            std::sort_heap(refs.begin(), refs.end(), less);
+    refs.reserve(total_rows);
+    for (size_t b = 0; b < buffer_.size(); ++b) {
+        const auto& batch = buffer_[b];
+        std::vector<EvalResult> key_evals;
+        std::vector<const core::Column*> key_cols;
+        key_evals.reserve(sort_units_.size());
+        for (auto& unit : sort_units_) {
+            key_evals.emplace_back(Evaluate(batch, *unit.expression));
+            key_cols.push_back(&key_evals.back().Get());
         }
-    } else {
-        refs.reserve(total_rows);
-        for_each_input_row([&](uint32_t b, uint32_t r) { refs.push_back({b, r}); });
-        std::sort(refs.begin(), refs.end(), less);
+        keys.Append(sort_units_, key_cols, SelectedRows(batch), batch.RowsCount());
+        ForSelectedRows(batch, [&](size_t row) {
+            refs.push_back({static_cast<uint32_t>(b), static_cast<uint32_t>(row)});
+        });
     }
 
-    if (offset >= refs.size()) {
-        refs.clear();
-    } else if (offset > 0) {
-        refs.erase(refs.begin(), refs.begin() + offset);
+    auto order = keys.SortedOrder();
+    size_t offset = std::min(offset_.value_or(0), order.size());
+    std::vector<RowRef> sorted;
+    sorted.reserve(order.size() - offset);
+    for (size_t i = offset; i < order.size(); ++i) {
+        sorted.push_back(refs[order[i]]);
     }
+    refs = std::move(sorted);
 
     core::Batch out(buffer_.front().GetSchema(), refs.size());
     size_t cols = buffer_.front().ColumnsCount();
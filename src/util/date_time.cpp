@@ -1,7 +1,10 @@
 #include <util/date_time.h>
 #include <util/macro.h>
+#include <util/parse.h>
 
+#include <array>
 #include <cstddef>
+#include <cstring>
 
 namespace columnar::util {
 namespace {
@@ -42,12 +45,67 @@ int ParseDigits(const char* p, size_t n) {
     return value;
 }
 
-void AppendDigits(std::string& out, int value, size_t n) {
-    size_t pos = out.size();
-    out.resize(pos + n);
-    for (int i = n - 1; i >= 0; --i) {
-        out[pos + i] = '0' + value % 10;
-        value /= 10;
+// Byte masks of the digit positions in "YYYY-MM-", "YY-MM-DD" and "hh:mm:ss"
+constexpr uint64_t kYearDigits = 0x00000000FFFFFFFFULL;
+constexpr uint64_t kMonthDayDigits = 0xFFFF00FFFF000000ULL;
+constexpr uint64_t kTimeDigits = 0xFFFF00FFFF00FFFFULL;
+
+// Validates the digits selected by byte_mask and returns d[i] * 10 + d[i + 1] in byte i
+uint64_t DigitPairs(const char* p, uint64_t byte_mask) {
+    uint64_t word = LoadEightBytes(p);
+    if (!AreDigits(word, byte_mask)) {
+        THROW_RUNTIME_ERROR("Invalid digit in datetime value");
+    }
+    word = (word & byte_mask) | (0x3030303030303030ULL & ~byte_mask);
+    word -= 0x3030303030303030ULL;
+    return word * 10 + (word >> 8);
+}
+
+int PairAt(uint64_t pairs, int byte) {
+    return static_cast<int>((pairs >> (8 * byte)) & 0xFF);
+}
+
+Date ParseDateDigits(const char* p) {
+    if constexpr (kSwarParsing) {
+        uint64_t year = DigitPairs(p, kYearDigits);
+        uint64_t month_day = DigitPairs(p + 2, kMonthDayDigits);
+        return {PairAt(year, 0) * 100 + PairAt(year, 2), PairAt(month_day, 3),
+                PairAt(month_day, 6)};
+    }
+    return {ParseDigits(p, 4), ParseDigits(p + 5, 2), ParseDigits(p + 8, 2)};
+}
+
+Time ParseTimeDigits(const char* p) {
+    if constexpr (kSwarParsing) {
+        uint64_t time = DigitPairs(p, kTimeDigits);
+        return {PairAt(time, 0), PairAt(time, 3), PairAt(time, 6)};
+    }
+    return {ParseDigits(p, 2), ParseDigits(p + 3, 2), ParseDigits(p + 6, 2)};
+}
+
+// "00" .. "99", indexed by twice the value
+constexpr auto kDigitPairs = [] {
+    std::array<char, 200> pairs{};
+    for (int i = 0; i < 100; ++i) {
+        pairs[2 * i] = static_cast<char>('0' + i / 10);
+        pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+    return pairs;
+}();
+
+void WritePair(char* out, int value) {
+    std::memcpy(out, kDigitPairs.data() + 2 * value, 2);
+}
+
+void WriteYear(char* out, int year) {
+    if (year >= 0 && year <= 9999) {
+        WritePair(out, year / 100);
+        WritePair(out + 2, year % 100);
+        return;
+    }
+    for (int i = 3; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + year % 10);
+        year /= 10;
     }
 }
 }  // namespace
@@ -56,24 +114,27 @@ int32_t ParseDate(std::string_view s) {
     if (s.size() != 10 || s[4] != '-' || s[7] != '-') {
         THROW_RUNTIME_ERROR("Invalid date value: " + std::string(s));
     }
-    Date date{
-        ParseDigits(s.data(), 4),
-        ParseDigits(s.data() + 5, 2),
-        ParseDigits(s.data() + 8, 2),
-    };
+    Date date = ParseDateDigits(s.data());
     if (date.month < 1 || date.month > 12 || date.day < 1 || date.day > 31) {
         THROW_RUNTIME_ERROR("Invalid date value: " + std::string(s));
     }
     return DateToDays(date.year, date.month, date.day);
 }
 
-void AppendDate(int32_t days, std::string& out) {
+size_t FormatDate(int32_t days, char* out) {
     auto [year, month, day] = DaysToDate(days);
-    AppendDigits(out, year, 4);
-    out += '-';
-    AppendDigits(out, month, 2);
-    out += '-';
-    AppendDigits(out, day, 2);
+    WriteYear(out, year);
+    out[4] = '-';
+    WritePair(out + 5, month);
+    out[7] = '-';
+    WritePair(out + 8, day);
+    return kDateChars;
+}
+
+void AppendDate(int32_t days, std::string& out) {
+    size_t pos = out.size();
+    out.resize(pos + kDateChars);
+    FormatDate(days, out.data() + pos);
 }
 
 int64_t ParseTimestamp(std::string_view s) {
@@ -81,11 +142,7 @@ int64_t ParseTimestamp(std::string_view s) {
         THROW_RUNTIME_ERROR("Invalid timestamp value: " + std::string(s));
     }
     int32_t date_days = ParseDate(s.substr(0, 10));
-    Time time{
-        ParseDigits(s.data() + 11, 2),
-        ParseDigits(s.data() + 14, 2),
-        ParseDigits(s.data() + 17, 2),
-    };
+    Time time = ParseTimeDigits(s.data() + 11);
     if (time.hour > 23 || time.minute > 59 || time.second > 59) {
         THROW_RUNTIME_ERROR("Invalid timestamp value: " + std::string(s));
     }
@@ -93,19 +150,26 @@ int64_t ParseTimestamp(std::string_view s) {
            time.second;
 }
 
-void AppendTimestamp(int64_t seconds, std::string& out) {
+size_t FormatTimestamp(int64_t seconds, char* out) {
     int64_t day_count = seconds / 86400;
     int64_t tod = seconds % 86400;
     if (tod < 0) {
         --day_count;
         tod += 86400;
     }
-    AppendDate(static_cast<int32_t>(day_count), out);
-    out += ' ';
-    AppendDigits(out, static_cast<int>(tod / 3600), 2);
-    out += ':';
-    AppendDigits(out, static_cast<int>((tod / 60) % 60), 2);
-    out += ':';
-    AppendDigits(out, static_cast<int>(tod % 60), 2);
+    FormatDate(static_cast<int32_t>(day_count), out);
+    out[10] = ' ';
+    WritePair(out + 11, static_cast<int>(tod / 3600));
+    out[13] = ':';
+    WritePair(out + 14, static_cast<int>((tod / 60) % 60));
+    out[16] = ':';
+    WritePair(out + 17, static_cast<int>(tod % 60));
+    return kTimestampChars;
+}
+
+void AppendTimestamp(int64_t seconds, std::string& out) {
+    size_t pos = out.size();
+    out.resize(pos + kTimestampChars);
+    FormatTimestamp(seconds, out.data() + pos);
 }
 }  // namespace columnar::util
@@ -0,0 +1,413 @@
+#include <util/decompressing_file.h>
+#include <util/macro.h>
+
+#include <lz4frame.h>
+#include <zstd.h>
+#ifdef COLUMNAR_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace columnar::util {
+namespace {
+constexpr size_t kReadChunkSize = 1024 * 1024;
+
+#ifdef COLUMNAR_HAS_ZLIB
+constexpr bool kHasZlib = true;
+#else
+constexpr bool kHasZlib = false;
+#endif
+
+// Keeps the decompression state between input chunks
+class StreamDecoder {
+public:
+    struct Progress {
+        size_t consumed;
+        size_t produced;
+    };
+
+    virtual ~StreamDecoder() = default;
+
+    virtual Progress Decode(const char* in, size_t in_size, char* out, size_t out_size) = 0;
+
+    // Whether the input may end here, i.e. no frame is left half-decoded
+    virtual bool AtFrameEnd() const = 0;
+};
+
+class PlainDecoder final : public StreamDecoder {
+public:
+    Progress Decode(const char* in, size_t in_size, char* out, size_t out_size) override {
+        size_t n = std::min(in_size, out_size);
+        if (n > 0) {
+            std::memcpy(out, in, n);
+        }
+        return {n, n};
+    }
+
+    bool AtFrameEnd() const override {
+        return true;
+    }
+};
+
+class ZstdDecoder final : public StreamDecoder {
+public:
+    ZstdDecoder() : ctx_(ZSTD_createDCtx()) {
+        if (!ctx_) {
+            THROW_RUNTIME_ERROR("Cannot create ZSTD decompression context");
+        }
+    }
+
+    ~ZstdDecoder() override {
+        ZSTD_freeDCtx(ctx_);
+    }
+
+    Progress Decode(const char* in, size_t in_size, char* out, size_t out_size) override {
+        ZSTD_inBuffer in_buf{in, in_size, 0};
+        ZSTD_outBuffer out_buf{out, out_size, 0};
+        size_t ret = ZSTD_decompressStream(ctx_, &out_buf, &in_buf);
+        if (ZSTD_isError(ret)) {
+            THROW_RUNTIME_ERROR(std::string("ZSTD decompress failed: ") + ZSTD_getErrorName(ret));
+        }
+        // A call without progress reports the header size of the next frame
+        if (in_buf.pos > 0 || out_buf.pos > 0) {
+            frame_end_ = ret == 0;
+        }
+        return {in_buf.pos, out_buf.pos};
+    }
+
+    bool AtFrameEnd() const override {
+        return frame_end_;
+    }
+
+private:
+    ZSTD_DCtx* ctx_;
+    bool frame_end_ = true;
+};
+
+class Lz4Decoder final : public StreamDecoder {
+public:
+    Lz4Decoder() {
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&ctx_, LZ4F_VERSION))) {
+            THROW_RUNTIME_ERROR("Cannot create LZ4 decompression context");
+        }
+    }
+
+    ~Lz4Decoder() override {
+        LZ4F_freeDecompressionContext(ctx_);
+    }
+
+    Progress Decode(const char* in, size_t in_size, char* out, size_t out_size) override {
+        size_t consumed = in_size;
+        size_t produced = out_size;
+        size_t ret = LZ4F_decompress(ctx_, out, &produced, in, &consumed, nullptr);
+        if (LZ4F_isError(ret)) {
+            THROW_RUNTIME_ERROR(std::string("LZ4 decompress failed: ") + LZ4F_getErrorName(ret));
+        }
+        if (consumed > 0 || produced > 0) {
+            frame_end_ = ret == 0;
+        }
+        return {consumed, produced};
+    }
+
+    bool AtFrameEnd() const override {
+        return frame_end_;
+    }
+
+private:
+    LZ4F_dctx* ctx_ = nullptr;
+    bool frame_end_ = true;
+};
+
+#ifdef COLUMNAR_HAS_ZLIB
+class GzipDecoder final : public StreamDecoder {
+public:
+    GzipDecoder() {
+        if (inflateInit2(&stream_, 16 + MAX_WBITS) != Z_OK) {
+            THROW_RUNTIME_ERROR("Cannot create gzip decompression context");
+        }
+    }
+
+    ~GzipDecoder() override {
+        inflateEnd(&stream_);
+    }
+
+    Progress Decode(const char* in, size_t in_size, char* out, size_t out_size) override {
+        if (stream_end_) {
+            if (in_size == 0) {
+                return {0, 0};
+            }
+            // Concatenated gzip members, as written by pigz or `cat a.gz b.gz`
+            inflateReset(&stream_);
+            stream_end_ = false;
+        }
+        constexpr size_t kMaxChunk = std::numeric_limits<uInt>::max();
+        in_size = std::min(in_size, kMaxChunk);
+        out_size = std::min(out_size, kMaxChunk);
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+        stream_.avail_in = static_cast<uInt>(in_size);
+        stream_.next_out = reinterpret_cast<Bytef*>(out);
+        stream_.avail_out = static_cast<uInt>(out_size);
+        int ret = inflate(&stream_, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            stream_end_ = true;
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            THROW_RUNTIME_ERROR(std::string("Gzip decompress failed: ") +
+                                (stream_.msg ? stream_.msg : "unknown error"));
+        }
+        return {in_size - stream_.avail_in, out_size - stream_.avail_out};
+    }
+
+    bool AtFrameEnd() const override {
+        return stream_end_;
+    }
+
+private:
+    z_stream stream_{};
+    bool stream_end_ = false;
+};
+#endif
+
+std::unique_ptr<StreamDecoder> MakeDecoder(InputCodec codec) {
+    switch (codec) {
+        case InputCodec::None:
+            return std::make_unique<PlainDecoder>();
+        case InputCodec::Gzip:
+#ifdef COLUMNAR_HAS_ZLIB
+            return std::make_unique<GzipDecoder>();
+#else
+            break;
+#endif
+        case InputCodec::Zstd:
+            return std::make_unique<ZstdDecoder>();
+        case InputCodec::Lz4:
+            return std::make_unique<Lz4Decoder>();
+    }
+    THROW_RUNTIME_ERROR("Unsupported input codec " + std::to_string(static_cast<int>(codec)));
+}
+
+bool HasPrefix(const char* data, size_t n, std::initializer_list<uint8_t> magic) {
+    if (n < magic.size()) {
+        return false;
+    }
+    return std::equal(magic.begin(), magic.end(), reinterpret_cast<const uint8_t*>(data));
+}
+}  // namespace
+
+InputCodec DetectInputCodec(const char* data, size_t n) {
+    if (HasPrefix(data, n, {0x1F, 0x8B})) {
+        return InputCodec::Gzip;
+    }
+    if (HasPrefix(data, n, {0x28, 0xB5, 0x2F, 0xFD})) {
+        return InputCodec::Zstd;
+    }
+    if (HasPrefix(data, n, {0x04, 0x22, 0x4D, 0x18})) {
+        return InputCodec::Lz4;
+    }
+    return InputCodec::None;
+}
+
+bool IsInputCodecSupported(InputCodec codec) {
+    return codec != InputCodec::Gzip || kHasZlib;
+}
+
+// Single producer (the decompression thread) and single consumer (the stream reader) share a ring
+// of blocks. Blocks [consumed_, produced_) are ready, the one at consumed_ is being read when
+// holding_ is set
+class DecompressingInputFile::Buffer final : public std::streambuf {
+public:
+    Buffer(const std::string& path, size_t block_size, size_t blocks)
+        : input_(kReadChunkSize), blocks_(blocks, std::vector<char>(block_size)), sizes_(blocks) {
+        if (block_size == 0 || blocks == 0) {
+            THROW_RUNTIME_ERROR("block_size and blocks must be positive");
+        }
+        file_.open(path, std::ios::in | std::ios::binary);
+        if (!file_) {
+            throw std::runtime_error("Cannot open file " + path);
+        }
+        ReadInput();
+        codec_ = DetectInputCodec(input_.data(), input_size_);
+        if (!IsInputCodecSupported(codec_)) {
+            THROW_RUNTIME_ERROR("Gzip input requires zlib, which was not found at build time");
+        }
+        thread_ = std::thread([this] { Run(); });
+    }
+
+    ~Buffer() override {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    InputCodec Codec() const {
+        return codec_;
+    }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        std::unique_lock lock(mutex_);
+        if (holding_) {
+            ++consumed_;
+            holding_ = false;
+            cv_.notify_all();
+        }
+        cv_.wait(lock, [this] { return produced_ > consumed_ || done_; });
+        if (produced_ == consumed_) {
+            setg(nullptr, nullptr, nullptr);
+            if (error_) {
+                std::rethrow_exception(std::exchange(error_, nullptr));
+            }
+            return traits_type::eof();
+        }
+        size_t index = consumed_ % blocks_.size();
+        char* data = blocks_[index].data();
+        holding_ = true;
+        setg(data, data, data + sizes_[index]);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    void Run() {
+        try {
+            Pump();
+        } catch (...) {
+            std::lock_guard lock(mutex_);
+            error_ = std::current_exception();
+        }
+        {
+            std::lock_guard lock(mutex_);
+            done_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    void Pump() {
+        auto decoder = MakeDecoder(codec_);
+        size_t block_size = blocks_.front().size();
+        char* out = AcquireBlock();
+        size_t out_used = 0;
+        size_t in_pos = 0;
+        auto flush = [&] {
+            Publish(out_used);
+            out = AcquireBlock();
+            out_used = 0;
+            return out != nullptr;
+        };
+
+        while (out) {
+            if (in_pos == input_size_) {
+                if (!ReadInput()) {
+                    break;
+                }
+                in_pos = 0;
+            }
+            auto [consumed, produced] =
+                decoder->Decode(input_.data() + in_pos, input_size_ - in_pos, out + out_used,
+                                block_size - out_used);
+            if (consumed == 0 && produced == 0) {
+                THROW_RUNTIME_ERROR("Decompression made no progress");
+            }
+            in_pos += consumed;
+            out_used += produced;
+            if (out_used == block_size && !flush()) {
+                return;
+            }
+        }
+        if (!out) {
+            return;
+        }
+
+        // Decoders may still hold output that did not fit into the last block
+        while (true) {
+            size_t produced =
+                decoder->Decode(nullptr, 0, out + out_used, block_size - out_used).produced;
+            if (produced == 0) {
+                break;
+            }
+            out_used += produced;
+            if (out_used == block_size && !flush()) {
+                return;
+            }
+        }
+        if (!decoder->AtFrameEnd()) {
+            THROW_RUNTIME_ERROR("Compressed input is truncated");
+        }
+        if (out_used > 0) {
+            Publish(out_used);
+        }
+    }
+
+    // Returns nullptr when the reader is gone
+    char* AcquireBlock() {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || produced_ - consumed_ < blocks_.size(); });
+        return stop_ ? nullptr : blocks_[produced_ % blocks_.size()].data();
+    }
+
+    void Publish(size_t size) {
+        {
+            std::lock_guard lock(mutex_);
+            sizes_[produced_ % blocks_.size()] = size;
+            ++produced_;
+        }
+        cv_.notify_all();
+    }
+
+    bool ReadInput() {
+        file_.read(input_.data(), static_cast<std::streamsize>(input_.size()));
+        input_size_ = static_cast<size_t>(file_.gcount());
+        if (file_.bad()) {
+            THROW_RUNTIME_ERROR("Cannot read input file");
+        }
+        return input_size_ > 0;
+    }
+
+    std::ifstream file_;
+    std::vector<char> input_;
+    size_t input_size_ = 0;
+    InputCodec codec_ = InputCodec::None;
+    std::vector<std::vector<char>> blocks_;
+    std::vector<size_t> sizes_;
+    size_t produced_ = 0;
+    size_t consumed_ = 0;
+    bool holding_ = false;
+    bool done_ = false;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+DecompressingInputFile::DecompressingInputFile(const std::string& path, size_t block_size,
+                                               size_t blocks)
+    : std::istream(nullptr), buffer_(std::make_unique<Buffer>(path, block_size, blocks)) {
+    rdbuf(buffer_.get());
+    exceptions(std::ios::badbit);
+}
+
+DecompressingInputFile::~DecompressingInputFile() = default;
+
+InputCodec DecompressingInputFile::Codec() const {
+    return buffer_->Codec();
+}
+}  // namespace columnar::util
@@ -0,0 +1,56 @@
+#include <util/thread_pool.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace columnar::util {
+ThreadPool::ThreadPool(size_t threads) {
+    threads = std::max<size_t>(ResolveThreads(threads), 1);
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+size_t ThreadPool::ResolveThreads(size_t threads) noexcept {
+    if (threads != 0) {
+        return threads;
+    }
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+}  // namespace columnar::util
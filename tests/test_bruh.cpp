@@ -3,7 +3,12 @@
 #include <csv/csv.h>
 #include <core/schema.h>
 
+#include <ios>
+#include <ostream>
 #include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
 
 using namespace columnar;  // NOLINT
 
@@ -287,6 +292,108 @@ TEST(BruhBatchWriter, LargeBatch) {
     EXPECT_EQ(batch.ColumnAt(1).GetAsString(size - 1), "data_" + std::to_string(size - 1));
 }
 
+TEST(BruhBatchWriter, ParallelEncodingIsDeterministic) {
+    core::Schema schema({core::Field("id", core::DataType::Int64),
+                         core::Field("bucket", core::DataType::Int32),
+                         core::Field("name", core::DataType::String, true),
+                         core::Field("score", core::DataType::Double),
+                         core::Field("flag", core::DataType::Bool)});
+    auto write = [&](size_t threads, size_t in_flight) {
+        std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+        bruh::BruhWriterOptions options;
+        options.threads = threads;
+        options.max_in_flight_chunks = in_flight;
+        bruh::BruhBatchWriter writer(ss, schema, options);
+        for (int group = 0; group < 4; ++group) {
+            core::Batch batch(schema);
+            for (int i = 0; i < 1000; ++i) {
+                int v = group * 1000 + i;
+                batch.ColumnAt(0).AppendFromString(std::to_string(v));
+                batch.ColumnAt(1).AppendFromString(std::to_string(v % 7));
+                if (v % 5 == 0) {
+                    batch.ColumnAt(2).AppendNull();
+                } else {
+                    batch.ColumnAt(2).AppendFromString("name_" + std::to_string(v % 13));
+                }
+                batch.ColumnAt(3).AppendFromString(std::to_string(v * 0.5));
+                batch.ColumnAt(4).AppendFromString(v % 3 == 0 ? "true" : "false");
+            }
+            writer.Write(batch);
+        }
+        writer.Flush();
+        return ss.str();
+    };
+
+    auto serial = write(1, 0);
+    EXPECT_EQ(write(4, 0), serial);
+    EXPECT_EQ(write(3, 1), serial);
+    EXPECT_EQ(write(2, 2), serial);
+
+    bruh::BruhBatchReader reader(
+        util::ByteView{reinterpret_cast<const uint8_t*>(serial.data()), serial.size()});
+    EXPECT_EQ(reader.NumRowGroups(), 4);
+    auto batch = reader.ReadRowGroup(3);
+    EXPECT_EQ(batch.ColumnAt(0).GetAsString(999), "3999");
+    EXPECT_EQ(batch.ColumnAt(2).GetAsString(1), "name_" + std::to_string(3001 % 13));
+}
+
+TEST(BruhBatchWriter, ParallelEncodingPropagatesErrors) {
+    core::Schema schema(
+        {core::Field("a", core::DataType::Int64), core::Field("b", core::DataType::Int64)});
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    bruh::BruhWriterOptions options;
+    options.threads = 2;
+    options.column_encoding[1] = core::Encoding::BitPacking;
+    bruh::BruhBatchWriter writer(ss, schema, options);
+    core::Batch batch(schema);
+    batch.ColumnAt(0).AppendFromString("1");
+    batch.ColumnAt(1).AppendFromString("-1");
+
+    EXPECT_THROW(writer.Write(batch), std::runtime_error);
+}
+
+TEST(BruhBatchWriter, ParallelEncodingWaitsForChunksOnWriteError) {
+    // Accepts the file header and fails every write after it
+    class FailingBuf : public std::streambuf {
+    protected:
+        std::streamsize xsputn(const char*, std::streamsize n) override {
+            if (written_ + n > 16) {
+                return 0;
+            }
+            written_ += n;
+            return n;
+        }
+
+        int_type overflow(int_type c) override {
+            return xsputn(nullptr, 1) == 1 ? c : traits_type::eof();
+        }
+
+    private:
+        std::streamsize written_ = 0;
+    };
+
+    std::vector<core::Field> fields;
+    for (int i = 0; i < 8; ++i) {
+        fields.emplace_back("c" + std::to_string(i), core::DataType::Int64);
+    }
+    core::Schema schema(std::move(fields));
+    FailingBuf buf;
+    std::ostream os(&buf);
+    os.exceptions(std::ios::badbit);
+    bruh::BruhWriterOptions options;
+    options.threads = 4;
+    options.max_in_flight_chunks = 4;
+    bruh::BruhBatchWriter writer(os, schema, options);
+    core::Batch batch(schema);
+    for (int row = 0; row < 10000; ++row) {
+        for (size_t col = 0; col < batch.ColumnsCount(); ++col) {
+            batch.ColumnAt(col).AppendFromString(std::to_string(row * 8 + col));
+        }
+    }
+
+    EXPECT_THROW(writer.Write(batch), std::ios_base::failure);
+}
+
 TEST(BruhBatchWriter, SpecialCharacters) {
     core::Schema schema({core::Field("s", core::DataType::String)});
     std::vector<std::string> test_strings = {
@@ -822,3 +822,70 @@ TEST(BitPacking, BitVectorRoundTrip) {
         EXPECT_EQ(out.Get(i), bits.Get(i));
     }
 }
+
+TEST(BruhFetchRows, MatchesFullDecodeForEveryEncoding) {
+    core::Schema schema({core::Field("plain", core::DataType::Int64, true),
+                         core::Field("rle", core::DataType::Int32, true),
+                         core::Field("for", core::DataType::Int64),
+                         core::Field("delta", core::DataType::Int64),
+                         core::Field("packed", core::DataType::Int32),
+                         core::Field("flag", core::DataType::Bool, true),
+                         core::Field("flag_rle", core::DataType::Bool),
+                         core::Field("name", core::DataType::String, true),
+                         core::Field("dict", core::DataType::String),
+                         core::Field("c", core::DataType::Char)});
+    std::vector<core::Encoding> encodings = {
+        core::Encoding::Plain,    core::Encoding::RLE,        core::Encoding::FrameOfReference,
+        core::Encoding::Delta,    core::Encoding::BitPacking, core::Encoding::Plain,
+        core::Encoding::RLE,      core::Encoding::Plain,      core::Encoding::Dictionary,
+        core::Encoding::RLE};
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    {
+        bruh::BruhWriterOptions opts;
+        for (size_t c = 0; c < encodings.size(); ++c) {
+            opts.column_encoding[c] = encodings[c];
+        }
+        opts.column_compression[0] = util::Compression::None;
+        opts.column_compression[7] = util::Compression::None;
+        bruh::BruhBatchWriter writer(ss, schema, opts);
+        core::Batch batch(schema);
+        for (int64_t i = 0; i < 1000; ++i) {
+            auto append = [&](size_t c, const std::string& value) {
+                if (schema.GetFields()[c].nullable && i % 7 == 3) {
+                    batch.ColumnAt(c).AppendNull();
+                } else {
+                    batch.ColumnAt(c).AppendFromString(value);
+                }
+            };
+            append(0, std::to_string(i * 1000003 - 500000000));
+            append(1, std::to_string(i / 30 - 10));
+            append(2, std::to_string(-1000 + (i * 37) % 501));
+            append(3, std::to_string(1700000000000 + i * 1000 + i % 3));
+            append(4, std::to_string((i * 13) % 4096));
+            append(5, i % 3 == 0 ? "true" : "false");
+            append(6, i / 100 % 2 == 0 ? "true" : "false");
+            append(7, "name" + std::to_string(i * i));
+            append(8, "dict" + std::to_string(i % 9));
+            append(9, std::string(1, static_cast<char>('a' + i / 50 % 26)));
+        }
+        writer.Write(batch);
+        writer.Flush();
+    }
+
+    auto buf = ss.str();
+    bruh::BruhBatchReader reader(
+        util::ByteView{reinterpret_cast<const uint8_t*>(buf.data()), buf.size()});
+    auto full = reader.ReadRowGroup(0);
+    std::vector<uint32_t> rows = {0, 3, 4, 63, 64, 65, 500, 998, 999};
+    for (size_t c = 0; c < schema.FieldsCount(); ++c) {
+        EXPECT_EQ(reader.GetMetaData().row_groups[0].columns[c].encoding, encodings[c]);
+        auto fetched = reader.FetchRows(0, c, rows);
+        ASSERT_EQ(fetched->Size(), rows.size());
+        for (size_t k = 0; k < rows.size(); ++k) {
+            EXPECT_EQ(fetched->IsNull(k), full.ColumnAt(c).IsNull(rows[k])) << c << " " << rows[k];
+            EXPECT_EQ(fetched->GetAsString(k), full.ColumnAt(c).GetAsString(rows[k]))
+                << c << " " << rows[k];
+        }
+    }
+    EXPECT_THROW(reader.FetchRows(0, 0, {5, 4}), std::runtime_error);
+}
@@ -2,6 +2,8 @@
 #include <csv/csv.h>
 #include <core/schema.h>
 #include <core/field.h>
+#include <core/columns/dictionary_string_column.h>
+#include <memory>
 #include <sstream>
 
 using namespace columnar;  // NOLINT
@@ -216,6 +218,46 @@ TEST(CSVBatchReader, InvalidCharValue) {
     EXPECT_THROW(reader.ReadNext(), std::runtime_error);
 }
 
+TEST(CSVBatchBuilder, TypedAppendersAndNulls) {
+    core::Schema schema({core::Field("i16", core::DataType::Int16, true),
+                         core::Field("i32", core::DataType::Int32, true),
+                         core::Field("i64", core::DataType::Int64, true),
+                         core::Field("d", core::DataType::Double, true),
+                         core::Field("b", core::DataType::Bool, true),
+                         core::Field("s", core::DataType::String, true),
+                         core::Field("dt", core::DataType::Date, true),
+                         core::Field("ts", core::DataType::Timestamp, true),
+                         core::Field("c", core::DataType::Char, true)});
+    std::istringstream in(
+        "-7,123456,-1234567890123,2.5,true,x,2026-01-02,2026-01-02 03:04:05,a\n"
+        ",,,,,,,,\n"
+        "7,0,42,-0.5,0,\"\",1970-01-01,1970-01-01 00:00:00,b");
+    csv::CSVBatchReader reader(in, schema, {});
+
+    auto batch = reader.ReadNext();
+    ASSERT_TRUE(batch);
+    ASSERT_EQ(batch->RowsCount(), 3);
+    std::vector<std::string> first = {
+        "-7", "123456", "-1234567890123", "2.500000", "true", "x", "2026-01-02",
+        "2026-01-02 03:04:05", "a"};
+    std::vector<std::string> last = {
+        "7", "0", "42", "-0.500000", "false", "", "1970-01-01", "1970-01-01 00:00:00", "b"};
+    for (size_t i = 0; i < schema.FieldsCount(); ++i) {
+        EXPECT_EQ(batch->ColumnAt(i).GetAsString(0), first[i]);
+        EXPECT_TRUE(batch->ColumnAt(i).IsNull(1));
+        EXPECT_FALSE(batch->ColumnAt(i).IsNull(2));
+        EXPECT_EQ(batch->ColumnAt(i).GetAsString(2), last[i]);
+    }
+}
+
+TEST(CSVBatchBuilder, EmptyFieldOfNonNullableIntegerThrows) {
+    core::Schema schema({core::Field("x", core::DataType::Int32)});
+    std::istringstream in("1\n\n");
+    csv::CSVBatchReader reader(in, schema, {});
+
+    EXPECT_THROW(reader.ReadNext(), std::runtime_error);
+}
+
 TEST(CSVBatchWriter, WriteBatch) {
     core::Schema schema({core::Field("a", core::DataType::Int64),
                          core::Field("b", core::DataType::String),
@@ -278,6 +320,88 @@ TEST(CSVBatchWriter, WriteDoubleFormatting) {
     EXPECT_EQ(out.str(), "3.140000\n");
 }
 
+namespace {
+core::Batch MakeWriterBatch(size_t rows) {
+    core::Schema schema({core::Field("i", core::DataType::Int64, true),
+                         core::Field("s", core::DataType::String, true),
+                         core::Field("ds", core::DataType::String, true),
+                         core::Field("d", core::DataType::Double),
+                         core::Field("dt", core::DataType::Date, true),
+                         core::Field("ts", core::DataType::Timestamp),
+                         core::Field("b", core::DataType::Bool),
+                         core::Field("c", core::DataType::Char, true),
+                         core::Field("i16", core::DataType::Int16)});
+    core::Batch batch(schema);
+    batch.GetColumns()[2] = std::make_unique<core::DictionaryStringColumn>(true);
+    const char* strings[] = {"plain", "", "a,b", "say \"hi\"", "line\nbreak", "cr\r"};
+    const char* chars[] = {"x", ",", "\"", "\n"};
+    for (size_t row = 0; row < rows; ++row) {
+        if (row % 7 == 3) {
+            batch.ColumnAt(0).AppendNull();
+            batch.ColumnAt(1).AppendNull();
+            batch.ColumnAt(2).AppendNull();
+            batch.ColumnAt(4).AppendNull();
+            batch.ColumnAt(7).AppendNull();
+        } else {
+            batch.ColumnAt(0).AppendFromString(std::to_string(static_cast<int64_t>(row) * 7919 - 40000));
+            batch.ColumnAt(1).AppendFromString(strings[row % 6]);
+            batch.ColumnAt(2).AppendFromString(strings[(row + 1) % 6]);
+            batch.ColumnAt(4).AppendFromString(row % 2 ? "1999-12-31" : "2026-02-28");
+            batch.ColumnAt(7).AppendFromString(chars[row % 4]);
+        }
+        batch.ColumnAt(3).AppendFromString(std::to_string(row) + ".25");
+        batch.ColumnAt(5).AppendFromString(row % 2 ? "1970-01-01 00:00:00" : "2038-01-19 03:14:07");
+        batch.ColumnAt(6).AppendFromString(row % 3 ? "true" : "false");
+        batch.ColumnAt(8).AppendFromString(std::to_string(static_cast<int>(row % 100) - 50));
+    }
+    return batch;
+}
+
+std::string WriteCSV(const core::Batch& batch, csv::CSVOptions options) {
+    std::ostringstream out;
+    csv::CSVBatchWriter writer(out, options);
+    writer.Write(batch);
+    writer.Write(batch);
+    writer.Flush();
+    return out.str();
+}
+}  // namespace
+
+TEST(CSVBatchWriter, ColumnFormatting) {
+    auto batch = MakeWriterBatch(4);
+    EXPECT_EQ(WriteCSV(batch, {.has_header = true}),
+              "i,s,ds,d,dt,ts,b,c,i16\n"
+              "-40000,plain,\"\",0.250000,2026-02-28,2038-01-19 03:14:07,false,x,-50\n"
+              "-32081,\"\",\"a,b\",1.250000,1999-12-31,1970-01-01 00:00:00,true,\",\",-49\n"
+              "-24162,\"a,b\",\"say \"\"hi\"\"\",2.250000,2026-02-28,2038-01-19 03:14:07,true,"
+              "\"\"\"\",-48\n"
+              ",,,3.250000,,1970-01-01 00:00:00,false,,-47\n"
+              "-40000,plain,\"\",0.250000,2026-02-28,2038-01-19 03:14:07,false,x,-50\n"
+              "-32081,\"\",\"a,b\",1.250000,1999-12-31,1970-01-01 00:00:00,true,\",\",-49\n"
+              "-24162,\"a,b\",\"say \"\"hi\"\"\",2.250000,2026-02-28,2038-01-19 03:14:07,true,"
+              "\"\"\"\",-48\n"
+              ",,,3.250000,,1970-01-01 00:00:00,false,,-47\n");
+}
+
+TEST(CSVBatchWriter, ParallelMatchesSerial) {
+    auto batch = MakeWriterBatch(10000);
+    auto serial = WriteCSV(batch, {});
+    EXPECT_EQ(WriteCSV(batch, {.threads = 4}), serial);
+
+    std::istringstream in(serial);
+    csv::CSVBatchReader reader(in, batch.GetSchema(), {.batch_rows_size = 20000});
+    auto read = reader.ReadNext();
+    ASSERT_TRUE(read);
+    ASSERT_EQ(read->RowsCount(), 20000);
+    for (size_t col = 0; col < batch.ColumnsCount(); ++col) {
+        for (size_t row = 0; row < 10000; row += 997) {
+            EXPECT_EQ(read->ColumnAt(col).IsNull(row), batch.ColumnAt(col).IsNull(row));
+            EXPECT_EQ(read->ColumnAt(col).GetAsString(row + 10000),
+                      batch.ColumnAt(col).GetAsString(row));
+        }
+    }
+}
+
 TEST(CSVFullInterface, DataIsNotChanged) {
     core::Schema schema(
         {core::Field("id", core::DataType::Int64), core::Field("name", core::DataType::String)});
@@ -332,6 +456,138 @@ TEST(CSVBatchReader, SkipHeader) {
     EXPECT_EQ(batch->ColumnAt(1).GetAsString(1), "world");
 }
 
+TEST(ParallelCSVBatchReader, MatchesSerialReader) {
+    core::Schema schema({core::Field("id", core::DataType::Int64),
+                         core::Field("name", core::DataType::String, true),
+                         core::Field("score", core::DataType::Double, true)});
+    std::string text = "id,name,score\n";
+    for (int i = 0; i < 500; ++i) {
+        text += std::to_string(i) + ",";
+        if (i % 7 == 0) {
+            text += "\"multi\r\nline, \"\"quoted\"\"\"";
+        } else if (i % 5 != 0) {
+            text += "name_" + std::to_string(i);
+        }
+        text += "," + (i % 3 == 0 ? std::string() : std::to_string(i * 0.25));
+        text += i % 2 == 0 ? "\r\n" : "\n";
+    }
+    csv::CSVOptions options{.has_header = true, .batch_rows_size = 37, .threads = 3};
+
+    std::istringstream serial_in(text);
+    csv::CSVBatchReader serial(serial_in, schema, options);
+    std::istringstream parallel_in(text);
+    csv::ParallelCSVBatchReader parallel(parallel_in, schema, options, 100);
+
+    size_t rows = 0;
+    while (auto expected = serial.ReadNext()) {
+        auto actual = parallel.ReadNext();
+        ASSERT_TRUE(actual);
+        ASSERT_EQ(actual->RowsCount(), expected->RowsCount());
+        for (size_t row = 0; row < expected->RowsCount(); ++row) {
+            for (size_t col = 0; col < schema.FieldsCount(); ++col) {
+                EXPECT_EQ(actual->ColumnAt(col).IsNull(row), expected->ColumnAt(col).IsNull(row));
+                EXPECT_EQ(actual->ColumnAt(col).GetAsString(row),
+                          expected->ColumnAt(col).GetAsString(row));
+            }
+        }
+        rows += expected->RowsCount();
+    }
+    EXPECT_EQ(rows, 500);
+    EXPECT_FALSE(parallel.ReadNext());
+}
+
+TEST(ParallelCSVBatchReader, TrailingRowWithoutNewline) {
+    core::Schema schema({core::Field("x", core::DataType::Int64)});
+    std::istringstream in("1\n2\n3");
+    csv::ParallelCSVBatchReader reader(in, schema, {.batch_rows_size = 2, .threads = 2});
+
+    auto b = reader.ReadNext();
+    ASSERT_TRUE(b);
+    EXPECT_EQ(b->RowsCount(), 2);
+    b = reader.ReadNext();
+    ASSERT_TRUE(b);
+    ASSERT_EQ(b->RowsCount(), 1);
+    EXPECT_EQ(b->ColumnAt(0).GetAsString(0), "3");
+    EXPECT_FALSE(reader.ReadNext());
+}
+
+TEST(ParallelCSVBatchReader, PropagatesParseErrorsInOrder) {
+    core::Schema schema({core::Field("x", core::DataType::Int64)});
+    std::istringstream in("1\n2\n3,4\n5\n");
+    csv::ParallelCSVBatchReader reader(in, schema, {.batch_rows_size = 2, .threads = 2});
+
+    ASSERT_TRUE(reader.ReadNext());
+    EXPECT_THROW(reader.ReadNext(), std::runtime_error);
+}
+
+TEST(ParallelCSVBatchReader, UnterminatedQuoteThrows) {
+    core::Schema schema({core::Field("x", core::DataType::String)});
+    std::istringstream in("a\n\"b\nc\n");
+    csv::ParallelCSVBatchReader reader(in, schema, {.batch_rows_size = 1});
+
+    ASSERT_TRUE(reader.ReadNext());
+    EXPECT_THROW(reader.ReadNext(), std::runtime_error);
+}
+
+TEST(StructuralScanner, MasksAndQuotedRegion) {
+    std::string block(csv::kStructuralBlockSize, 'x');
+    block[0] = ',';
+    block[3] = '"';
+    block[5] = ',';
+    block[7] = '"';
+    block[8] = '"';
+    block[10] = '"';
+    block[12] = '\n';
+    block[63] = '"';
+
+    auto masks = csv::ScanBlock(block.data(), ',', '"');
+    EXPECT_EQ(masks.delimiters, (uint64_t{1} << 0) | (uint64_t{1} << 5));
+    EXPECT_EQ(masks.newlines, uint64_t{1} << 12);
+
+    bool in_quotes = false;
+    uint64_t inside = csv::QuotedRegionMask(masks.quotes, in_quotes);
+    EXPECT_FALSE((inside >> 0) & 1);
+    EXPECT_TRUE((inside >> 5) & 1);
+    EXPECT_TRUE((inside >> 9) & 1);
+    EXPECT_FALSE((inside >> 12) & 1);
+    EXPECT_TRUE(in_quotes);
+
+    auto tail = csv::ScanPartialBlock(block.data(), 6, ',', '"');
+    EXPECT_EQ(tail.delimiters, masks.delimiters);
+    EXPECT_EQ(tail.quotes, uint64_t{1} << 3);
+    EXPECT_EQ(tail.newlines, 0);
+}
+
+TEST(ParallelCSVBatchReader, QuotedFieldsAcrossBlocks) {
+    core::Schema schema(
+        {core::Field("x", core::DataType::String), core::Field("y", core::DataType::Int32)});
+    std::string long_value(150, 'v');
+    long_value[70] = ',';
+    long_value[140] = '\n';
+    std::string text;
+    for (int i = 0; i < 20; ++i) {
+        text += "\"" + long_value + "\"\"\"," + std::to_string(i) + "\n";
+        text += "plain_" + std::to_string(i) + "," + std::to_string(-i) + "\n";
+    }
+
+    std::istringstream in(text);
+    csv::ParallelCSVBatchReader reader(in, schema, {.batch_rows_size = 3, .threads = 2}, 64);
+    size_t rows = 0;
+    while (auto batch = reader.ReadNext()) {
+        for (size_t row = 0; row < batch->RowsCount(); ++row, ++rows) {
+            int i = static_cast<int>(rows / 2);
+            if (rows % 2 == 0) {
+                EXPECT_EQ(batch->ColumnAt(0).GetAsString(row), long_value + "\"");
+                EXPECT_EQ(batch->ColumnAt(1).GetAsString(row), std::to_string(i));
+            } else {
+                EXPECT_EQ(batch->ColumnAt(0).GetAsString(row), "plain_" + std::to_string(i));
+                EXPECT_EQ(batch->ColumnAt(1).GetAsString(row), std::to_string(-i));
+            }
+        }
+    }
+    EXPECT_EQ(rows, 40);
+}
+
 TEST(CSVBatchWriter, WriteHeader) {
     core::Schema schema(
         {core::Field("a", core::DataType::Int64), core::Field("b", core::DataType::String)});
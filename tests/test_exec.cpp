@@ -1,17 +1,28 @@
 #include <gtest/gtest.h>
 #include <bruh/bruh.h>
 #include <core/columns/dictionary_string_column.h>
+#include <core/columns/numeric_column.h>
 #include <core/columns/string_column.h>
 #include <core/columns/timestamp_column.h>
+#include <core/row_selection.h>
 #include <exec/clickbench.h>
+#include <exec/column_row_access.h>
 #include <exec/expression/builders.h>
 #include <exec/expression/eval.h>
+#include <exec/group_key_table.h>
+#include <exec/group_key_table/string_hash_map.h>
+#include <exec/hash_aggregate_operator.h>
 #include <exec/kernel.h>
 #include <exec/metadata_pruning.h>
 #include <exec/operator.h>
+#include <exec/runtime_filter.h>
+#include <exec/sort_key.h>
+#include <exec/sort_operator.h>
+#include <exec/topn_operator.h>
 
 #include <cmath>
 #include <cstring>
+#include <limits>
 #include <set>
 #include <memory>
 #include <sstream>
@@ -289,6 +300,339 @@ TEST(Execution, FilterSkipsRowGroupsByStatistics) {
     EXPECT_EQ(TotalRows(batches), 2);
 }
 
+TEST(Execution, TopNSkipsRowGroupsBeyondThreshold) {
+    core::Schema schema({core::Field("x", core::DataType::Int64)});
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    {
+        bruh::BruhWriterOptions options;
+        options.compression = util::Compression::None;
+        options.encoding = core::Encoding::Plain;
+        bruh::BruhBatchWriter writer(ss, schema, options);
+        for (auto values :
+             std::vector<std::vector<std::string>>{{"3", "1"}, {"7", "9"}, {"2", "8"}}) {
+            core::Batch batch(schema);
+            for (auto& value : values) {
+                batch.ColumnAt(0).AppendFromString(value);
+            }
+            writer.Write(batch);
+        }
+        writer.Flush();
+    }
+
+    auto buf = ss.str();
+    bruh::BruhBatchReader metadata_reader(AsBytes(buf));
+    auto& chunk = metadata_reader.GetMetaData().row_groups[1].columns[0];
+    int64_t poison = 0;
+    auto offset = static_cast<size_t>(chunk.offset);
+    std::memcpy(buf.data() + offset, &poison, sizeof(poison));
+    std::memcpy(buf.data() + offset + sizeof(poison), &poison, sizeof(poison));
+
+    bruh::BruhBatchReader reader(AsBytes(buf));
+    auto x = exec::MakeColumnExpr("x", core::DataType::Int64);
+    auto batches =
+        exec::Execute(reader, exec::MakeTopN(exec::MakeScan(), {exec::SortUnit{x, true}}, 2));
+    ASSERT_EQ(batches.size(), 1);
+    ASSERT_EQ(batches[0].RowsCount(), 2);
+    EXPECT_EQ(batches[0].ColumnAt(0).GetAsString(0), "1");
+    EXPECT_EQ(batches[0].ColumnAt(0).GetAsString(1), "2");
+
+    exec::TopNThreshold threshold;
+    threshold.active = true;
+    threshold.ascending = false;
+    threshold.int_value = 8;
+    auto& column = static_cast<const exec::ColumnExpr&>(*x);
+    EXPECT_FALSE(exec::TopNMayImprove(metadata_reader, 0, column, threshold));
+    EXPECT_TRUE(exec::TopNMayImprove(metadata_reader, 1, column, threshold));
+    EXPECT_TRUE(exec::TopNMayImprove(metadata_reader, 2, column, threshold));
+}
+
+TEST(Execution, TopNFetchesOtherColumnsForOutputRowsOnly) {
+    core::Schema schema({core::Field("x", core::DataType::Int64),
+                         core::Field("flag", core::DataType::Int64),
+                         core::Field("name", core::DataType::String)});
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    {
+        bruh::BruhWriterOptions options;
+        options.compression = util::Compression::None;
+        options.encoding = core::Encoding::Plain;
+        bruh::BruhBatchWriter writer(ss, schema, options);
+        std::vector<std::vector<std::string>> groups = {
+            {"3", "1", "a", "1", "1", "b"}, {"5", "1", "c", "0", "0", "d"},
+            {"2", "1", "e", "8", "1", "f"}};
+        for (auto& values : groups) {
+            core::Batch batch(schema);
+            for (size_t i = 0; i < values.size(); ++i) {
+                batch.ColumnAt(i % 3).AppendFromString(values[i]);
+            }
+            writer.Write(batch);
+        }
+        writer.Flush();
+    }
+
+    // The names of the middle row group hold no output row and must not be decoded
+    auto buf = ss.str();
+    bruh::BruhBatchReader metadata_reader(AsBytes(buf));
+    auto& chunk = metadata_reader.GetMetaData().row_groups[1].columns[2];
+    buf[static_cast<size_t>(chunk.offset)] = 3;
+
+    bruh::BruhBatchReader reader(AsBytes(buf));
+    auto condition = exec::MakeBinary(exec::BinaryFunction::Equal,
+                                      exec::MakeColumnExpr("flag", core::DataType::Int64),
+                                      exec::MakeConst(static_cast<int64_t>(1)));
+    auto topn = exec::MakeTopN(exec::MakeFilter(exec::MakeScan(), std::move(condition)),
+                               {exec::SortUnit{exec::MakeColumnExpr("x", core::DataType::Int64),
+                                               true}},
+                               2);
+    auto plan = exec::MakeProject(
+        topn, {exec::ProjectionUnit{exec::MakeColumnExpr("name", core::DataType::String), "name"},
+               exec::ProjectionUnit{exec::MakeColumnExpr("x", core::DataType::Int64), "x"}});
+    auto batches = exec::Execute(reader, plan);
+    EXPECT_EQ(topn->late_columns, std::vector<std::string>{"name"});
+    ASSERT_EQ(batches.size(), 1);
+    ASSERT_EQ(batches[0].RowsCount(), 2);
+    EXPECT_EQ(batches[0].ColumnAt(0).GetAsString(0), "b");
+    EXPECT_EQ(batches[0].ColumnAt(1).GetAsString(0), "1");
+    EXPECT_EQ(batches[0].ColumnAt(0).GetAsString(1), "e");
+    EXPECT_EQ(batches[0].ColumnAt(1).GetAsString(1), "2");
+
+    auto fetched = metadata_reader.FetchRows(2, {2, 0}, {1});
+    ASSERT_EQ(fetched.RowsCount(), 1);
+    EXPECT_EQ(fetched.ColumnAt(0).GetAsString(0), "f");
+    EXPECT_EQ(fetched.ColumnAt(1).GetAsString(0), "8");
+}
+
+TEST(Execution, LimitStopsScanningOnceSatisfied) {
+    core::Schema schema({core::Field("x", core::DataType::Int64),
+                         core::Field("s", core::DataType::String)});
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    {
+        bruh::BruhWriterOptions options;
+        options.compression = util::Compression::None;
+        options.encoding = core::Encoding::Plain;
+        bruh::BruhBatchWriter writer(ss, schema, options);
+        for (int64_t group = 0; group < 3; ++group) {
+            core::Batch batch(schema);
+            for (int64_t x = group * 2 + 1; x <= group * 2 + 2; ++x) {
+                batch.ColumnAt(0).AppendFromString(std::to_string(x));
+                batch.ColumnAt(1).AppendFromString("s" + std::to_string(x));
+            }
+            writer.Write(batch);
+        }
+        writer.Flush();
+    }
+
+    // The last row group is never needed, reading it would fail
+    auto buf = ss.str();
+    bruh::BruhBatchReader metadata_reader(AsBytes(buf));
+    auto& chunk = metadata_reader.GetMetaData().row_groups[2].columns[1];
+    buf[static_cast<size_t>(chunk.offset)] = 3;
+
+    bruh::BruhBatchReader reader(AsBytes(buf));
+    auto condition = exec::MakeBinary(exec::BinaryFunction::Greater,
+                                      exec::MakeColumnExpr("x", core::DataType::Int64),
+                                      exec::MakeConst(static_cast<int64_t>(0)));
+    auto plan = exec::MakeProject(
+        exec::MakeLimit(exec::MakeFilter(exec::MakeScan(), std::move(condition)), 3, 1),
+        {exec::ProjectionUnit{exec::MakeColumnExpr("s", core::DataType::String), "s"}});
+    std::vector<std::string> values;
+    for (auto& batch : exec::Execute(reader, plan)) {
+        for (size_t row = 0; row < batch.RowsCount(); ++row) {
+            values.push_back(batch.ColumnAt(0).GetAsString(row));
+        }
+    }
+    EXPECT_EQ(values, (std::vector<std::string>{"s2", "s3", "s4"}));
+}
+
+TEST(Execution, HashJoinTypes) {
+    core::Schema probe_schema({core::Field("k", core::DataType::Int64, true),
+                               core::Field("v", core::DataType::String)});
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    {
+        bruh::BruhBatchWriter writer(ss, probe_schema);
+        core::Batch first(probe_schema);
+        core::Batch second(probe_schema);
+        for (auto [k, v] : std::vector<std::pair<const char*, const char*>>{
+                 {"1", "a"}, {"2", "b"}, {"3", "c"}, {nullptr, "d"}, {"2", "e"}}) {
+            auto& batch = std::string_view(v) < "d" ? first : second;
+            if (k == nullptr) {
+                batch.ColumnAt(0).AppendNull();
+            } else {
+                batch.ColumnAt(0).AppendFromString(k);
+            }
+            batch.ColumnAt(1).AppendFromString(v);
+        }
+        writer.Write(first);
+        writer.Write(second);
+        writer.Flush();
+    }
+    auto buf = ss.str();
+    bruh::BruhBatchReader reader(AsBytes(buf));
+
+    core::Schema build_schema({core::Field("bk", core::DataType::Int64),
+                               core::Field("name", core::DataType::String)});
+    auto make_build = [&] {
+        core::Batch build(build_schema);
+        for (auto [k, name] : std::vector<std::pair<const char*, const char*>>{
+                 {"2", "x"}, {"3", "y"}, {"2", "z"}, {"4", "w"}}) {
+            build.ColumnAt(0).AppendFromString(k);
+            build.ColumnAt(1).AppendFromString(name);
+        }
+        std::vector<core::Batch> batches;
+        batches.push_back(std::move(build));
+        return batches;
+    };
+
+    auto run = [&](std::shared_ptr<exec::Operator> join, bool with_build_columns) {
+        std::vector<exec::ProjectionUnit> columns{
+            {exec::MakeColumnExpr("v", core::DataType::String), "v"}};
+        if (with_build_columns) {
+            columns.push_back({exec::MakeColumnExpr("name", core::DataType::String), "name"});
+        }
+        std::vector<std::string> rows;
+        for (auto& batch : exec::Execute(reader, exec::MakeProject(join, columns))) {
+            for (size_t row = 0; row < batch.RowsCount(); ++row) {
+                std::string value = batch.ColumnAt(0).GetAsString(row);
+                if (with_build_columns) {
+                    value += ":" + (batch.ColumnAt(1).IsNull(row)
+                                        ? std::string("NULL")
+                                        : batch.ColumnAt(1).GetAsString(row));
+                }
+                rows.push_back(value);
+            }
+        }
+        return rows;
+    };
+    auto join = [&](exec::JoinType type) {
+        return exec::MakeHashJoin(exec::MakeScan(), make_build(), build_schema,
+                                  {exec::MakeColumnExpr("k", core::DataType::Int64)},
+                                  {exec::MakeColumnExpr("bk", core::DataType::Int64)}, type);
+    };
+
+    std::vector<std::string> inner{"b:x", "b:z", "c:y", "e:x", "e:z"};
+    EXPECT_EQ(run(join(exec::JoinType::Inner), true), inner);
+    EXPECT_EQ(run(join(exec::JoinType::Left), true),
+              (std::vector<std::string>{"a:NULL", "b:x", "b:z", "c:y", "d:NULL", "e:x", "e:z"}));
+    EXPECT_EQ(run(join(exec::JoinType::Semi), false), (std::vector<std::string>{"b", "c", "e"}));
+    EXPECT_EQ(run(join(exec::JoinType::Anti), false), (std::vector<std::string>{"a", "d"}));
+
+    // The same build rows read by a plan over a second file
+    std::stringstream build_ss(std::ios::in | std::ios::out | std::ios::binary);
+    {
+        bruh::BruhBatchWriter writer(build_ss, build_schema);
+        writer.Write(make_build()[0]);
+        writer.Flush();
+    }
+    auto build_buf = build_ss.str();
+    bruh::BruhBatchReader build_reader(AsBytes(build_buf));
+    auto build_plan = exec::MakeProject(
+        exec::MakeScan(),
+        {exec::ProjectionUnit{exec::MakeColumnExpr("bk", core::DataType::Int64), "bk"},
+         exec::ProjectionUnit{exec::MakeColumnExpr("name", core::DataType::String), "name"}});
+    auto from_reader = exec::MakeHashJoin(exec::MakeScan(), build_reader, build_plan,
+                                          {exec::MakeColumnExpr("k", core::DataType::Int64)},
+                                          {exec::MakeColumnExpr("bk", core::DataType::Int64)});
+    EXPECT_EQ(run(from_reader, true), inner);
+
+    // A build side without rows still has its columns, which are NULL in a left join
+    auto no_rows = exec::MakeProject(
+        exec::MakeFilter(exec::MakeScan(),
+                         exec::MakeBinary(exec::BinaryFunction::Equal,
+                                          exec::MakeColumnExpr("bk", core::DataType::Int64),
+                                          exec::MakeConst(static_cast<int64_t>(99)))),
+        {exec::ProjectionUnit{exec::MakeColumnExpr("bk", core::DataType::Int64), "bk"},
+         exec::ProjectionUnit{exec::MakeColumnExpr("name", core::DataType::String), "name"}});
+    std::vector<std::string> unmatched{"a:NULL", "b:NULL", "c:NULL", "d:NULL", "e:NULL"};
+    EXPECT_EQ(run(exec::MakeHashJoin(exec::MakeScan(), build_reader, no_rows,
+                                     {exec::MakeColumnExpr("k", core::DataType::Int64)},
+                                     {exec::MakeColumnExpr("bk", core::DataType::Int64)},
+                                     exec::JoinType::Left),
+                  true),
+              unmatched);
+    EXPECT_EQ(run(exec::MakeHashJoin(exec::MakeScan(), {}, build_schema,
+                                     {exec::MakeColumnExpr("k", core::DataType::Int64)},
+                                     {exec::MakeColumnExpr("bk", core::DataType::Int64)},
+                                     exec::JoinType::Left),
+                  true),
+              unmatched);
+}
+
+TEST(Execution, HashJoinPushesBuildKeysIntoProbeScan) {
+    core::Schema schema({core::Field("k", core::DataType::Int64),
+                         core::Field("v", core::DataType::String)});
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    {
+        bruh::BruhWriterOptions options;
+        options.compression = util::Compression::None;
+        options.encoding = core::Encoding::Plain;
+        bruh::BruhBatchWriter writer(ss, schema, options);
+        for (int64_t first : {1, 10, 20}) {
+            core::Batch batch(schema);
+            for (int64_t k = first; k < first + 3; ++k) {
+                batch.ColumnAt(0).AppendFromString(std::to_string(k));
+                batch.ColumnAt(1).AppendFromString("v" + std::to_string(k));
+            }
+            writer.Write(batch);
+        }
+        writer.Flush();
+    }
+
+    // No build key falls into the first and the last row group, reading them would fail
+    auto buf = ss.str();
+    bruh::BruhBatchReader metadata_reader(AsBytes(buf));
+    for (size_t group : {0, 2}) {
+        auto& chunk = metadata_reader.GetMetaData().row_groups[group].columns[1];
+        buf[static_cast<size_t>(chunk.offset)] = 3;
+    }
+    bruh::BruhBatchReader reader(AsBytes(buf));
+
+    core::Schema build_schema({core::Field("bk", core::DataType::Int64)});
+    core::Batch build(build_schema);
+    for (const char* k : {"11", "15", "12"}) {
+        build.ColumnAt(0).AppendFromString(k);
+    }
+    std::vector<core::Batch> build_batches;
+    build_batches.push_back(std::move(build));
+    auto join = exec::MakeHashJoin(exec::MakeScan(), std::move(build_batches), build_schema,
+                                   {exec::MakeColumnExpr("k", core::DataType::Int64)},
+                                   {exec::MakeColumnExpr("bk", core::DataType::Int64)},
+                                   exec::JoinType::Semi);
+    auto plan = exec::MakeProject(
+        join, {exec::ProjectionUnit{exec::MakeColumnExpr("v", core::DataType::String), "v"}});
+    std::vector<std::string> values;
+    for (auto& batch : exec::Execute(reader, plan)) {
+        for (size_t row = 0; row < batch.RowsCount(); ++row) {
+            values.push_back(batch.ColumnAt(0).GetAsString(row));
+        }
+    }
+    EXPECT_EQ(values, (std::vector<std::string>{"v11", "v12"}));
+}
+
+TEST(RuntimeFilter, BloomFilterKeepsEveryBuildKey) {
+    core::Int64Column keys;
+    for (int64_t k = 0; k < 4096; ++k) {
+        keys.Append(k * 7);
+    }
+    exec::RuntimeFilter filter(keys);
+    size_t false_positives = 0;
+    for (int64_t k = 0; k < 4096; ++k) {
+        EXPECT_TRUE(filter.MayContain(k * 7));
+        false_positives += filter.MayContain(k * 7 + 1) ? 1 : 0;
+    }
+    EXPECT_LT(false_positives, 200);
+    EXPECT_FALSE(filter.MayContain(int64_t{-7}));
+    EXPECT_FALSE(filter.MayOverlap(int64_t{28672}, int64_t{30000}));
+    EXPECT_TRUE(filter.MayOverlap(int64_t{-5}, int64_t{0}));
+
+    core::StringColumn names;
+    names.Append("b");
+    names.Append("d");
+    exec::RuntimeFilter exact(names);
+    EXPECT_TRUE(exact.MayContain(std::string_view("d")));
+    EXPECT_FALSE(exact.MayContain(std::string_view("c")));
+    EXPECT_FALSE(exact.MayOverlap(std::string_view("bb"), std::string_view("cz")));
+    EXPECT_TRUE(exact.MayOverlap(std::string_view("a"), std::string_view("b")));
+}
+
 TEST(Execution, PredicateMayMatchDoesNotPruneNaNChunk) {
     core::Schema schema({core::Field("x", core::DataType::Double, true)});
     std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
@@ -653,6 +997,305 @@ TEST(HashAggregation, MixedAggregates) {
     }
 }
 
+TEST(HashAggregation, DistinctValuesAreCountedPerGroup) {
+    core::Schema schema({core::Field("key", core::DataType::Int64),
+                         core::Field("value", core::DataType::Int64),
+                         core::Field("name", core::DataType::String)});
+    core::Batch batch(schema);
+    for (auto row : std::vector<std::vector<std::string>>{{"1", "5", "a"},
+                                                          {"2", "5", "a"},
+                                                          {"1", "5", "b"},
+                                                          {"2", "6", "a"},
+                                                          {"3", "7", ""},
+                                                          {"1", "6", "a"}}) {
+        for (size_t col = 0; col < row.size(); ++col) {
+            batch.ColumnAt(col).AppendFromString(row[col]);
+        }
+    }
+
+    auto result = RunPlanOnBatch(
+        batch, exec::MakeHashAggregation(
+                   exec::MakeScan(), exec::MakeColumnExpr("key", core::DataType::Int64), "key",
+                   {exec::Distinct(exec::MakeColumnExpr("value", core::DataType::Int64), "values"),
+                    exec::Distinct(exec::MakeColumnExpr("name", core::DataType::String),
+                                   "names")}));
+    ASSERT_EQ(result.RowsCount(), 3);
+    std::vector<std::string> expected = {"1,2,2", "2,2,1", "3,1,1"};
+    for (size_t row = 0; row < expected.size(); ++row) {
+        EXPECT_EQ(result.ColumnAt(0).GetAsString(row) + "," + result.ColumnAt(1).GetAsString(row) +
+                      "," + result.ColumnAt(2).GetAsString(row),
+                  expected[row]);
+    }
+}
+
+TEST(HashAggregation, SelectedRowsWithNullKeysAndValues) {
+    core::Schema schema({core::Field("key", core::DataType::Int64, true),
+                         core::Field("value", core::DataType::Int64, true),
+                         core::Field("name", core::DataType::String, true),
+                         core::Field("keep", core::DataType::Int64)});
+    core::Batch batch(schema);
+    for (auto row : std::vector<std::vector<std::string_view>>{{"1", "10", "a", "1"},
+                                                               {"", "5", "b", "1"},
+                                                               {"1", "", "b", "1"},
+                                                               {"2", "7", "c", "1"},
+                                                               {"1", "3", "a", "1"},
+                                                               {"2", "100", "z", "0"}}) {
+        for (size_t col = 0; col < row.size(); ++col) {
+            if (row[col].empty()) {
+                batch.ColumnAt(col).AppendNull();
+            } else {
+                batch.ColumnAt(col).AppendFromString(std::string(row[col]));
+            }
+        }
+    }
+
+    auto value = exec::MakeColumnExpr("value", core::DataType::Int64);
+    auto filter = exec::MakeFilter(
+        exec::MakeScan(),
+        exec::MakeBinary(exec::BinaryFunction::Equal,
+                         exec::MakeColumnExpr("keep", core::DataType::Int64),
+                         exec::MakeConst(static_cast<int64_t>(1))));
+    auto plan = exec::MakeHashAggregation(
+        std::move(filter), exec::MakeColumnExpr("key", core::DataType::Int64), "key",
+        {exec::Count("count"), exec::Sum(value, "sum"), exec::Avg(value, "avg"),
+         exec::Min(value, "min"), exec::Max(value, "max"),
+         exec::Distinct(exec::MakeColumnExpr("name", core::DataType::String), "distinct"),
+         exec::Min(exec::MakeColumnExpr("name", core::DataType::String), "min_name")});
+    auto result = RunPlanOnBatch(batch, plan);
+    ASSERT_EQ(result.RowsCount(), 2);
+    std::vector<std::vector<std::string>> expected = {{"1", "3", "13", "6", "3", "10", "2", "a"},
+                                                      {"2", "1", "7", "7", "7", "7", "1", "c"}};
+    for (size_t row = 0; row < expected.size(); ++row) {
+        for (size_t col = 0; col < expected[row].size(); ++col) {
+            EXPECT_EQ(result.ColumnAt(col).GetAsString(row), expected[row][col]);
+        }
+    }
+}
+
+TEST(HashAggregation, ManyStringGroupsWithNullKeys) {
+    core::Schema schema({core::Field("key", core::DataType::String, true)});
+    core::Batch batch(schema);
+    for (size_t i = 0; i < 5000; ++i) {
+        if (i % 7 == 0) {
+            batch.ColumnAt(0).AppendNull();
+        } else {
+            batch.ColumnAt(0).AppendFromString("key" + std::to_string(i % 1000));
+        }
+    }
+
+    auto plan = exec::MakeHashAggregation(exec::MakeScan(),
+                                          exec::MakeColumnExpr("key", core::DataType::String),
+                                          "key", {exec::Count("count")});
+    auto result = RunPlanOnBatch(batch, plan);
+    ASSERT_EQ(result.RowsCount(), 1000);
+    for (size_t row = 0; row < result.RowsCount(); ++row) {
+        size_t key = std::stoul(result.ColumnAt(0).GetAsString(row).substr(3));
+        size_t expected = 0;
+        for (size_t i = key; i < 5000; i += 1000) {
+            expected += i % 7 != 0 ? 1 : 0;
+        }
+        EXPECT_EQ(result.ColumnAt(1).GetAsString(row), std::to_string(expected));
+    }
+}
+
+TEST(GroupKeyTable, DenseIntegerKeysMoveToHashedTable) {
+    std::vector<exec::ProjectionUnit> keys = {
+        exec::ProjectionUnit{exec::MakeColumnExpr("a", core::DataType::Int64), "a"},
+        exec::ProjectionUnit{exec::MakeColumnExpr("b", core::DataType::Int64), "b"}};
+    std::vector<exec::AggregationUnit> aggregations;
+    util::StringArena arena;
+    exec::AggStateBuffer state(aggregations, arena);
+    auto table = exec::GroupKeyTable::Make(keys, arena);
+
+    auto find_groups = [&](const std::vector<std::pair<int64_t, int64_t>>& rows) {
+        core::Int64Column a(true);
+        core::Int64Column b;
+        for (auto [first, second] : rows) {
+            if (first < 0) {
+                a.AppendNull();
+            } else {
+                a.Append(first);
+            }
+            b.Append(second);
+        }
+        std::vector<uint32_t> group_ids;
+        table->FindGroups({&a, &b}, nullptr, rows.size(), state, group_ids);
+        return group_ids;
+    };
+
+    constexpr uint32_t kNoGroup = exec::AggStateBuffer::kNoGroup;
+    EXPECT_EQ(find_groups({{1, 2}, {3, 4}, {1, 2}, {-1, 2}, {2, 2}}),
+              (std::vector<uint32_t>{0, 1, 0, kNoGroup, 2}));
+    EXPECT_EQ(find_groups({{2, 2}, {1000000000, 5}, {3, 4}, {1, 2}}),
+              (std::vector<uint32_t>{2, 3, 1, 0}));
+    ASSERT_EQ(state.GroupsCount(), 4);
+
+    core::Batch out(core::Schema(
+        {core::Field("a", core::DataType::Int64), core::Field("b", core::DataType::Int64)}));
+    for (uint32_t group_id = 0; group_id < state.GroupsCount(); ++group_id) {
+        table->AppendKeys(group_id, out);
+    }
+    std::vector<std::string> expected = {"1,2", "3,4", "2,2", "1000000000,5"};
+    for (size_t row = 0; row < expected.size(); ++row) {
+        EXPECT_EQ(out.ColumnAt(0).GetAsString(row) + "," + out.ColumnAt(1).GetAsString(row),
+                  expected[row]);
+    }
+}
+
+TEST(HashAggregation, PackedAndSerializedCompositeKeys) {
+    core::Schema schema({core::Field("small", core::DataType::Int16),
+                         core::Field("wide", core::DataType::Int64),
+                         core::Field("name", core::DataType::String),
+                         core::Field("tag", core::DataType::String, true)});
+    core::Batch batch(schema);
+    for (auto row : std::vector<std::vector<std::string_view>>{
+             {"-3", "-1000000000000", "a", "x"},
+             {"7", "1000000000000", "", "y"},
+             {"-3", "-1000000000000", "a", "x"},
+             {"7", "1000000000000", "", ""},
+             {"-3", "5", "a", "x"}}) {
+        for (size_t col = 0; col < row.size(); ++col) {
+            if (col == 3 && row[col].empty()) {
+                batch.ColumnAt(col).AppendNull();
+            } else {
+                batch.ColumnAt(col).AppendFromString(std::string(row[col]));
+            }
+        }
+    }
+
+    auto key = [](std::string name, core::DataType type) {
+        return exec::ProjectionUnit{exec::MakeColumnExpr(name, type), name};
+    };
+    auto packed = RunPlanOnBatch(
+        batch, exec::MakeHashAggregation(exec::MakeScan(),
+                                         {key("small", core::DataType::Int16),
+                                          key("wide", core::DataType::Int64)},
+                                         {exec::Count("count")}));
+    ASSERT_EQ(packed.RowsCount(), 3);
+    std::vector<std::string> expected = {"-3,-1000000000000,2", "7,1000000000000,2", "-3,5,1"};
+    for (size_t row = 0; row < expected.size(); ++row) {
+        EXPECT_EQ(packed.ColumnAt(0).GetAsString(row) + "," + packed.ColumnAt(1).GetAsString(row) +
+                      "," + packed.ColumnAt(2).GetAsString(row),
+                  expected[row]);
+    }
+
+    auto serialized = RunPlanOnBatch(
+        batch, exec::MakeHashAggregation(
+                   exec::MakeScan(),
+                   {key("name", core::DataType::String), key("small", core::DataType::Int16),
+                    key("tag", core::DataType::String)},
+                   {exec::Count("count")}));
+    ASSERT_EQ(serialized.RowsCount(), 2);
+    expected = {"a,-3,x,3", ",7,y,1"};
+    for (size_t row = 0; row < expected.size(); ++row) {
+        std::string actual;
+        for (size_t col = 0; col < serialized.ColumnsCount(); ++col) {
+            actual += (col > 0 ? "," : "") + serialized.ColumnAt(col).GetAsString(row);
+        }
+        EXPECT_EQ(actual, expected[row]);
+    }
+}
+
+TEST(HashAggregation, SpilledPartialStatesMatchInMemoryResult) {
+    core::Schema schema({core::Field("user", core::DataType::String),
+                         core::Field("region", core::DataType::Int32, true),
+                         core::Field("price", core::DataType::Double),
+                         core::Field("url", core::DataType::String)});
+    auto make_batch = [&](size_t b) {
+        core::Batch batch(schema);
+        for (size_t row = 0; row < 300; ++row) {
+            size_t i = b * 300 + row;
+            batch.ColumnAt(0).AppendFromString("user" + std::to_string((i * 7) % 211));
+            if (i % 13 == 0) {
+                batch.ColumnAt(1).AppendNull();
+            } else {
+                batch.ColumnAt(1).AppendFromString(std::to_string(i % 17));
+            }
+            batch.ColumnAt(2).AppendFromString(std::to_string(static_cast<double>(i) / 4));
+            batch.ColumnAt(3).AppendFromString("url" + std::to_string(i % 29));
+        }
+        return batch;
+    };
+
+    auto column = [](std::string name, core::DataType type) {
+        return exec::MakeColumnExpr(std::move(name), type);
+    };
+    std::vector<exec::ProjectionUnit> keys = {
+        exec::ProjectionUnit{column("user", core::DataType::String), "user"}};
+    std::vector<exec::AggregationUnit> aggregations = {
+        exec::Count("count"),
+        exec::Sum(column("price", core::DataType::Double), "price_sum"),
+        exec::Avg(column("region", core::DataType::Int32), "region_avg"),
+        exec::Distinct(column("region", core::DataType::Int32), "regions"),
+        exec::Distinct(column("url", core::DataType::String), "urls"),
+        exec::Min(column("url", core::DataType::String), "min_url"),
+        exec::Max(column("region", core::DataType::Int32), "max_region")};
+
+    auto run = [&](exec::HashAggregationOptions options) {
+        exec::CollectSink collect;
+        exec::HashAggregationSink sink(collect, keys, aggregations, options);
+        for (size_t b = 0; b < 5; ++b) {
+            sink.Consume(make_batch(b));
+        }
+        sink.Finalize();
+        std::vector<std::string> rows;
+        for (auto& out : collect.TakeBatches()) {
+            for (size_t row = 0; row < out.RowsCount(); ++row) {
+                std::string line;
+                for (size_t col = 0; col < out.ColumnsCount(); ++col) {
+                    line += (col > 0 ? "," : "") + out.ColumnAt(col).GetAsString(row);
+                }
+                rows.push_back(std::move(line));
+            }
+        }
+        return rows;
+    };
+
+    auto in_memory = run({});
+    ASSERT_EQ(in_memory.size(), 211);
+    exec::HashAggregationOptions options;
+    options.memory_budget = 1;
+    options.spill_partitions = 3;
+    EXPECT_EQ(run(options), in_memory);
+}
+
+TEST(GroupKeyTable, StringHashMapLengthClasses) {
+    using Map = exec::group_key::StringHashMap<uint32_t>;
+    std::vector<std::string> keys = {"",
+                                     "a",
+                                     std::string("a\0", 2),
+                                     std::string("\0", 1),
+                                     "abcdefgh",
+                                     "abcdefghi",
+                                     std::string(16, 'x'),
+                                     std::string(17, 'x'),
+                                     std::string(24, 'y'),
+                                     std::string(25, 'y'),
+                                     std::string(100, 'z')};
+    Map map;
+    for (uint32_t i = 0; i < keys.size(); ++i) {
+        auto probe = Map::MakeProbe(keys[i]);
+        ASSERT_EQ(map.Find(probe), nullptr) << i;
+        map.Insert(probe, keys[i], i);
+    }
+    EXPECT_EQ(map.Size(), keys.size());
+    map.Reserve(1000);
+    for (uint32_t i = 0; i < keys.size(); ++i) {
+        const uint32_t* value = map.Find(Map::MakeProbe(std::string(keys[i])));
+        ASSERT_NE(value, nullptr) << i;
+        EXPECT_EQ(*value, i);
+    }
+    EXPECT_EQ(map.Find(Map::MakeProbe("abcdefg")), nullptr);
+
+    Map reserved;
+    reserved.Reserve(1000);
+    EXPECT_GT(reserved.MemoryUsage(), 0);
+    for (uint32_t i = 0; i < keys.size(); ++i) {
+        reserved.Insert(Map::MakeProbe(keys[i]), keys[i], i);
+    }
+    EXPECT_EQ(reserved.Size(), keys.size());
+}
+
 TEST(TopNOperator, SortDescLimit) {
     auto plan = exec::MakeTopN(
         exec::MakeScan(),
@@ -693,6 +1336,51 @@ TEST(TopNOperator, MultiKeySort) {
     EXPECT_EQ(result.ColumnAt(adv).GetAsString(2), "1");
 }
 
+TEST(TopNOperator, OrdersLikeSortOverSelectedRows) {
+    core::Schema schema({core::Field("id", core::DataType::Int64),
+                         core::Field("d", core::DataType::Double, true),
+                         core::Field("s", core::DataType::String)});
+    core::Batch batch(schema);
+    std::vector<double> doubles = {std::numeric_limits<double>::quiet_NaN(),
+                                   -std::numeric_limits<double>::quiet_NaN(),
+                                   2.5,
+                                   -1,
+                                   std::numeric_limits<double>::infinity(),
+                                   0};
+    for (int64_t id = 0; id < 40; ++id) {
+        static_cast<core::Int64Column&>(batch.ColumnAt(0)).Append(id);
+        if (id % 7 == 0) {
+            batch.ColumnAt(1).AppendNull();
+        } else {
+            static_cast<core::DoubleColumn&>(batch.ColumnAt(1)).Append(doubles[id % 6]);
+        }
+        batch.ColumnAt(2).AppendFromString(std::string(id % 3, 'a'));
+    }
+    auto units = [] {
+        return std::vector<exec::SortUnit>{
+            exec::SortUnit{exec::MakeColumnExpr("d", core::DataType::Double), false},
+            exec::SortUnit{exec::MakeColumnExpr("s", core::DataType::String), true}};
+    };
+    auto filtered = [] {
+        return exec::MakeFilter(exec::MakeScan(),
+                                exec::MakeBinary(exec::BinaryFunction::Greater,
+                                                 exec::MakeColumnExpr("id", core::DataType::Int64),
+                                                 exec::MakeConst(static_cast<int64_t>(4))));
+    };
+    auto ids = [](const core::Batch& result) {
+        std::vector<std::string> values;
+        for (size_t row = 0; row < result.RowsCount(); ++row) {
+            values.push_back(result.ColumnAt(0).GetAsString(row));
+        }
+        return values;
+    };
+    auto sorted = ids(RunPlanOnBatch(batch, exec::MakeSort(filtered(), units())));
+    ASSERT_EQ(sorted.size(), 35);
+    EXPECT_EQ(ids(RunPlanOnBatch(batch, exec::MakeTopN(filtered(), units()))), sorted);
+    EXPECT_EQ(ids(RunPlanOnBatch(batch, exec::MakeTopN(filtered(), units(), 10, 3))),
+              std::vector<std::string>(sorted.begin() + 3, sorted.begin() + 13));
+}
+
 TEST(TopNOperator, TiesKeepInputOrder) {
     core::Schema schema(
         {core::Field("id", core::DataType::Int64), core::Field("score", core::DataType::Int64)});
@@ -713,6 +1401,218 @@ TEST(TopNOperator, TiesKeepInputOrder) {
     EXPECT_EQ(result.ColumnAt(0).GetAsString(1), "11");
 }
 
+TEST(TopNOperator, BoundedHeapAcrossBatches) {
+    core::Schema schema({core::Field("id", core::DataType::Int64),
+                         core::Field("score", core::DataType::Int64, true)});
+    exec::CollectSink collect;
+    exec::TopNSink sink(
+        collect, {exec::SortUnit{exec::MakeColumnExpr("score", core::DataType::Int64), true}}, 3,
+        1);
+    int64_t id = 0;
+    for (size_t b = 0; b < 40; ++b) {
+        core::Batch batch(schema);
+        for (size_t row = 0; row < 100; ++row, ++id) {
+            batch.ColumnAt(0).AppendFromString(std::to_string(id));
+            if (id == 2500) {
+                batch.ColumnAt(1).AppendNull();
+            } else {
+                batch.ColumnAt(1).AppendFromString(std::to_string((4000 - id) % 1000));
+            }
+        }
+        sink.Consume(std::move(batch));
+        if (b == 0) {
+            EXPECT_TRUE(sink.Threshold().active);
+            EXPECT_EQ(sink.Threshold().int_value, 903);
+        }
+    }
+    EXPECT_TRUE(sink.Threshold().active);
+    EXPECT_FALSE(sink.Threshold().is_null);
+    EXPECT_EQ(sink.Threshold().int_value, 0);
+    sink.Finalize();
+
+    auto batches = collect.TakeBatches();
+    ASSERT_EQ(batches.size(), 1);
+    ASSERT_EQ(batches[0].RowsCount(), 3);
+    std::vector<std::string> expected = {"0,0", "1000,0", "2000,0"};
+    for (size_t row = 0; row < expected.size(); ++row) {
+        EXPECT_EQ(batches[0].ColumnAt(0).GetAsString(row) + "," +
+                      batches[0].ColumnAt(1).GetAsString(row),
+                  expected[row]);
+    }
+}
+
+TEST(SortOperator, SpilledRunsMergeLikeInMemorySort) {
+    core::Schema schema({core::Field("id", core::DataType::Int64),
+                         core::Field("bucket", core::DataType::Int64, true),
+                         core::Field("name", core::DataType::String)});
+    auto make_batch = [&](size_t b) {
+        core::Batch batch(schema);
+        for (size_t row = 0; row < 200; ++row) {
+            int64_t id = static_cast<int64_t>(b * 200 + row);
+            batch.ColumnAt(0).AppendFromString(std::to_string(id));
+            if (id % 37 == 0) {
+                batch.ColumnAt(1).AppendNull();
+            } else {
+                batch.ColumnAt(1).AppendFromString(std::to_string((id * 13) % 7));
+            }
+            batch.ColumnAt(2).AppendFromString("n" + std::to_string((id * 7) % 11));
+        }
+        return batch;
+    };
+    std::vector<exec::SortUnit> sort_units = {
+        exec::SortUnit{exec::MakeColumnExpr("bucket", core::DataType::Int64), true},
+        exec::SortUnit{exec::MakeColumnExpr("name", core::DataType::String), false}};
+
+    auto run = [&](exec::SortOptions options) {
+        exec::CollectSink collect;
+        exec::SortSink sink(collect, sort_units, options);
+        for (size_t b = 0; b < 6; ++b) {
+            sink.Consume(make_batch(b));
+        }
+        sink.Finalize();
+        std::vector<std::string> rows;
+        for (auto& out : collect.TakeBatches()) {
+            for (size_t row = 0; row < out.RowsCount(); ++row) {
+                rows.push_back(out.ColumnAt(0).GetAsString(row) + "," +
+                               out.ColumnAt(1).GetAsString(row) + "," +
+                               out.ColumnAt(2).GetAsString(row));
+            }
+        }
+        return rows;
+    };
+
+    auto in_memory = run({});
+    ASSERT_EQ(in_memory.size(), 1200);
+    auto id = [](const std::string& row) { return std::stoll(row.substr(0, row.find(','))); };
+    auto key = [](const std::string& row) { return row.substr(row.find(',') + 1); };
+    EXPECT_EQ(id(in_memory[0]) % 37, 0);
+    for (size_t i = 1; i < in_memory.size(); ++i) {
+        if (key(in_memory[i]) == key(in_memory[i - 1])) {
+            EXPECT_LT(id(in_memory[i - 1]), id(in_memory[i]));
+        }
+    }
+    exec::SortOptions options;
+    options.memory_budget = 1;
+    EXPECT_EQ(run(options), in_memory);
+}
+
+TEST(SortOperator, NormalizedKeysOrderLikeRowComparison) {
+    core::Schema schema({core::Field("i", core::DataType::Int64, true),
+                         core::Field("d", core::DataType::Double),
+                         core::Field("s", core::DataType::String, true)});
+    core::Batch batch(schema);
+    std::vector<std::string> ints = {"-5", "0", "", "7", "-9223372036854775808", "5", "0", "3"};
+    std::vector<std::string> doubles = {"-1.5", "0", "-0", "2.25", "-1e300", "inf", "-2.5", "nan"};
+    std::vector<std::string> strings = {"a", std::string("a\0b", 3), "", "ab", "b",
+                                        std::string("a\0", 2), "a", "c"};
+    for (size_t row = 0; row < ints.size(); ++row) {
+        if (ints[row].empty()) {
+            batch.ColumnAt(0).AppendNull();
+        } else {
+            batch.ColumnAt(0).AppendFromString(ints[row]);
+        }
+        batch.ColumnAt(1).AppendFromString(doubles[row]);
+        if (row == 3) {
+            batch.ColumnAt(2).AppendNull();
+        } else {
+            batch.ColumnAt(2).AppendFromString(strings[row]);
+        }
+    }
+    std::vector<const core::Column*> cols = {&batch.ColumnAt(0), &batch.ColumnAt(1),
+                                             &batch.ColumnAt(2)};
+    auto sign = [](int cmp) { return (cmp > 0) - (cmp < 0); };
+    // The expected order: NULL first, NaN after every other double
+    auto compare_rows = [&](const std::vector<exec::SortUnit>& units,
+                            const std::vector<const core::Column*>& key_cols, size_t a, size_t b) {
+        for (size_t s = 0; s < units.size(); ++s) {
+            const core::Column& col = *key_cols[s];
+            int cmp = 0;
+            if (col.IsNull(a) || col.IsNull(b)) {
+                cmp = static_cast<int>(col.IsNull(b)) - static_cast<int>(col.IsNull(a));
+            } else if (col.GetDataType() == core::DataType::String) {
+                cmp = sign(exec::ReadStringRow(col, a).compare(exec::ReadStringRow(col, b)));
+            } else if (col.GetDataType() == core::DataType::Double) {
+                double x = exec::ReadDoubleRow(col, a);
+                double y = exec::ReadDoubleRow(col, b);
+                if (std::isnan(x) || std::isnan(y)) {
+                    cmp = static_cast<int>(std::isnan(x)) - static_cast<int>(std::isnan(y));
+                } else {
+                    cmp = (x > y) - (x < y);
+                }
+            } else {
+                int64_t x = exec::ReadIntegerRow(col, a);
+                int64_t y = exec::ReadIntegerRow(col, b);
+                cmp = (x > y) - (x < y);
+            }
+            if (cmp != 0) {
+                return units[s].ascending ? cmp : -cmp;
+            }
+        }
+        return 0;
+    };
+    for (auto ascending : {true, false}) {
+        for (size_t first = 0; first < cols.size(); ++first) {
+            std::vector<exec::SortUnit> units;
+            std::vector<const core::Column*> key_cols;
+            for (size_t k = 0; k < cols.size(); ++k) {
+                size_t c = (first + k) % cols.size();
+                units.push_back(exec::SortUnit{
+                    exec::MakeColumnExpr(schema.GetFields()[c].name, cols[c]->GetDataType()),
+                    k == 0 ? ascending : !ascending});
+                key_cols.push_back(cols[c]);
+            }
+            exec::NormalizedKeys keys;
+            keys.Append(units, key_cols, batch.RowsCount());
+            ASSERT_EQ(keys.Size(), batch.RowsCount());
+            for (size_t a = 0; a < batch.RowsCount(); ++a) {
+                for (size_t b = 0; b < batch.RowsCount(); ++b) {
+                    EXPECT_EQ(sign(keys.Key(a).compare(keys.Key(b))),
+                              compare_rows(units, key_cols, a, b))
+                        << first << " " << ascending << " " << a << " " << b;
+                    if (keys.Prefix(a) != keys.Prefix(b)) {
+                        EXPECT_EQ(keys.Prefix(a) < keys.Prefix(b), keys.Key(a) < keys.Key(b));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(SortOperator, NormalizedKeysSortEveryNaNLast) {
+    core::DoubleColumn col(false);
+    for (double value : {std::numeric_limits<double>::quiet_NaN(),
+                         -std::numeric_limits<double>::quiet_NaN(),
+                         std::numeric_limits<double>::infinity(),
+                         -std::numeric_limits<double>::infinity(), 0.0}) {
+        col.Append(value);
+    }
+    std::vector<exec::SortUnit> units = {
+        exec::SortUnit{exec::MakeColumnExpr("d", core::DataType::Double), true}};
+    exec::NormalizedKeys keys;
+    keys.Append(units, {&col}, col.Size());
+    EXPECT_EQ(keys.Key(0), keys.Key(1));
+    for (size_t row = 2; row < col.Size(); ++row) {
+        EXPECT_LT(keys.Key(row), keys.Key(0)) << row;
+        EXPECT_LT(keys.Key(row), keys.Key(1)) << row;
+    }
+}
+
+TEST(SortOperator, SortsPlanOutput) {
+    core::Schema schema({core::Field("x", core::DataType::Int64)});
+    core::Batch batch(schema);
+    for (auto value : {"3", "1", "2"}) {
+        batch.ColumnAt(0).AppendFromString(value);
+    }
+    auto result = RunPlanOnBatch(
+        batch, exec::MakeSort(exec::MakeScan(),
+                              {exec::SortUnit{exec::MakeColumnExpr("x", core::DataType::Int64),
+                                              false}}));
+    ASSERT_EQ(result.RowsCount(), 3);
+    EXPECT_EQ(result.ColumnAt(0).GetAsString(0), "3");
+    EXPECT_EQ(result.ColumnAt(0).GetAsString(1), "2");
+    EXPECT_EQ(result.ColumnAt(0).GetAsString(2), "1");
+}
+
 TEST(ClickBenchQueries, Q7GroupByCount) {
     auto result = RunMiniQuery(7);
     ASSERT_EQ(result.RowsCount(), 2);
@@ -1158,6 +2058,132 @@ TEST(Kernel, DictionaryStringKernelsReuseDictionary) {
     EXPECT_EQ(captured->GetAsString(3), "plain");
 }
 
+TEST(Kernel, KernelsKeepRowPositionsUnderSelection) {
+    core::Int64Column a(true);
+    core::Int64Column b(false);
+    core::StringColumn s(false);
+    for (int64_t i = 0; i < 6; ++i) {
+        if (i == 3) {
+            a.AppendNull();
+        } else {
+            a.Append(i);
+        }
+        b.Append(10 * i);
+        s.Append("v" + std::to_string(i));
+    }
+    std::vector<uint32_t> selection{1, 3, 4};
+
+    auto sum = exec::kernel::Add(a, b, &selection);
+    ASSERT_EQ(sum->Size(), 6);
+    EXPECT_EQ(sum->GetAsString(1), "11");
+    EXPECT_TRUE(sum->IsNull(3));
+    EXPECT_EQ(sum->GetAsString(4), "44");
+
+    auto greater = exec::kernel::GreaterConstInt(b, 15, &selection);
+    ASSERT_EQ(greater->Size(), 6);
+    EXPECT_EQ(greater->GetAsString(1), "false");
+    EXPECT_EQ(greater->GetAsString(3), "true");
+    EXPECT_EQ(greater->GetAsString(4), "true");
+
+    RE2 digit("[0-9]");
+    auto replaced = exec::kernel::RegexReplace(s, digit, "#", &selection);
+    ASSERT_EQ(replaced->Size(), 6);
+    EXPECT_EQ(replaced->GetAsString(1), "v#");
+    EXPECT_EQ(replaced->GetAsString(4), "v#");
+}
+
+TEST(Kernel, SelectionFormFollowsDensity) {
+    util::BitVector dense(200);
+    dense.SetRange(0, 200);
+    util::BitVector dense_holes(200);
+    for (size_t i = 0; i < 200; ++i) {
+        if (i % 3 != 0) {
+            dense_holes.Set(i);
+        }
+    }
+    util::BitVector sparse(200);
+    sparse.Set(5);
+    sparse.Set(130);
+
+    auto all = core::RowSelection::FromBitmap(std::move(dense));
+    EXPECT_EQ(all.GetKind(), core::RowSelection::Kind::Range);
+    EXPECT_EQ(all.Count(), 200);
+    auto holes = core::RowSelection::FromBitmap(std::move(dense_holes));
+    EXPECT_EQ(holes.GetKind(), core::RowSelection::Kind::Bitmap);
+    ASSERT_EQ(holes.Count(), 133);
+    EXPECT_EQ(holes.Indices()[0], 1);
+    EXPECT_EQ(holes.Indices()[132], 199);
+    auto few = core::RowSelection::FromBitmap(std::move(sparse));
+    EXPECT_EQ(few.GetKind(), core::RowSelection::Kind::Indices);
+    EXPECT_EQ(few.Indices(), (std::vector<uint32_t>{5, 130}));
+    auto run = core::RowSelection::FromIndices({7, 8, 9}, 20);
+    EXPECT_EQ(run.GetKind(), core::RowSelection::Kind::Range);
+    EXPECT_EQ(run.Indices(), (std::vector<uint32_t>{7, 8, 9}));
+    auto dense_list = core::RowSelection::FromIndices({0, 2, 3, 5}, 8);
+    EXPECT_EQ(dense_list.GetKind(), core::RowSelection::Kind::Bitmap);
+    EXPECT_EQ(dense_list.ToBitmap(8).GetData()[0], 0b101101);
+    EXPECT_EQ(dense_list.Indices(), (std::vector<uint32_t>{0, 2, 3, 5}));
+    auto sparse_list = core::RowSelection::FromIndices({0, 5}, 8);
+    EXPECT_EQ(sparse_list.GetKind(), core::RowSelection::Kind::Indices);
+
+    core::BoolColumn mask;
+    for (size_t i = 0; i < 130; ++i) {
+        mask.Append(i == 0 || i == 64 || i == 129);
+    }
+    EXPECT_EQ(exec::kernel::MaskToSelection(mask), (std::vector<uint32_t>{0, 64, 129}));
+}
+
+TEST(Execution, ProjectOverDenseFilter) {
+    core::Schema schema({core::Field("x", core::DataType::Int64)});
+    core::Batch batch(schema);
+    for (int64_t i = 0; i < 300; ++i) {
+        batch.ColumnAt(0).AppendFromString(std::to_string(i));
+    }
+    auto x = exec::MakeColumnExpr("x", core::DataType::Int64);
+    // Not a simple term, so the filter evaluates a mask and keeps its rows as a bitmap
+    auto condition = exec::MakeBinary(
+        exec::BinaryFunction::NotEqual,
+        exec::MakeBinary(exec::BinaryFunction::Minus, x, exec::MakeConst(int64_t{7})),
+        exec::MakeConst(int64_t{0}));
+    auto plan = exec::MakeProject(
+        exec::MakeFilter(exec::MakeScan(), condition),
+        {exec::ProjectionUnit{
+            exec::MakeBinary(exec::BinaryFunction::Plus, x, exec::MakeConst(int64_t{1})), "y"}});
+    auto result = RunPlanOnBatch(batch, plan);
+    ASSERT_EQ(result.RowsCount(), 299);
+    EXPECT_EQ(result.ColumnAt(0).GetAsString(6), "7");
+    EXPECT_EQ(result.ColumnAt(0).GetAsString(7), "9");
+    EXPECT_EQ(result.ColumnAt(0).GetAsString(298), "300");
+}
+
+TEST(Kernel, NarrowIntegerComparesMatchWideOnes) {
+    core::Int16Column a(true);
+    core::Int32Column b(false);
+    for (int64_t i = 0; i < 150; ++i) {
+        if (i % 7 == 0) {
+            a.AppendNull();
+        } else {
+            a.Append(static_cast<int16_t>(i * 300 - 20000));
+        }
+        b.Append(static_cast<int32_t>(i * 250 - 20000));
+    }
+
+    auto less = exec::kernel::Less(a, b);
+    auto greater = exec::kernel::GreaterConstInt(a, 1000);
+    auto above_range = exec::kernel::LessConstInt(a, 100000);
+    auto below_range = exec::kernel::EqualConstInt(a, -100000);
+    ASSERT_EQ(less->Size(), 150);
+    for (size_t i = 0; i < 150; ++i) {
+        bool null = i % 7 == 0;
+        int64_t lhs = static_cast<int64_t>(i) * 300 - 20000;
+        int64_t rhs = static_cast<int64_t>(i) * 250 - 20000;
+        EXPECT_EQ(less->GetAsString(i), !null && lhs < rhs ? "true" : "false") << i;
+        EXPECT_EQ(greater->GetAsString(i), !null && lhs > 1000 ? "true" : "false") << i;
+        EXPECT_EQ(above_range->GetAsString(i), null ? "false" : "true") << i;
+        EXPECT_EQ(below_range->GetAsString(i), "false") << i;
+    }
+}
+
 TEST(ClickBenchQueries, Q18ExtractMinutePerUserAndPhrase) {
     auto result = RunMiniQuery(18);
     ASSERT_EQ(result.ColumnsCount(), 4);
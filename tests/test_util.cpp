@@ -1,6 +1,16 @@
 #include <gtest/gtest.h>
+#include <util/compression.h>
+#include <util/date_time.h>
+#include <util/decompressing_file.h>
+#include <util/parse.h>
 #include <util/string_arena.h>
 
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -79,3 +89,109 @@ TEST(StringArenaTest, MovedFromArenaCanBeReused) {
     EXPECT_EQ(b.BytesUsed(), 7u);
     EXPECT_EQ(a.BytesUsed(), 5u);
 }
+
+TEST(ParseTest, DecimalInt64MatchesFromChars) {
+    int64_t value = 0;
+    EXPECT_TRUE(util::ParseDecimalInt64("0", value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(util::ParseDecimalInt64("-12345678", value));
+    EXPECT_EQ(value, -12345678);
+    EXPECT_TRUE(util::ParseDecimalInt64("1234567890123", value));
+    EXPECT_EQ(value, 1234567890123);
+    EXPECT_TRUE(util::ParseDecimalInt64("9223372036854775807", value));
+    EXPECT_EQ(value, std::numeric_limits<int64_t>::max());
+    EXPECT_TRUE(util::ParseDecimalInt64("-9223372036854775808", value));
+    EXPECT_EQ(value, std::numeric_limits<int64_t>::min());
+    EXPECT_TRUE(util::ParseDecimalInt64("00000000000000000000042", value));
+    EXPECT_EQ(value, 42);
+
+    EXPECT_FALSE(util::ParseDecimalInt64("", value));
+    EXPECT_FALSE(util::ParseDecimalInt64("-", value));
+    EXPECT_FALSE(util::ParseDecimalInt64("+1", value));
+    EXPECT_FALSE(util::ParseDecimalInt64("1234567a", value));
+    EXPECT_FALSE(util::ParseDecimalInt64("12345678:", value));
+    EXPECT_FALSE(util::ParseDecimalInt64("9223372036854775808", value));
+    EXPECT_FALSE(util::ParseDecimalInt64("-9223372036854775809", value));
+    EXPECT_FALSE(util::ParseDecimalInt64("99999999999999999999", value));
+}
+
+TEST(ParseTest, DateAndTimestampDigits) {
+    EXPECT_EQ(util::ParseDate("1970-01-01"), 0);
+    EXPECT_EQ(util::ParseDate("2000-03-01"), 11017);
+    EXPECT_EQ(util::ParseTimestamp("1970-01-02 01:02:03"), 86400 + 3723);
+
+    EXPECT_THROW(util::ParseDate("2O24-01-01"), std::runtime_error);
+    EXPECT_THROW(util::ParseDate("2024-1a-01"), std::runtime_error);
+    EXPECT_THROW(util::ParseDate("2024-01-:1"), std::runtime_error);
+    EXPECT_THROW(util::ParseTimestamp("2024-01-01 0/:00:00"), std::runtime_error);
+    EXPECT_THROW(util::ParseTimestamp("2024-01-01 00:00:5x"), std::runtime_error);
+}
+
+namespace {
+std::string WriteTempFile(const std::string& name, const std::string& data) {
+    auto path = (std::filesystem::temp_directory_path() / ("columnar_test_" + name)).string();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return path;
+}
+
+std::string ZstdFrame(const std::string& text) {
+    std::vector<uint8_t> out;
+    util::Compress(util::Compression::Zstd, reinterpret_cast<const uint8_t*>(text.data()),
+                   text.size(), out);
+    return {out.begin(), out.end()};
+}
+
+std::string ReadAll(std::istream& in) {
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+}  // namespace
+
+TEST(DecompressingInputFileTest, PlainInputPassesThrough) {
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += std::to_string(i) + ",row\n";
+    }
+    auto path = WriteTempFile("plain.csv", text);
+    util::DecompressingInputFile in(path, 7, 2);
+    EXPECT_EQ(in.Codec(), util::InputCodec::None);
+    EXPECT_EQ(ReadAll(in), text);
+    std::filesystem::remove(path);
+}
+
+TEST(DecompressingInputFileTest, ConcatenatedZstdFrames) {
+    std::string first(100000, 'a');
+    std::string second = "1,b\n2,c\n";
+    auto path = WriteTempFile("frames.csv.zst", ZstdFrame(first) + ZstdFrame(second));
+    util::DecompressingInputFile in(path, 4096, 3);
+    EXPECT_EQ(in.Codec(), util::InputCodec::Zstd);
+    EXPECT_EQ(ReadAll(in), first + second);
+    std::filesystem::remove(path);
+}
+
+TEST(DecompressingInputFileTest, GzipMembers) {
+    if (!util::IsInputCodecSupported(util::InputCodec::Gzip)) {
+        GTEST_SKIP() << "built without zlib";
+    }
+    // gzip of "1,a\n2,b\n" followed by a second member with "3,c\n"
+    const unsigned char kData[] = {
+        0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x33, 0xD4, 0x49,
+        0xE4, 0x32, 0xD2, 0x49, 0xE2, 0x02, 0x00, 0xA9, 0x74, 0x2B, 0x71, 0x08, 0x00,
+        0x00, 0x00, 0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x33,
+        0xD6, 0x49, 0xE6, 0x02, 0x00, 0xAD, 0xE6, 0x88, 0x5C, 0x04, 0x00, 0x00, 0x00};
+    auto path = WriteTempFile("members.csv.gz", std::string(std::begin(kData), std::end(kData)));
+    util::DecompressingInputFile in(path, 3, 2);
+    EXPECT_EQ(in.Codec(), util::InputCodec::Gzip);
+    EXPECT_EQ(ReadAll(in), "1,a\n2,b\n3,c\n");
+    std::filesystem::remove(path);
+}
+
+TEST(DecompressingInputFileTest, TruncatedInputThrows) {
+    auto frame = ZstdFrame(std::string(10000, 'x') + "tail");
+    auto path = WriteTempFile("truncated.csv.zst", frame.substr(0, frame.size() - 3));
+    util::DecompressingInputFile in(path, 1024, 2);
+    std::string buf(20000, '\0');
+    EXPECT_THROW(in.read(buf.data(), static_cast<std::streamsize>(buf.size())),
+                 std::runtime_error);
+    std::filesystem::remove(path);
+}